@@ -0,0 +1,183 @@
+/*
+ * 词法分析的基准测试：比较 Flex 生成的 scanner 与手写的 Lexer。
+ * 用法: lexer_bench [-n=<iterations>] [<file>...]
+ * 不给文件时扫描生成的 SysY 程序。先确认两者产生相同的 token 序列，
+ * 再各扫描 iterations 遍，输出每秒处理的 token 数与字节数
+ */
+#include "frontend/Lexer.h"
+#include "parser.tab.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+extern int yylex_init_extra(std::ostream *err, yyscan_t *scanner);
+extern int yylex_destroy(yyscan_t scanner);
+struct yy_buffer_state;
+extern yy_buffer_state *yy_scan_buffer(char *base, size_t size,
+                                       yyscan_t scanner);
+
+using namespace std;
+
+namespace {
+
+// token 的种类与值，用于比较两个词法分析器的输出
+struct Token {
+  int kind;
+  int int_val;
+  string ident;
+
+  bool operator==(const Token &other) const {
+    return kind == other.kind && int_val == other.int_val &&
+           ident == other.ident;
+  }
+};
+
+// 包含注释、关键字、标识符、各种进制的整数与运算符的程序
+string GenerateSource(size_t functions) {
+  ostringstream oss;
+  oss << "/* generated by lexer_bench */\n";
+  for (size_t i = 0; i < functions; ++i) {
+    oss << "// function " << i << "\n"
+        << "int accumulate_values_" << i << "(int count, int seed) {\n"
+        << "  const int base = 0x7f, mask = 0777;\n"
+        << "  int total = 0, index_" << i << " = 0;\n"
+        << "  /* walk the range\n   * and mix in the seed */\n"
+        << "  while (index_" << i << " < count) {\n"
+        << "    if (index_" << i << " % 3 == 0 && seed != " << i << ") {\n"
+        << "      total = total + (seed * base) / (mask - 1);\n"
+        << "    } else if (total >= 1000000 || index_" << i << " <= 2) {\n"
+        << "      total = total - index_" << i << ";\n"
+        << "    } else {\n"
+        << "      total = !total;\n"
+        << "    }\n"
+        << "    index_" << i << " = index_" << i << " + 1;\n"
+        << "  }\n"
+        << "  return total;\n"
+        << "}\n\n";
+  }
+  return oss.str();
+}
+
+void Record(int kind, const YYSTYPE &lval, vector<Token> &tokens) {
+  Token token{kind, 0, ""};
+  if (kind == IDENT) {
+    token.ident.assign(lval.ident_val.text, lval.ident_val.len);
+  } else if (kind == INT_CONST) {
+    token.int_val = lval.int_val;
+  }
+  tokens.push_back(move(token));
+}
+
+// Flex 就地扫描，会改写缓冲区，因此每次扫描一份末尾带两个 '\0' 的副本
+size_t ScanFlex(char *buffer, size_t size, vector<Token> *tokens) {
+  yyscan_t scanner;
+  if (yylex_init_extra(&cerr, &scanner) != 0) {
+    return 0;
+  }
+  yy_scan_buffer(buffer, size + 2, scanner);
+  YYSTYPE lval;
+  size_t count = 0;
+  int kind;
+  while ((kind = yylex(&lval, scanner)) > 0 && kind != YYerror) {
+    ++count;
+    if (tokens) {
+      Record(kind, lval, *tokens);
+    }
+  }
+  yylex_destroy(scanner);
+  return count;
+}
+
+size_t ScanHand(const string &source, vector<Token> *tokens) {
+  Lexer lexer(source.data(), source.size(), cerr);
+  YYSTYPE lval;
+  size_t count = 0;
+  int kind;
+  while ((kind = lexer.Next(&lval)) > 0 && kind != YYerror) {
+    ++count;
+    if (tokens) {
+      Record(kind, lval, *tokens);
+    }
+  }
+  return count;
+}
+
+void Report(const char *name, size_t tokens, size_t bytes, double seconds) {
+  printf("%-6s %10.3f ms  %8.2f Mtokens/s  %8.2f MB/s\n", name,
+         seconds * 1e3, tokens / seconds / 1e6, bytes / seconds / 1e6);
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+  size_t iterations = 20;
+  string source;
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    if (arg.rfind("-n=", 0) == 0) {
+      iterations = stoul(arg.substr(3));
+      continue;
+    }
+    ifstream file(arg, ios::binary);
+    if (!file) {
+      cerr << "Error: Cannot open file " << arg << endl;
+      return 1;
+    }
+    source.append(istreambuf_iterator<char>(file),
+                  istreambuf_iterator<char>());
+    source += '\n';
+  }
+  if (source.empty()) {
+    source = GenerateSource(20000);
+  }
+
+  string copy = source + '\0' + '\0';
+  vector<Token> flex_tokens, hand_tokens;
+  ScanFlex(&copy[0], source.size(), &flex_tokens);
+  ScanHand(source, &hand_tokens);
+  if (flex_tokens.size() != hand_tokens.size()) {
+    cerr << "Error: Token count differs: flex " << flex_tokens.size()
+         << ", hand " << hand_tokens.size() << endl;
+    return 1;
+  }
+  for (size_t i = 0; i < flex_tokens.size(); ++i) {
+    if (!(flex_tokens[i] == hand_tokens[i])) {
+      cerr << "Error: Token " << i << " differs" << endl;
+      return 1;
+    }
+  }
+  printf("%zu bytes, %zu tokens, %zu iterations\n", source.size(),
+         flex_tokens.size(), iterations);
+
+  // 复制缓冲区不计入 Flex 的时间
+  double flex_seconds = 0, hand_seconds = 0;
+  size_t count = 0;
+  for (size_t i = 0; i < iterations; ++i) {
+    copy.assign(source);
+    copy += '\0';
+    copy += '\0';
+    auto start = chrono::steady_clock::now();
+    count += ScanFlex(&copy[0], source.size(), nullptr);
+    flex_seconds +=
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  }
+  Report("flex", count, source.size() * iterations, flex_seconds);
+
+  count = 0;
+  auto start = chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    count += ScanHand(source, nullptr);
+  }
+  hand_seconds =
+      chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  Report("hand", count, source.size() * iterations, hand_seconds);
+
+  printf("speedup %.2fx\n", flex_seconds / hand_seconds);
+  return 0;
+}
@@ -0,0 +1 @@
+int main() { return 1 + 2 * 3 - 4 / 2 % 3; }
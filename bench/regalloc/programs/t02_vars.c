@@ -0,0 +1 @@
+int main() { int a = 5; int b; b = a * 3; const int c = 7 + 2; a = b - c + a; return a; }
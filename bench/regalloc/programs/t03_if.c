@@ -0,0 +1 @@
+int main() { int a = 3, b = 9, x; if (a < b) x = a; else x = b; int y = 0; if (a > b) y = 1; return x * 10 + y; }
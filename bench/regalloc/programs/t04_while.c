@@ -0,0 +1 @@
+int main() { int i = 0, s = 0; while (i < 10) { s = s + i * i; i = i + 1; } return s % 256; }
@@ -0,0 +1 @@
+int main() { int a = 0, b = 3, c = 0; if (a && b) c = c + 1; if (a || b) c = c + 2; if (!a && !!b) c = c + 4; c = c + (b && 5) * 8 + (a || 0) * 16; return c; }
@@ -0,0 +1 @@
+int main() { int a = 1, b = 2, c = 3, d = 4, e = 5; int x = a + b + c + d + e + 1 + 2; int y = a * b * c * d * e * 2; int z = a + (b * (c - (d / e))); return x + y + z; }
@@ -0,0 +1 @@
+int main() { int x = 5; int y = -x; int z = - -x; int w = !x; int v = !!x; int u = 0 - (0 - x); return x + y + z + w + v + u + (x - x) + x * 1 + x + 0; }
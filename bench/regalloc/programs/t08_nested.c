@@ -0,0 +1 @@
+int main() { int i = 0, n = 20, cnt = 0; while (i < n) { if (i % 3 == 0) { cnt = cnt + 1; } else { if (i % 3 == 1) cnt = cnt + 2; else cnt = cnt + 3; } i = i + 1; } return cnt; }
@@ -0,0 +1 @@
+int main() { int a = 17, b = -4, mn, mx, ab; if (a < b) mn = a; else mn = b; if (a > b) mx = a; else mx = b; if (b < 0) ab = -b; else ab = b; int q = 3; if (a != 0) q = q + a; return mn + mx + ab + q; }
@@ -0,0 +1 @@
+int main() { int x = 4; if (x > 3) { return 42; } x = x + 1; return x; }
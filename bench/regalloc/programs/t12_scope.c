@@ -0,0 +1 @@
+int main() { int a = 1; { int a = 2; { a = a + 10; } } { const int b = 3; a = a + b; } return a; }
@@ -0,0 +1 @@
+int main() { int a = 3, b = 7, c = 11, d = 13, e = 2; int r = a + (b * (c - (d / e))); r = r + ((a - b) * (c + d)) - ((e * a) - (b % e)); int s = a * b + c * d + e * a + b * c + d * e; return (r + s) % 256; }
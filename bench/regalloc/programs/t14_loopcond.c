@@ -0,0 +1 @@
+int main() { int i = 0, n = 8, s = 0, flag = 1; while (i < n && s < 100) { if (flag) s = s + i; else s = s - i; if (i < n) s = s + 1; i = i + 1; } return s; }
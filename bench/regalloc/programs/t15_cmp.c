@@ -0,0 +1 @@
+int main() { int a = 5, b = 5, c = 2; return (a <= b) + (a >= b) * 2 + (a == b) * 4 + (a != c) * 8 + (c < a) * 16 + (c > a) * 32 + (a % c < 2) * 64; }
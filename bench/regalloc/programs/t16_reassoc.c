@@ -0,0 +1 @@
+int main() { int x = 9; int y = x + 1 + 2; int z = x - 1 + 1; int w = 3 * x * 4 - 5 + x; int v = 2 - x + 7 - x; return y + z + w + v; }
@@ -0,0 +1,20 @@
+int main() {
+  int x = -7, y = 5, r = 0, i = 0;
+  while (i < 12) {
+    int a;
+    if (x < 0) a = -x; else a = x;
+    int b;
+    if (0 >= y) b = -y; else b = y;
+    int c;
+    if (x > 0) c = x; else c = -x;
+    if (a > b) { r = r + a; y = y - 1; } else { r = r - b; }
+    if (i % 2) x = x + 3;
+    if (i == 5) { r = r + 100 / (i - 4); }
+    if (r < 0) { r = 0 - r; x = x + 1; r = r + x; }
+    int t = 0;
+    if (i > 3) { t = i; t = t * 2; }
+    r = r + t + c;
+    i = i + 1;
+  }
+  return r % 256;
+}
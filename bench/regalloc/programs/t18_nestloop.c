@@ -0,0 +1 @@
+int main() { int i = 0, s = 0; while (i < 5) { int j = 0; while (j < i) { if (j % 2 == 0) s = s + j; else { s = s + 1; } j = j + 1; } i = i + 1; } return s; }
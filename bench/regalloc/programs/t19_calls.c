@@ -0,0 +1,23 @@
+int sq(int x) { return x * x; }
+int add3(int a, int b, int c) { return a + b + c; }
+int many(int a, int b, int c, int d, int e, int f, int g, int h, int i, int j) {
+  return a - b + c * d - e + f * g - h + i * j;
+}
+void show(int v) { putint(v); putch(10); }
+int fib(int n) { if (n < 2) return n; return fib(n - 1) + fib(n - 2); }
+int fact(int n) { if (n <= 1) return 1; return n * fact(n - 1); }
+int clamp(int v, int lo, int hi) { if (v < lo) return lo; if (v > hi) return hi; return v; }
+int main() {
+  int s = 0, i = 0;
+  while (i < 10) {
+    s = s + sq(i) + add3(i, 1, 2);
+    s = s + clamp(i * 7 - 20, 0, 30);
+    i = i + 1;
+  }
+  show(s);
+  show(many(1, 2, 3, 4, 5, 6, 7, 8, 9, 10));
+  show(fib(12));
+  int x = getint();
+  show(fact(x));
+  return (s + fib(10)) % 256;
+}
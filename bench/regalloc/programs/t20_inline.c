@@ -0,0 +1,16 @@
+int abs1(int x) { if (x < 0) return -x; return x; }
+int max2(int a, int b) { if (a > b) return a; return b; }
+int min2(int a, int b) { if (a < b) return a; return b; }
+int inc(int x) { return x + 1; }
+void nop() { }
+int dist(int a, int b) { return abs1(a - b); }
+int main() {
+  int i = 0, acc = 0;
+  while (i < 50) {
+    acc = acc + dist(i, 25) + max2(i, 10) - min2(i, 30);
+    acc = inc(acc);
+    nop();
+    i = inc(i);
+  }
+  return acc % 256;
+}
@@ -0,0 +1,5 @@
+int sum(int n, int acc) {
+  if (n == 0) return acc;
+  return sum(n - 1, acc + n);
+}
+int main() { return sum(100, 0) % 256; }
@@ -0,0 +1,20 @@
+int gcd(int a, int b) {
+  if (b == 0) return a;
+  return gcd(b, a % b);
+}
+int twice(int x) { int y = x * 2; return y + 0; }
+int wrap(int a, int b) { int g = gcd(a, b); if (g > 3) return twice(g); return gcd(g + 1, 2); }
+void count(int n) {
+  if (n == 0) return;
+  putint(n);
+  count(n - 1);
+}
+void show(int x) { putint(x); }
+void last(int x) { int z = x + 1; show(z); }
+int deep(int n, int acc) { if (n <= 0) return acc; return deep(n - 1, acc + n % 7); }
+int main() {
+  count(5);
+  last(41);
+  putint(deep(20000, 0));
+  return wrap(48, 36) + wrap(7, 5);
+}
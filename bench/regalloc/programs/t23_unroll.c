@@ -0,0 +1,18 @@
+int main() {
+  int s = 0; int i = 0; int n = getint();
+  while (i < 10) { s = s + i * 2; i = i + 1; }
+  int j = 0;
+  while (j < n) { s = s + j; j = j + 1; }
+  int k = n;
+  while (k > 0) { s = s + k % 3; k = k - 2; }
+  int m = 3;
+  while (m <= n) { if (m % 2 == 0) s = s + 1; else s = s - 1; m = m + 3; }
+  int a = 0; int b = 0;
+  while (a < 4) { b = 0; while (b < 3) { s = s + a * b; b = b + 1; } a = a + 1; }
+  int z = 5;
+  while (z < 3) { s = s + 100; z = z + 1; }
+  int w = 2147483640;
+  while (w < 2147483647) { s = s + 1; w = w + 1; }
+  putint(s);
+  return s % 256;
+}
@@ -0,0 +1,22 @@
+int work(int n, int flag, int mode) {
+  int s = 0; int i = 0;
+  while (i < n) {
+    if (flag) s = s + i; else s = s - 1;
+    int j = 0;
+    while (j < 3) {
+      if (mode > 2) s = s + j; else s = s * 1;
+      if (mode + flag == 3) s = s + 2;
+      j = j + 1;
+    }
+    i = i + 1;
+  }
+  return s;
+}
+int main() {
+  int n = getint();
+  putint(work(n, 1, 3)); putch(32);
+  putint(work(n, 0, 1)); putch(32);
+  putint(work(n, 2, 1)); putch(32);
+  putint(work(0, 1, 5));
+  return work(n, 0, 7) % 256;
+}
@@ -0,0 +1,24 @@
+int f(int a, int b, int n) {
+  int s = 0;
+  int i = 0;
+  while (i < n) {
+    if (i % 3 == 0) s = s + a * b;
+    else if (i % 3 == 1) { a = a + 1; s = s - a * b; }
+    s = s + a * b + (i + a) * 2;
+    i = i + 1;
+  }
+  return s;
+}
+int main() {
+  int a = getint();
+  int b = getint();
+  int c = 0;
+  if (a > b) c = a * b + 1;
+  else c = a - b;
+  c = c + a * b;
+  int x = a + b;
+  if (c > 10 && a + b > 5) x = x + a + b;
+  putint(c); putch(10);
+  putint(x + f(a, b, 50)); putch(10);
+  return c % 256;
+}
@@ -0,0 +1,16 @@
+int rot(int a, int b, int c, int n) {
+  if (n == 0) return a * 100 + b * 10 + c;
+  return rot(b, c, a, n - 1);
+}
+int swp(int a, int b, int n, int acc) {
+  if (n == 0) return acc + a - b;
+  return swp(b, a, n - 1, acc + a * n);
+}
+int main() {
+  int n = getint();
+  putint(rot(1, 2, 3, n)); putch(10);
+  putint(swp(3, 8, n, 0)); putch(10);
+  int x = 0;
+  if (n > 3 && n < 100) x = n * 2;
+  return rot(4, 5, 6, n + 1) % 256 + swp(1, 2, 5, x) % 7;
+}
@@ -0,0 +1,21 @@
+int mix(int a, int b, int c, int d, int e, int f, int g, int h, int i, int j) {
+  return a + 2 * b + 3 * c + 4 * d + 5 * e + 6 * f + 7 * g + 8 * h + 9 * i + 10 * j;
+}
+int main() {
+  int n = getint();
+  int s = 0;
+  int k = 0;
+  while (k < n) {
+    int a = k + 1, b = k * 2, c = k - 3, d = k * k, e = a + b, f = c * d, g = e - f;
+    int h = g + a, i = h * 3, j = i - b, l = j + c, m = l * 2, o = m + d, p = o - e;
+    int q = p + f, r = q * g, t = r - h, u = t + i, v = u - j, w = v + l, x = w * 3;
+    int y = x - m, z = y + o;
+    s = s + mix(a, b, c, d, e, f, g, h, i, j) % 1000;
+    s = s + (a + b + c + d + e + f + g + h + i + j + l + m + o + p + q + r + t + u + v + w + x + y + z) % 977;
+    s = s + mix(z, y, x, w, v, u, t, r, q, p) % 1000;
+    s = s % 100000;
+    k = k + 1;
+  }
+  putint(s); putch(10);
+  return s % 256;
+}
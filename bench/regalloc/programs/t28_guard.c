@@ -0,0 +1,50 @@
+int fib(int n) {
+  if (n <= 1) return n;
+  return fib(n - 1) + fib(n - 2);
+}
+
+int sum(int a, int b, int n) {
+  if (n <= 0) return a;
+  int s = 0;
+  int i = 0;
+  while (i < n) {
+    s = s + a * i + b;
+    putint(s);
+    putch(32);
+    i = i + 1;
+  }
+  return s;
+}
+
+int clampadd(int x, int y) {
+  if (x < 0) return 0;
+  if (y < 0) return x;
+  int t = getint();
+  return x + y + t + fib(x % 5);
+}
+
+int many(int a, int b, int c, int d, int e, int f, int g, int h, int i, int j) {
+  if (a == 0) return b - c;
+  int k = b * 3 + a;
+  if (k > 100) return j + i;
+  putint(k + d + e + f + g + h + i + j);
+  putch(32);
+  return many(a - 1, c, b, d, e, f, g, h, j, i) + k;
+}
+
+int main() {
+  int n = getint();
+  putint(fib(n));
+  putch(10);
+  putint(sum(3, 4, n % 4));
+  putch(10);
+  putint(sum(3, 4, 0));
+  putch(10);
+  putint(clampadd(-1, 2) + clampadd(3, -4) + clampadd(7, 8));
+  putch(10);
+  putint(many(3, 1, 2, 3, 4, 5, 6, 7, 8, 9));
+  putch(10);
+  putint(many(1, 50, 2, 3, 4, 5, 6, 7, 8, 9));
+  putch(10);
+  return 0;
+}
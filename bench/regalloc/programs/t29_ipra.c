@@ -0,0 +1,38 @@
+int sq(int x) { return x * x; }
+
+int mix(int a, int b) {
+  int t = a * 3 + b;
+  int u = t - a / 2;
+  return t - u * 2;
+}
+
+int twice(int a, int b) { return mix(a, b) + mix(b, a) + sq(a); }
+
+int rec(int n, int acc) {
+  if (n == 0) return acc;
+  int k = sq(n) % 7;
+  return rec(n - 1, acc + k) + k;
+}
+
+int main() {
+  int n = getint();
+  int i = 0;
+  int s = 0;
+  int p = 1;
+  int q = 2;
+  while (i < n) {
+    s = s + sq(i) + p;
+    p = p + mix(i, q) % 13;
+    q = q + twice(p % 17, i) % 11;
+    i = i + 1;
+  }
+  putint(s);
+  putch(32);
+  putint(p);
+  putch(32);
+  putint(q);
+  putch(32);
+  putint(rec(n, 0));
+  putch(10);
+  return (s + p + q) % 256;
+}
@@ -0,0 +1,44 @@
+int f(int n) {
+  int i = 0;
+  int s = 0;
+  while (i < n) {
+    if (i < n) {
+      s = s + i;
+    } else {
+      s = s - 1000;
+    }
+    int r = i % 8;
+    if (r < 8) {
+      s = s + r;
+    }
+    if (r >= 0) {
+      s = s + 1;
+    }
+    i = i + 1;
+  }
+  if (i >= n) s = s + 7;
+  return s;
+}
+
+int g(int x) {
+  if (x > 10) {
+    if (x > 5) return x * 2;
+    return -1;
+  }
+  if (x == 3) {
+    if (x != 3) return 100;
+    return x + 40;
+  }
+  return x;
+}
+
+int main() {
+  int n = getint();
+  putint(f(n));
+  putch(32);
+  putint(f(-3));
+  putch(32);
+  putint(g(n) + g(3) + g(-7));
+  putch(10);
+  return 0;
+}
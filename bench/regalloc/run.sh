@@ -0,0 +1,63 @@
+#!/bin/bash
+# 比较 -regalloc=stack 与 -regalloc=graph：编译时间与运行时执行的指令数。
+# 用法: bench/regalloc/run.sh <compiler> [options...]
+# options 追加在每次编译的命令行中，默认只有 -O2。
+# 每个程序用两种分配器各编译一次，在 rvsim.py 中运行，
+# 输出与返回值不一致时报错
+set -u
+
+if [ $# -lt 1 ]; then
+  echo "usage: $0 <compiler> [options...]" >&2
+  exit 2
+fi
+compiler=$1
+shift
+dir=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+now_ns() { date +%s%N; }
+
+status=0
+declare -A total_insts=([stack]=0 [graph]=0) total_ns=([stack]=0 [graph]=0)
+printf "%-16s %14s %14s\n" program stack graph
+for src in "$dir"/programs/*.c; do
+  name=$(basename "$src" .c)
+  input=""
+  [ -f "$dir/programs/$name.in" ] && input=$(cat "$dir/programs/$name.in")
+  declare -A insts=() result=()
+  for alloc in stack graph; do
+    asm="$work/$name.$alloc.S"
+    start=$(now_ns)
+    if ! "$compiler" -riscv "$src" -o "$asm" -O2 -regalloc=$alloc "$@"; then
+      echo "error: $name: compilation failed with -regalloc=$alloc" >&2
+      status=1
+      continue 2
+    fi
+    total_ns[$alloc]=$((total_ns[$alloc] + $(now_ns) - start))
+    # 输入是空白分隔的整数，按词拆分后作为 getint 的参数
+    # shellcheck disable=SC2086
+    output=$(python3 "$dir/rvsim.py" "$asm" $input 2>"$work/stderr")
+    exit_code=$?
+    count=$(sed -n 's/^instructions //p' "$work/stderr")
+    if [ -z "$count" ]; then
+      echo "error: $name: $(cat "$work/stderr") (-regalloc=$alloc)" >&2
+      status=1
+      continue 2
+    fi
+    insts[$alloc]=$count
+    result[$alloc]="$exit_code:$output"
+  done
+  if [ "${result[stack]}" != "${result[graph]}" ]; then
+    echo "error: $name: stack and graph results differ" >&2
+    status=1
+  fi
+  printf "%-16s %14d %14d\n" "$name" "${insts[stack]}" "${insts[graph]}"
+  total_insts[stack]=$((total_insts[stack] + insts[stack]))
+  total_insts[graph]=$((total_insts[graph] + insts[graph]))
+done
+printf "%-16s %14d %14d\n" "total" "${total_insts[stack]}" \
+  "${total_insts[graph]}"
+awk -v s="${total_ns[stack]}" -v g="${total_ns[graph]}" \
+  'BEGIN { printf "%-16s %14.3f %14.3f\n", "compile (s)", s / 1e9, g / 1e9 }'
+exit $status
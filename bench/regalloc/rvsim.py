@@ -0,0 +1,253 @@
+#!/usr/bin/env python3
+# 运行编译器生成的 RV32IM 汇编并统计执行的指令数，供 run.sh 比较寄存器分配器。
+# 用法: rvsim.py <file.S> [<int>...]
+# 命令行中的整数依次作为 getint 的输入；程序输出写到 stdout，
+# 执行的指令数以 "instructions <n>" 写到 stderr，退出码为 main 的返回值 & 0xff。
+# 只支持编译器会生成的指令与伪指令。运行时库函数调用后随机改写调用者保存的寄存器，
+# 函数返回时检查 sp 与 s0 ~ s11 是否恢复，违反调用约定的代码会报错退出
+import random
+import re
+import sys
+
+MASK = 0xFFFFFFFF
+STACK_TOP = 0x7FFF0000
+DATA_BASE = 0x10000
+MAX_STEPS = 50_000_000
+
+REGS = ['zero', 'ra', 'sp', 'gp', 'tp', 't0', 't1', 't2', 's0', 's1',
+        'a0', 'a1', 'a2', 'a3', 'a4', 'a5', 'a6', 'a7',
+        's2', 's3', 's4', 's5', 's6', 's7', 's8', 's9', 's10', 's11',
+        't3', 't4', 't5', 't6']
+ALIASES = {'fp': 's0', **{'x%d' % i: r for i, r in enumerate(REGS)}}
+CALLEE_SAVED = ['sp'] + ['s%d' % i for i in range(12)]
+CALLER_SAVED = ['t%d' % i for i in range(7)] + ['a%d' % i for i in range(1, 8)]
+
+REG_OPS = {
+    'add': lambda x, y: x + y,
+    'sub': lambda x, y: x - y,
+    'mul': lambda x, y: x * y,
+    'div': lambda x, y: -1 if y == 0 else trunc_div(x, y),
+    'rem': lambda x, y: x if y == 0 else x - y * trunc_div(x, y),
+    'slt': lambda x, y: int(x < y),
+    'sgt': lambda x, y: int(x > y),
+    'sltu': lambda x, y: int((x & MASK) < (y & MASK)),
+    'and': lambda x, y: x & y,
+    'or': lambda x, y: x | y,
+    'xor': lambda x, y: x ^ y,
+    'sll': lambda x, y: x << (y & 31),
+    'srl': lambda x, y: (x & MASK) >> (y & 31),
+    'sra': lambda x, y: x >> (y & 31),
+}
+IMM_OPS = {
+    'addi': lambda x, y: x + y,
+    'andi': lambda x, y: x & y,
+    'ori': lambda x, y: x | y,
+    'xori': lambda x, y: x ^ y,
+    'slti': lambda x, y: int(x < y),
+    'slli': lambda x, y: x << y,
+    'srli': lambda x, y: (x & MASK) >> y,
+    'srai': lambda x, y: x >> y,
+}
+BRANCHES = {
+    'beq': lambda x, y: x == y,
+    'bne': lambda x, y: x != y,
+    'blt': lambda x, y: x < y,
+    'bge': lambda x, y: x >= y,
+    'bgt': lambda x, y: x > y,
+    'ble': lambda x, y: x <= y,
+}
+
+
+class SimError(Exception):
+    pass
+
+
+def to_s32(x):
+    x &= MASK
+    return x - (1 << 32) if x & 0x80000000 else x
+
+
+def trunc_div(x, y):
+    q = abs(x) // abs(y)
+    return q if (x < 0) == (y < 0) else -q
+
+
+def assemble(lines):
+    """返回 (指令列表, 代码标号, 初始数据, 数据标号)"""
+    insts, labels, data, data_labels = [], {}, {}, {}
+    section, addr = 'text', DATA_BASE
+    for line in lines:
+        line = line.split('#')[0].strip()
+        if not line:
+            continue
+        if line.startswith('.'):
+            directive, _, arg = line.partition(' ')
+            if directive in ('.text', '.data'):
+                section = directive[1:]
+            elif directive == '.word':
+                data[addr] = int(arg) & MASK
+                addr += 4
+            elif directive == '.zero':
+                for offset in range(0, int(arg), 4):
+                    data[addr + offset] = 0
+                addr += int(arg)
+            continue
+        m = re.match(r'^([A-Za-z_.$][\w.$]*):\s*(.*)$', line)
+        if m:
+            if section == 'text':
+                labels[m.group(1)] = len(insts)
+            else:
+                data_labels[m.group(1)] = addr
+            line = m.group(2)
+            if not line:
+                continue
+        op, _, rest = line.partition(' ')
+        args = [a.strip() for a in rest.split(',')] if rest.strip() else []
+        insts.append((op, args, line))
+    return insts, labels, data, data_labels
+
+
+class Machine:
+    def __init__(self, insts, labels, data, data_labels, inputs):
+        self.insts, self.labels = insts, labels
+        self.data_labels = data_labels
+        self.mem = dict(data)
+        self.regs = {r: 0 for r in REGS}
+        self.regs['sp'] = STACK_TOP
+        self.regs['ra'] = -1
+        self.inputs = list(inputs)
+        self.output = []
+        self.frames = []
+        self.rng = random.Random(7)
+
+    def read(self, name):
+        name = ALIASES.get(name, name)
+        return 0 if name == 'zero' else self.regs[name]
+
+    def write(self, name, value):
+        name = ALIASES.get(name, name)
+        if name != 'zero':
+            self.regs[name] = to_s32(value)
+
+    def address(self, operand):
+        m = re.match(r'(-?\d+)\((\w+)\)', operand)
+        addr = (int(m.group(1)) + self.read(m.group(2))) & MASK
+        if addr % 4:
+            raise SimError('unaligned access at %#x' % addr)
+        return addr
+
+    def call_runtime(self, name):
+        """执行运行时库函数，返回 False 表示不是库函数"""
+        if name == 'getint':
+            self.write('a0', self.inputs.pop(0) if self.inputs else 0)
+        elif name == 'getch':
+            self.write('a0', -1)
+        elif name == 'putint':
+            self.output.append(str(self.read('a0')))
+        elif name == 'putch':
+            self.output.append(chr(self.read('a0') & 0xFF))
+        else:
+            return False
+        # 库函数可以改写任意调用者保存的寄存器
+        for reg in CALLER_SAVED:
+            if reg != 'a0' or name.startswith('put'):
+                self.regs[reg] = self.rng.randint(-1000, 1000)
+        return True
+
+    def run(self):
+        pc, steps = self.labels['main'], 0
+        while pc != -1:
+            op, a, line = self.insts[pc]
+            pc += 1
+            steps += 1
+            if steps > MAX_STEPS:
+                raise SimError('step limit exceeded')
+            if op == 'li':
+                self.write(a[0], int(a[1], 0))
+            elif op == 'la':
+                self.write(a[0], self.data_labels[a[1]])
+            elif op == 'mv':
+                self.write(a[0], self.read(a[1]))
+            elif op == 'lw':
+                addr = self.address(a[1])
+                if addr not in self.mem:
+                    raise SimError('read of uninitialized memory at %#x'
+                                   % addr)
+                self.write(a[0], self.mem[addr])
+            elif op == 'sw':
+                self.mem[self.address(a[1])] = self.read(a[0]) & MASK
+            elif op in REG_OPS:
+                self.write(a[0], REG_OPS[op](self.read(a[1]),
+                                             self.read(a[2])))
+            elif op in IMM_OPS:
+                imm = int(a[2], 0)
+                if op not in ('slli', 'srli', 'srai') and \
+                        not -2048 <= imm <= 2047:
+                    raise SimError('immediate out of range: ' + line)
+                self.write(a[0], IMM_OPS[op](self.read(a[1]), imm))
+            elif op == 'seqz':
+                self.write(a[0], int(self.read(a[1]) == 0))
+            elif op == 'snez':
+                self.write(a[0], int(self.read(a[1]) != 0))
+            elif op == 'neg':
+                self.write(a[0], -self.read(a[1]))
+            elif op == 'not':
+                self.write(a[0], ~self.read(a[1]))
+            elif op == 'j':
+                pc = self.labels[a[0]]
+            elif op in ('beqz', 'bnez'):
+                if (self.read(a[0]) == 0) == (op == 'beqz'):
+                    pc = self.labels[a[1]]
+            elif op in BRANCHES:
+                if BRANCHES[op](self.read(a[0]), self.read(a[1])):
+                    pc = self.labels[a[2]]
+            elif op == 'call':
+                if a[0] in self.labels:
+                    self.frames.append(
+                        (pc, {r: self.regs[r] for r in CALLEE_SAVED}))
+                    self.regs['ra'] = pc
+                    pc = self.labels[a[0]]
+                elif not self.call_runtime(a[0]):
+                    raise SimError('unknown function ' + a[0])
+            elif op == 'tail':
+                if a[0] in self.labels:
+                    pc = self.labels[a[0]]
+                elif self.call_runtime(a[0]):
+                    pc = self.regs['ra']
+                else:
+                    raise SimError('unknown function ' + a[0])
+            elif op == 'ret':
+                pc = self.regs['ra']
+                if self.frames and self.frames[-1][0] == pc:
+                    _, saved = self.frames.pop()
+                    clobbered = [r for r in CALLEE_SAVED
+                                 if self.regs[r] != saved[r]]
+                    if clobbered:
+                        raise SimError('callee-saved registers clobbered: '
+                                       + ', '.join(clobbered))
+            else:
+                raise SimError('unsupported instruction: ' + line)
+        if self.regs['sp'] != STACK_TOP:
+            raise SimError('sp not restored on exit')
+        return steps
+
+
+def main():
+    if len(sys.argv) < 2:
+        print('usage: rvsim.py <file.S> [<int>...]', file=sys.stderr)
+        return 2
+    with open(sys.argv[1]) as f:
+        program = assemble(f.read().split('\n'))
+    machine = Machine(*program, [int(x) for x in sys.argv[2:]])
+    try:
+        steps = machine.run()
+    except SimError as e:
+        print('error: %s' % e, file=sys.stderr)
+        return 125
+    sys.stdout.write(''.join(machine.output))
+    print('instructions %d' % steps, file=sys.stderr)
+    return machine.regs['a0'] & 0xFF
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -1,41 +1,115 @@
 #pragma once
 
 #include "FrameInfo.h"
+#include "ParallelCopy.h"
+#include "RegAlloc.h"
 #include "koopa.h"
 
 #include <map>
+#include <ostream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+// 寄存器分配方式：Stack 把所有值放在栈上，Graph 为图着色分配（-O2 默认）
+enum class RegAllocKind { Stack, Graph };
+
+// 整个程序的代码生成，汇编输出到 out；mir 非空时（-dump-mir）
+// 把每个函数的寄存器分配与栈帧布局写到 mir
 class ProgramCodeGen {
 public:
-  ProgramCodeGen() = default;
+  explicit ProgramCodeGen(std::ostream &out,
+                          RegAllocKind regalloc = RegAllocKind::Stack,
+                          std::ostream *mir = nullptr)
+      : out_(out), regalloc_(regalloc), mir_(mir) {}
   ~ProgramCodeGen() = default;
 
   void Emit(const koopa_raw_program_t &program);
 
   void EmitTextSection();
+
+private:
+  std::ostream &out_;
+  RegAllocKind regalloc_;
+  std::ostream *mir_;
+  ClobberMap clobbers_;
 };
 
+/*
+ * 单个函数的代码生成，汇编输出到 out。
+ * clobbers 为已生成函数的改写集合，调用它们时只有其中的寄存器需要避开
+ */
 class FunctionCodeGen {
 public:
-  FunctionCodeGen() = default;
+  FunctionCodeGen(std::ostream &out, RegAllocKind regalloc,
+                  const ClobberMap &clobbers, std::ostream *mir = nullptr)
+      : out_(out), regalloc_(regalloc), clobbers_(clobbers), mir_(mir) {}
   ~FunctionCodeGen() = default;
 
   void Emit(const koopa_raw_function_t &func);
 
+  // 本函数改写的调用者保存寄存器，Emit 之后调用
+  ClobberSet Clobbers() const;
+
 private:
   void EmitPrologue();
   void EmitEpilogue();
+  void EmitFrameSetup();
+  void EmitFrameTeardown();
+  void EmitTailCall(const koopa_raw_value_t &value);
+  bool IsTailCall(const koopa_raw_basic_block_t &bb, size_t index) const;
   void EmitSlice(const koopa_raw_slice_t &slice);
   void EmitBasicBlock(const koopa_raw_basic_block_t &bb);
   void EmitValue(const koopa_raw_value_t &value);
 
   void AllocateStackSpace();
+  void ShrinkWrap();
+  void DumpMIR();
+  bool BlockUsesFrame(koopa_raw_basic_block_t bb);
+  bool CanDeferParam(koopa_raw_value_t param, const std::string &reg,
+                     const MachineCFG &cfg);
+  bool LeavesFrame(koopa_raw_basic_block_t target) const;
+  void AllocateRegisters();
+  void CoalesceBlockArgs();
+  koopa_raw_value_t FindSlotLeader(koopa_raw_value_t val);
+  void AllocValueSlot(koopa_raw_value_t val);
 
   size_t GetStackOffset(koopa_raw_value_t val);
+  Location GetLocation(koopa_raw_value_t val);
+  std::string UseReg(koopa_raw_value_t val, const std::string &scratch);
+  std::string DefReg(koopa_raw_value_t val);
+  void FinishDef(koopa_raw_value_t val, const std::string &reg);
+  void EmitMove(const Location &dst, const Location &src);
 
-  void EmitBlockArgs(koopa_raw_basic_block_t bb, koopa_raw_slice_t args);
+  std::vector<Move> BlockArgCopies(koopa_raw_basic_block_t bb,
+                                   koopa_raw_slice_t args);
+  void EmitCopies(const std::vector<Move> &copies);
+  void EmitEdge(koopa_raw_basic_block_t target,
+                const std::vector<Move> &copies);
 
+  std::ostream &out_;
+  RegAllocKind regalloc_;
+  const ClobberMap &clobbers_;
+  std::ostream *mir_;
   koopa_raw_function_t func_;
   FrameInfo stack_frame_;
+  std::string block_label_;
+
+  // 分配到寄存器的值，其余的值位于栈槽
+  std::unordered_map<koopa_raw_value_t, std::string> regs_;
+
+  // 共用栈槽的值（合并的块参数与实参、同一节点上溢出的值）：
+  // 并查集的父节点，以及每个集合的栈槽所有者
+  std::unordered_map<koopa_raw_value_t, koopa_raw_value_t> slot_leader_;
+  std::unordered_map<koopa_raw_value_t, koopa_raw_value_t> slot_owner_;
+
+  // 收缩包装：在 save_point_ 处建立栈帧，frame_blocks_ 为栈帧存在的基本块，
+  // 离开它们的边上释放栈帧。deferred_params_ 中的形参在建立栈帧之前留在
+  // 传入的 a0 ~ a7 中，到 save_point_ 再由 deferred_copies_ 移到各自的位置
+  koopa_raw_basic_block_t save_point_ = nullptr;
+  std::unordered_set<koopa_raw_basic_block_t> frame_blocks_;
+  std::unordered_map<koopa_raw_value_t, std::string> deferred_params_;
+  std::vector<Move> deferred_copies_;
+  bool in_frame_ = true;
 };
@@ -4,7 +4,10 @@
 
 #include <cstddef>
 #include <iostream>
+#include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 class FrameInfo {
 public:
@@ -17,13 +20,79 @@ public:
     stack_size_ += size;
   }
 
+  // 活跃范围不冲突的值共用 owner 的栈槽
+  void ShareSlot(koopa_raw_value_t value, koopa_raw_value_t owner) {
+    offset_[value] = offset_.at(owner);
+  }
+
   size_t GetOffset(koopa_raw_value_t value) { return offset_.at(value); }
 
+  bool HasSlot(koopa_raw_value_t value) const { return offset_.count(value); }
+
+  /*
+   * 为超过 8 个的实参在栈底预留传参区，必须在分配其它栈槽之前调用
+   */
+  void ReserveOutgoingArgs(size_t num_args) {
+    size_t size = num_args > 8 ? (num_args - 8) * 4 : 0;
+    if (size > stack_size_)
+      stack_size_ = size;
+  }
+
+  // 第 index 个 (>= 8) 形参位于调用者的传参区，即本函数栈帧之上
+  void BindIncomingArg(koopa_raw_value_t value, size_t index) {
+    incoming_args_.push_back({value, index});
+  }
+
   size_t GetStackSize() { return stack_size_; }
 
-  void Align() { stack_size_ = (stack_size_ + 15) & ~15; }
+  // 函数体内存在 call 指令，ra 会被覆盖，需要保存
+  void MarkHasCall() { has_call_ = true; }
+
+  bool IsLeaf() const { return !has_call_; }
+
+  // 记录函数实际使用到的 callee-saved 寄存器 (s0 ~ s11)
+  void MarkCalleeSavedUsed(const std::string &reg) {
+    for (const auto &r : callee_saved_used_)
+      if (r == reg)
+        return;
+    callee_saved_used_.push_back(reg);
+  }
+
+  // 需要在序言中保存、尾声中恢复的寄存器及其栈偏移
+  const std::vector<std::pair<std::string, size_t>> &GetSavedRegs() const {
+    return saved_regs_;
+  }
+
+  // 栈帧大小为 0 时序言和尾声都不需要调整 sp
+  bool NeedsFrame() const { return stack_size_ > 0; }
+
+  /*
+   * 确定栈帧布局：传参区与局部变量在低地址，保存的寄存器紧随其后，
+   * 最后按 16 字节对齐。叶子函数不保存 ra，未使用的 callee-saved
+   * 寄存器也不保存
+   */
+  void Align() {
+    saved_regs_.clear();
+    if (has_call_) {
+      saved_regs_.push_back({"ra", stack_size_});
+      stack_size_ += 4;
+    }
+    for (const auto &reg : callee_saved_used_) {
+      saved_regs_.push_back({reg, stack_size_});
+      stack_size_ += 4;
+    }
+    stack_size_ = (stack_size_ + 15) & ~15;
+    for (const auto &[value, index] : incoming_args_) {
+      offset_[value] = stack_size_ + (index - 8) * 4;
+    }
+  }
 
 private:
   size_t stack_size_ = 0;
   std::unordered_map<koopa_raw_value_t, size_t> offset_;
-};
\ No newline at end of file
+
+  bool has_call_ = false;
+  std::vector<std::string> callee_saved_used_;
+  std::vector<std::pair<std::string, size_t>> saved_regs_;
+  std::vector<std::pair<koopa_raw_value_t, size_t>> incoming_args_;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "koopa.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using ValueSet = std::unordered_set<koopa_raw_value_t>;
+
+/*
+ * Koopa 函数上的活跃变量分析。
+ * 需要分配位置的值（变量）为：函数形参、块参数与有结果的非 alloc 指令。
+ * 跳转携带的实参视为前驱块末尾的使用，块参数在块入口处定义，
+ * 函数形参在入口块的入口处定义
+ */
+class Liveness {
+public:
+  explicit Liveness(koopa_raw_function_t func);
+
+  static bool IsVariable(koopa_raw_value_t value);
+  // 指令读取的变量，跳转的实参也计入
+  static std::vector<koopa_raw_value_t> Uses(koopa_raw_value_t inst);
+  static std::vector<koopa_raw_basic_block_t>
+  Succs(koopa_raw_value_t terminator);
+
+  const ValueSet &LiveIn(koopa_raw_basic_block_t bb) const {
+    return live_in_.at(bb);
+  }
+  const ValueSet &LiveOut(koopa_raw_basic_block_t bb) const {
+    return live_out_.at(bb);
+  }
+
+  // 同时活跃的变量之间互相冲突
+  std::unordered_map<koopa_raw_value_t, ValueSet> BuildInterference() const;
+  // 每条 call 指令之后仍然活跃的变量（不含调用结果），它们跨越了该调用
+  std::vector<std::pair<koopa_raw_value_t, ValueSet>> CallCrossings() const;
+
+private:
+  koopa_raw_function_t func_;
+  std::vector<koopa_raw_basic_block_t> blocks_;
+  std::unordered_map<koopa_raw_basic_block_t, ValueSet> live_in_;
+  std::unordered_map<koopa_raw_basic_block_t, ValueSet> live_out_;
+};
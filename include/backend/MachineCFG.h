@@ -0,0 +1,64 @@
+#pragma once
+
+#include "koopa.h"
+
+#include <unordered_map>
+#include <vector>
+
+/*
+ * 后端的控制流图：前驱/后继、从入口可达的基本块的逆后序、
+ * 支配树、后支配关系与循环嵌套深度（由回边的自然循环得到）
+ */
+class MachineCFG {
+public:
+  explicit MachineCFG(koopa_raw_function_t func);
+
+  koopa_raw_basic_block_t Entry() const { return blocks_.front(); }
+  // 基本块按函数中的排列顺序
+  const std::vector<koopa_raw_basic_block_t> &Blocks() const {
+    return blocks_;
+  }
+  const std::vector<koopa_raw_basic_block_t> &ReversePostOrder() const {
+    return rpo_;
+  }
+
+  const std::vector<koopa_raw_basic_block_t> &
+  Preds(koopa_raw_basic_block_t bb) const {
+    return preds_.at(bb);
+  }
+  const std::vector<koopa_raw_basic_block_t> &
+  Succs(koopa_raw_basic_block_t bb) const {
+    return succs_.at(bb);
+  }
+
+  bool IsReachable(koopa_raw_basic_block_t bb) const {
+    return rpo_index_.count(bb);
+  }
+  bool Dominates(koopa_raw_basic_block_t a, koopa_raw_basic_block_t b) const;
+  // 入口块的直接支配者为其自身
+  koopa_raw_basic_block_t IDom(koopa_raw_basic_block_t bb) const {
+    return idom_.at(bb);
+  }
+  koopa_raw_basic_block_t
+  NearestCommonDominator(koopa_raw_basic_block_t a,
+                         koopa_raw_basic_block_t b) const;
+  // 从 b 出发到达函数返回的每条路径都经过 a
+  bool PostDominates(koopa_raw_basic_block_t a,
+                     koopa_raw_basic_block_t b) const;
+
+  // 不在任何循环中的基本块深度为 0
+  int LoopDepth(koopa_raw_basic_block_t bb) const;
+
+private:
+  void ComputeDominators();
+  void ComputeLoopDepth();
+
+  std::vector<koopa_raw_basic_block_t> blocks_;
+  std::unordered_map<koopa_raw_basic_block_t,
+                     std::vector<koopa_raw_basic_block_t>>
+      preds_, succs_;
+  std::vector<koopa_raw_basic_block_t> rpo_;
+  std::unordered_map<koopa_raw_basic_block_t, size_t> rpo_index_;
+  std::unordered_map<koopa_raw_basic_block_t, koopa_raw_basic_block_t> idom_;
+  std::unordered_map<koopa_raw_basic_block_t, int> loop_depth_;
+};
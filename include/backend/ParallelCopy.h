@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 值所在的位置：立即数、寄存器或相对 sp 的栈槽
+struct Location {
+  enum class Kind { Imm, Reg, Stack };
+
+  Kind kind;
+  int32_t imm = 0;
+  std::string reg;
+  size_t offset = 0;
+
+  static Location Imm(int32_t imm) { return {Kind::Imm, imm, "", 0}; }
+  static Location Reg(std::string reg) {
+    return {Kind::Reg, 0, std::move(reg), 0};
+  }
+  static Location Stack(size_t offset) { return {Kind::Stack, 0, "", offset}; }
+
+  bool operator==(const Location &other) const {
+    return kind == other.kind && imm == other.imm && reg == other.reg &&
+           offset == other.offset;
+  }
+  bool operator!=(const Location &other) const { return !(*this == other); }
+};
+
+struct Move {
+  Location dst;
+  Location src;
+};
+
+/*
+ * 把并行复制（所有源在任何写入之前读取）排成等价的顺序复制。
+ * 每次选出一个目标不再被其它复制读取的复制输出；剩下的全部成环时，
+ * 先把环中一个目标保存到 temp，改为从 temp 读取以打开环。
+ * 各复制的目标互不相同；立即数不会被写入，其复制放在最后
+ */
+inline std::vector<Move> SequentializeCopies(const std::vector<Move> &copies,
+                                             const Location &temp) {
+  std::vector<Move> pending, constants, result;
+  for (const auto &copy : copies) {
+    if (copy.src.kind == Location::Kind::Imm) {
+      constants.push_back(copy);
+    } else if (copy.dst != copy.src) {
+      pending.push_back(copy);
+    }
+  }
+
+  auto is_read = [&](const Location &loc) {
+    for (const auto &copy : pending) {
+      if (copy.src == loc) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  while (!pending.empty()) {
+    bool emitted = false;
+    for (size_t i = 0; i < pending.size(); ++i) {
+      if (!is_read(pending[i].dst)) {
+        result.push_back(pending[i]);
+        pending.erase(pending.begin() + i);
+        emitted = true;
+        break;
+      }
+    }
+    if (emitted) {
+      continue;
+    }
+
+    Location saved = pending.front().dst;
+    result.push_back({temp, saved});
+    for (auto &copy : pending) {
+      if (copy.src == saved) {
+        copy.src = temp;
+      }
+    }
+  }
+
+  result.insert(result.end(), constants.begin(), constants.end());
+  return result;
+}
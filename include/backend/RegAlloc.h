@@ -0,0 +1,157 @@
+#pragma once
+
+#include "backend/Liveness.h"
+#include "backend/MachineCFG.h"
+#include "koopa.h"
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/*
+ * 参与分配的寄存器，调用者保存的在前，着色时优先使用。
+ * t0 ~ t2 保留：装载溢出的操作数、栈槽之间的复制与打断复制环
+ */
+inline const std::vector<std::string> &AllocatableRegs() {
+  static const std::vector<std::string> regs = {
+      "t3", "t4", "t5", "t6", "a0", "a1", "a2",  "a3",
+      "a4", "a5", "a6", "a7", "s0", "s1", "s2",  "s3",
+      "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11"};
+  return regs;
+}
+
+inline bool IsCalleeSaved(const std::string &reg) { return reg[0] == 's'; }
+
+/*
+ * 过程间寄存器分配：函数（连同它调用的函数）实际改写的调用者保存寄存器。
+ * 按调用图自底向上生成代码时逐个记录，不在表中的函数（库函数、
+ * 调用环上尚未生成的函数）按调用约定视为改写全部调用者保存的寄存器
+ */
+using ClobberSet = std::set<std::string>;
+using ClobberMap = std::unordered_map<koopa_raw_function_t, ClobberSet>;
+
+// 一条调用改写的寄存器：被调函数的改写集合，加上传递实参与返回值的寄存器
+inline ClobberSet CallClobbers(koopa_raw_value_t call,
+                               const ClobberMap &clobbers) {
+  const auto &data = call->kind.data.call;
+  ClobberSet result;
+  auto it = clobbers.find(data.callee);
+  if (it != clobbers.end()) {
+    result = it->second;
+  } else {
+    for (const auto &reg : AllocatableRegs()) {
+      if (!IsCalleeSaved(reg))
+        result.insert(reg);
+    }
+  }
+  result.insert("a0");
+  for (size_t i = 0; i < data.args.len && i < 8; ++i) {
+    result.insert("a" + std::to_string(i));
+  }
+  return result;
+}
+
+/*
+ * 迭代寄存器合并（George & Appel）的图着色寄存器分配。
+ * 冲突图由活跃变量分析得到，物理寄存器为预着色节点：
+ * 跨越调用的变量与该调用改写的寄存器冲突（见 CallClobbers）。
+ * 传递块参数、函数形参与返回值、调用的实参与结果都是可合并的复制。
+ * 无法着色的变量溢出到栈上，使用时经 t0/t1 装载，因此不需要重写程序再分配；
+ * 溢出时优先选择按循环深度加权的使用次数与度数之比最小的节点
+ */
+class GraphColoringAllocator {
+public:
+  GraphColoringAllocator(koopa_raw_function_t func, const Liveness &liveness,
+                         const MachineCFG &cfg, const ClobberMap &clobbers);
+
+  void Run();
+
+  // 变量分配到的寄存器，溢出的变量不在其中
+  const std::unordered_map<koopa_raw_value_t, std::string> &
+  Assignment() const {
+    return assignment_;
+  }
+
+  // 合并到同一节点的变量溢出时共用一个栈槽，返回代表该节点的变量
+  koopa_raw_value_t SpillLeader(koopa_raw_value_t value) const;
+
+private:
+  enum class NodeState {
+    Precolored,
+    Initial,
+    Simplify,
+    Freeze,
+    Spill,
+    Coalesced,
+    Colored,
+    Spilled,
+    OnStack
+  };
+  enum class MoveState { Worklist, Active, Coalesced, Constrained, Frozen };
+
+  void Build();
+  int NodeOf(koopa_raw_value_t value) const;
+  void AddEdge(int u, int v);
+  void AddMove(koopa_raw_value_t value, int reg);
+  void AddMove(koopa_raw_value_t dst, koopa_raw_value_t src);
+  void ComputeSpillCosts();
+
+  void MakeWorklist();
+  std::vector<int> Adjacent(int n) const;
+  std::vector<int> NodeMoves(int n) const;
+  bool MoveRelated(int n) const { return !NodeMoves(n).empty(); }
+  void SetState(int n, NodeState state);
+
+  void Simplify();
+  void DecrementDegree(int m);
+  void EnableMoves(int n);
+  void Coalesce();
+  void AddWorkList(int u);
+  bool OK(int t, int r) const;
+  bool Conservative(const std::vector<int> &nodes) const;
+  int GetAlias(int n) const;
+  void Combine(int u, int v);
+  void Freeze();
+  void FreezeMoves(int u);
+  void SelectSpill();
+  void AssignColors();
+
+  bool IsPrecolored(int n) const { return n < K; }
+  bool Interferes(int u, int v) const {
+    return adj_set_.count(EdgeKey(u, v)) > 0;
+  }
+  static uint64_t EdgeKey(int u, int v) {
+    return (static_cast<uint64_t>(u) << 32) | static_cast<uint32_t>(v);
+  }
+
+  const int K;
+  koopa_raw_function_t func_;
+  const Liveness &liveness_;
+  const MachineCFG &cfg_;
+  const ClobberMap &clobbers_;
+
+  std::vector<koopa_raw_value_t> values_; // 节点 K + i 对应的变量
+  std::unordered_map<koopa_raw_value_t, int> nodes_;
+
+  std::unordered_set<uint64_t> adj_set_;
+  std::vector<std::vector<int>> adj_list_;
+  std::vector<int> degree_;
+  std::vector<NodeState> state_;
+  std::vector<int> alias_;
+  std::vector<int> color_;
+  std::vector<double> spill_cost_;
+
+  std::vector<std::pair<int, int>> moves_;
+  std::vector<MoveState> move_state_;
+  std::vector<std::vector<int>> move_list_;
+
+  std::set<int> simplify_worklist_, freeze_worklist_, spill_worklist_;
+  std::set<int> worklist_moves_, active_moves_;
+  std::vector<int> select_stack_;
+
+  std::unordered_map<koopa_raw_value_t, std::string> assignment_;
+};
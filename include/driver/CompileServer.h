@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct CompileRequest {
+  std::string mode;              // -koopa 或 -riscv
+  std::vector<std::string> args; // 编译选项，与命令行相同
+  std::string source;
+};
+
+struct CompileResponse {
+  bool succeeded = false;
+  std::string output;      // IR 文本或汇编
+  std::string diagnostics; // 错误信息、-pass-remarks 与 -time-passes 的输出
+};
+
+/*
+ * 常驻的编译服务器：在 Unix 域套接字上接受编译请求，交给线程池编译后返回结果，
+ * 省去每个文件启动进程的开销。每个连接发送一个请求、收到一个响应，
+ * 消息由若干帧组成，每帧为 4 字节网络字节序的长度加内容：
+ *   请求：mode、编译选项（以换行分隔）、源程序
+ *   响应：状态（ok 或 error）、输出、诊断信息
+ */
+namespace CompileServer {
+
+// 监听 socket_path 直到收到 SIGINT 或 SIGTERM；无法监听（包括 socket_path
+// 是其他文件或已有服务器在监听）或 accept 出错时返回 false
+bool Serve(const std::string &socket_path, size_t threads);
+
+// 作为客户端发送请求；无法连接服务器或通信失败时返回 false
+bool Request(const std::string &socket_path, const CompileRequest &request,
+             CompileResponse &response);
+
+} // namespace CompileServer
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "backend/CodeGen.h"
+#include "frontend/AST.h"
+#include "frontend/Lexer.h"
+#include "opt/PassManager.h"
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 一个文件的编译任务，对应命令行中的 <mode> <input> -o <output>
+struct CompileJob {
+  std::string mode; // -koopa 或 -riscv
+  std::string input;
+  std::string output;
+};
+
+// 诊断转储，默认全部关闭；IR 转储见 PassOptions::dump_ir_after
+struct DumpOptions {
+  bool ast = false; // -dump-ast
+  bool mir = false; // -dump-mir，寄存器分配与栈帧布局
+  std::string file; // -dump-file=<path>，为空时与诊断信息一起输出
+};
+
+struct CompileOptions {
+  PassOptions pass_options;
+  RegAllocKind regalloc = RegAllocKind::Stack;
+  DumpOptions dump;
+  LexerKind lexer = LexerKind::Flex; // -lexer=flex|hand
+
+  bool DumpEnabled() const {
+    return dump.ast || dump.mir || !pass_options.dump_ir_after.empty();
+  }
+};
+
+/*
+ * 编译驱动：解析、生成 IR、优化与代码生成。
+ * 每次编译的状态（scanner、AST、IR 模块、优化遍）都是局部的，
+ * 因此多个线程可以同时编译不同的文件
+ */
+namespace Driver {
+
+// 解析十进制的无符号整数：text 必须全部是数字且不超出 size_t，
+// 否则返回 false 且不修改 value
+bool ParseUnsigned(std::string_view text, size_t &value);
+
+// 解析 -O<n>、-passes= 等编译选项；未指定 -regalloc= 时
+// -O2 使用图着色分配，其余把所有值放在栈上
+bool ParseOptions(const std::vector<std::string> &args,
+                  CompileOptions &options, std::ostream &err);
+
+// 用 lexer 指定的词法分析器解析内存中的源程序，错误信息写入 err，
+// 语法错误时返回 nullptr。第一个版本就地扫描 buffer，要求 buffer[size]
+// 与 buffer[size + 1] 为 '\0'；第二个版本使用 Flex 时先把 source
+// 复制到 scanner 中，手写的 Lexer 则直接扫描 source
+std::unique_ptr<BaseAST> Parse(char *buffer, size_t size, LexerKind lexer,
+                               std::ostream &err);
+std::unique_ptr<BaseAST> Parse(std::string_view source, LexerKind lexer,
+                               std::ostream &err);
+
+// 编译内存中的源程序，结果写入 out；诊断信息（错误、-pass-remarks 与
+// -time-passes 的输出）写入 err，失败时返回 false。转储同样写入 err，
+// 不接受 -dump-file=
+bool CompileSource(std::string_view source, const std::string &mode,
+                   const CompileOptions &options, std::ostream &out,
+                   std::ostream &err);
+
+// 编译单个文件，诊断信息输出到 stderr，失败时返回 false
+bool Compile(const CompileJob &job, const CompileOptions &options);
+
+// 读取批量编译的任务列表：每行一个任务，格式为 <mode> <input> -o <output>，
+// 忽略空行与 # 开头的行
+bool ReadJobList(const std::string &path, std::vector<CompileJob> &jobs);
+
+// 用 threads 个工作线程编译所有任务，返回失败的任务数
+size_t CompileBatch(const std::vector<CompileJob> &jobs,
+                    const CompileOptions &options, size_t threads);
+
+} // namespace Driver
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+ * 映射到内存的源文件，末尾额外有两个 '\0'，可以直接交给 Flex 的
+ * yy_scan_buffer 就地扫描，不经过 stdio 与 scanner 自己的缓冲区。
+ * 映射是私有的：scanner 会在缓冲区中临时写入 '\0' 来结束 yytext，
+ * 这些写入只影响本进程中被写到的页，不会改动文件。
+ * 不能映射的输入（如管道）退回到一次读入内存
+ */
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  // 打开并映射 path，失败时返回 false
+  bool Open(const std::string &path);
+
+  char *Data() { return data_; }
+  // 文件的长度，不含末尾的两个 '\0'
+  size_t Size() const { return size_; }
+
+private:
+  char *data_ = nullptr;
+  size_t size_ = 0;
+  size_t mapped_size_ = 0;   // 映射的长度，为 0 时 data_ 指向 fallback_
+  std::vector<char> fallback_;
+};
@@ -21,15 +21,24 @@ public:
 /// 编译单元
 class CompUnitAST : public BaseAST {
 public:
-  std::unique_ptr<BaseAST> func_def;
+  std::vector<std::unique_ptr<BaseAST>> func_defs;
+  void Accept(ASTVisitor &visitor) override;
+};
+
+/// 函数形参: BType IDENT
+class FuncFParamAST : public BaseAST {
+public:
+  std::string btype; // "int"
+  std::string ident;
   void Accept(ASTVisitor &visitor) override;
 };
 
 /// 函数定义
 class FuncDefAST : public BaseAST {
 public:
-  std::string ret_type;
+  std::string ret_type; // "int" or "void"
   std::string ident;
+  std::vector<std::unique_ptr<FuncFParamAST>> params;
   std::unique_ptr<BaseAST> block;
 
   void Accept(ASTVisitor &visitor) override;
@@ -139,6 +148,14 @@ public:
   void Accept(ASTVisitor &visitor) override;
 };
 
+/// 函数调用: IDENT "(" [FuncRParams] ")"
+class CallExpAST : public BaseAST {
+public:
+  std::string ident;
+  std::vector<std::unique_ptr<BaseAST>> args;
+  void Accept(ASTVisitor &visitor) override;
+};
+
 /// 一元表达式
 class UnaryExpAST : public BaseAST {
 public:
@@ -158,6 +175,7 @@ public:
 };
 
 inline void CompUnitAST::Accept(ASTVisitor &visitor) { visitor.Visit(*this); }
+inline void FuncFParamAST::Accept(ASTVisitor &visitor) { visitor.Visit(*this); }
 inline void FuncDefAST::Accept(ASTVisitor &visitor) { visitor.Visit(*this); }
 inline void BlockAST::Accept(ASTVisitor &visitor) { visitor.Visit(*this); }
 inline void ConstDeclAST::Accept(ASTVisitor &visitor) { visitor.Visit(*this); }
@@ -171,5 +189,6 @@ inline void WhileStmtAST::Accept(ASTVisitor &visitor) { visitor.Visit(*this); }
 inline void ReturnStmtAST::Accept(ASTVisitor &visitor) { visitor.Visit(*this); }
 inline void LValAST::Accept(ASTVisitor &visitor) { visitor.Visit(*this); }
 inline void NumberAST::Accept(ASTVisitor &visitor) { visitor.Visit(*this); }
+inline void CallExpAST::Accept(ASTVisitor &visitor) { visitor.Visit(*this); }
 inline void UnaryExpAST::Accept(ASTVisitor &visitor) { visitor.Visit(*this); }
 inline void BinaryExpAST::Accept(ASTVisitor &visitor) { visitor.Visit(*this); }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 class CompUnitAST;
+class FuncFParamAST;
 class FuncDefAST;
 class BlockAST;
 class ConstDeclAST;
@@ -14,6 +15,7 @@ class WhileStmtAST;
 class ReturnStmtAST;
 class LValAST;
 class NumberAST;
+class CallExpAST;
 class UnaryExpAST;
 class BinaryExpAST;
 
@@ -22,6 +24,7 @@ public:
   virtual ~ASTVisitor() = default;
 
   virtual void Visit(CompUnitAST &node) = 0;
+  virtual void Visit(FuncFParamAST &node) = 0;
   virtual void Visit(FuncDefAST &node) = 0;
   virtual void Visit(BlockAST &node) = 0;
   virtual void Visit(ConstDeclAST &node) = 0;
@@ -35,6 +38,7 @@ public:
   virtual void Visit(ReturnStmtAST &node) = 0;
   virtual void Visit(LValAST &node) = 0;
   virtual void Visit(NumberAST &node) = 0;
+  virtual void Visit(CallExpAST &node) = 0;
   virtual void Visit(UnaryExpAST &node) = 0;
   virtual void Visit(BinaryExpAST &node) = 0;
 };
\ No newline at end of file
@@ -2,15 +2,17 @@
 
 #include "frontend/ASTVisitor.h"
 
-#include <fstream>
+#include <ostream>
 #include <string>
 
 class DumpVisitor : public ASTVisitor {
 public:
-  DumpVisitor(const std::string &filename = "hello.ast");
-  ~DumpVisitor();
+  // 以缩进表示层次，把 AST 输出到 out
+  explicit DumpVisitor(std::ostream &out) : out_stream(out) {}
+  ~DumpVisitor() = default;
 
   void Visit(CompUnitAST &node) override;
+  void Visit(FuncFParamAST &node) override;
   void Visit(FuncDefAST &node) override;
   void Visit(BlockAST &node) override;
   void Visit(ConstDeclAST &node) override;
@@ -24,12 +26,13 @@ public:
   void Visit(ReturnStmtAST &node) override;
   void Visit(LValAST &node) override;
   void Visit(NumberAST &node) override;
+  void Visit(CallExpAST &node) override;
   void Visit(UnaryExpAST &node) override;
   void Visit(BinaryExpAST &node) override;
 
 private:
   int indent_level = 0;
-  mutable std::ofstream out_file;
+  std::ostream &out_stream;
 
   void print_indent() const;
   void print_node(const std::string &name);
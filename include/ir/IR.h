@@ -4,6 +4,7 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
@@ -24,6 +25,9 @@ enum class Opcode {
   // Logical
   And,
   Or,
+  // Bitwise
+  Xor,
+  Sar, // arithmetic shift right
   // Memory
   Alloc, // allocate local variable
   Load,  // load from memory
@@ -77,15 +81,78 @@ struct BranchTarget {
       : target(bb), args(std::move(arguments)) {}
 };
 
-using Operand = std::variant<Value, BasicBlock *, BranchTarget>;
+using Operand = std::variant<Value, BasicBlock *, BranchTarget, Function *>;
+
+struct Instruction;
+
+/*
+ * 值的一次使用：user 指令中保存该值的操作数槽位。
+ * 指令插入基本块后 args 不再增删，槽位地址保持有效
+ */
+struct Use {
+  Instruction *user;
+  Value *slot;
+};
 
 struct Instruction {
   Opcode op;
   std::vector<Operand> args;
+  // 所在的基本块，未插入时为 nullptr
+  BasicBlock *parent = nullptr;
 
   template <typename... Args> Instruction(Opcode op, Args &&...args) : op(op) {
     (this->args.emplace_back(std::forward<Args>(args)), ...);
   }
+
+  // 二元运算指令: %res = op lhs, rhs
+  bool IsBinary() const { return op >= Opcode::Add && op <= Opcode::Sar; }
+
+  // 比较指令，结果只可能是 0 或 1
+  bool IsComparison() const { return op >= Opcode::Lt && op <= Opcode::Ne; }
+
+  // 是否定义了一个结果 (args[0])；调用 void 函数的 call 没有结果
+  bool HasResult() const {
+    if (op == Opcode::Call) {
+      return std::holds_alternative<Value>(args[0]);
+    }
+    return IsBinary() || op == Opcode::Alloc || op == Opcode::Load;
+  }
+
+  /*
+   * call 的被调函数，实参紧随其后:
+   *   [%res,] callee, arg0, arg1, ...
+   */
+  size_t CalleeIndex() const { return HasResult() ? 1 : 0; }
+  Function *Callee() const {
+    return std::get<Function *>(args[CalleeIndex()]);
+  }
+
+  const Value &Result() const { return std::get<Value>(args[0]); }
+
+  Value &ValueAt(size_t index) { return std::get<Value>(args[index]); }
+  const Value &ValueAt(size_t index) const {
+    return std::get<Value>(args[index]);
+  }
+
+  // 遍历被使用的值（不含 args[0] 处定义的结果），包括跳转目标的块参数
+  template <typename F> void ForEachUse(F &&f) { ForEachUseImpl(*this, f); }
+  template <typename F> void ForEachUse(F &&f) const {
+    ForEachUseImpl(*this, f);
+  }
+
+private:
+  template <typename Self, typename F>
+  static void ForEachUseImpl(Self &self, F &f) {
+    for (size_t i = self.HasResult() ? 1 : 0; i < self.args.size(); ++i) {
+      if (auto *value = std::get_if<Value>(&self.args[i])) {
+        f(*value);
+      } else if (auto *target = std::get_if<BranchTarget>(&self.args[i])) {
+        for (auto &value : target->args) {
+          f(value);
+        }
+      }
+    }
+  }
 };
 
 struct BasicBlock {
@@ -117,9 +184,21 @@ struct BasicBlock {
     return Value::Reg(param_name);
   }
 
-  void Append(std::unique_ptr<Instruction> inst) {
-    insts.push_back(std::move(inst));
-  }
+  /*
+   * 以下接口在增删指令的同时维护函数的 use-def 链，
+   * 优化遍不应直接修改 insts 中指令的集合
+   */
+  Instruction *Append(std::unique_ptr<Instruction> inst);
+  Instruction *Insert(size_t index, std::unique_ptr<Instruction> inst);
+  // 从块中摘下指令并注销其使用，可再插入其它块
+  std::unique_ptr<Instruction> Take(Instruction *inst);
+  void Erase(Instruction *inst);
+  // 将 from 的全部指令按序移到本块末尾，同一函数内移动不影响 use-def 链
+  void Splice(BasicBlock *from);
+  // 将 index 及其后的指令按序移到 dest 末尾，用于拆分基本块
+  void SplitAt(size_t index, BasicBlock *dest);
+  // 删除所有满足 pred 的指令，只遍历一次
+  template <typename Pred> bool EraseIf(Pred &&pred);
 
   static BasicBlock *Create(Function *func, std::string name) {
     return new BasicBlock(func, std::move(name));
@@ -128,7 +207,10 @@ struct BasicBlock {
 
 struct Function {
   std::string name;
-  std::string ret_type;
+  std::string ret_type; // "i32" or "void"
+  /* 形参列表 */
+  std::vector<std::pair<std::string, std::string>>
+      params; // [(name, type), ...]
   std::vector<std::unique_ptr<BasicBlock>> blocks;
 
   // 函数的 exit 块（统一返回出口）
@@ -137,8 +219,200 @@ struct Function {
   Function(std::string name = "", std::string ret_type = "")
       : name(std::move(name)), ret_type(std::move(ret_type)) {}
 
+  // 没有基本块的函数只是声明（如 SysY 运行时库函数）
+  bool IsDeclaration() const { return blocks.empty(); }
+
+  Value AddParam(const std::string &param_name, const std::string &type) {
+    params.push_back({param_name, type});
+    return Value::Reg(param_name);
+  }
+
   BasicBlock *CreateBlock(const std::string &block_name) {
     blocks.push_back(std::make_unique<BasicBlock>(this, block_name));
     return blocks.back().get();
   }
+
+  // 删除基本块，块内剩余指令的使用一并注销
+  void RemoveBlock(BasicBlock *bb) {
+    for (auto &inst : bb->insts) {
+      UntrackInst(inst.get());
+    }
+    for (auto it = blocks.begin(); it != blocks.end(); ++it) {
+      if (it->get() == bb) {
+        blocks.erase(it);
+        break;
+      }
+    }
+  }
+
+  /*
+   * use-def 链：以寄存器/地址名为键，记录定义它的指令与所有使用点。
+   * 块参数没有定义指令，GetDef 返回 nullptr
+   */
+  const std::vector<Use> &Uses(const Value &value) const {
+    static const std::vector<Use> empty;
+    if (value.isImmediate()) {
+      return empty;
+    }
+    auto it = uses_.find(value.reg_or_addr);
+    return it == uses_.end() ? empty : it->second;
+  }
+
+  bool HasUses(const Value &value) const { return !Uses(value).empty(); }
+
+  Instruction *GetDef(const Value &value) const {
+    if (value.isImmediate()) {
+      return nullptr;
+    }
+    auto it = defs_.find(value.reg_or_addr);
+    return it == defs_.end() ? nullptr : it->second;
+  }
+
+  // 将 from 的所有使用改为 to，代价与 from 的使用次数成正比
+  void ReplaceAllUsesWith(const Value &from, const Value &to) {
+    if (from.isImmediate() ||
+        (!to.isImmediate() && to.reg_or_addr == from.reg_or_addr)) {
+      return;
+    }
+    auto node = uses_.extract(from.reg_or_addr);
+    if (node.empty()) {
+      return;
+    }
+    for (const Use &use : node.mapped()) {
+      *use.slot = to;
+      AddUse(use);
+    }
+  }
+
+  // 修改 user 中的一个操作数槽位
+  void SetOperand(Instruction *user, Value &slot, const Value &value) {
+    RemoveUse({user, &slot});
+    slot = value;
+    AddUse({user, &slot});
+  }
+
+  /*
+   * 登记/注销指令的定义与全部使用，由 BasicBlock 的增删接口调用；
+   * 整块重建指令序列的遍也可以直接调用，但需自行维护 parent
+   */
+  void TrackInst(Instruction *inst) {
+    if (inst->HasResult()) {
+      defs_[inst->Result().reg_or_addr] = inst;
+    }
+    inst->ForEachUse([&](Value &value) { AddUse({inst, &value}); });
+  }
+
+  void UntrackInst(Instruction *inst) {
+    if (inst->HasResult()) {
+      auto it = defs_.find(inst->Result().reg_or_addr);
+      if (it != defs_.end() && it->second == inst) {
+        defs_.erase(it);
+      }
+    }
+    inst->ForEachUse([&](Value &value) { RemoveUse({inst, &value}); });
+  }
+
+  /*
+   * 供优化遍新建临时寄存器，名称为 %<prefix>_<index>，
+   * 不会与 IRBuilder 生成的 %<index> 冲突
+   */
+  Value NewTempReg(const std::string &prefix) {
+    return Value::Reg("%" + prefix + "_" + std::to_string(NextTempId(prefix)));
+  }
+
+  // 按前缀递增的编号，供优化遍构造函数内唯一的名称
+  int NextTempId(const std::string &prefix) {
+    return ++temp_reg_counters_[prefix];
+  }
+
+private:
+  void AddUse(const Use &use) {
+    if (!use.slot->isImmediate()) {
+      uses_[use.slot->reg_or_addr].push_back(use);
+    }
+  }
+
+  void RemoveUse(const Use &use) {
+    if (use.slot->isImmediate()) {
+      return;
+    }
+    auto it = uses_.find(use.slot->reg_or_addr);
+    if (it == uses_.end()) {
+      return;
+    }
+    auto &list = it->second;
+    for (size_t i = 0; i < list.size(); ++i) {
+      if (list[i].slot == use.slot) {
+        list[i] = list.back();
+        list.pop_back();
+        break;
+      }
+    }
+    if (list.empty()) {
+      uses_.erase(it);
+    }
+  }
+
+  std::unordered_map<std::string, int> temp_reg_counters_;
+  std::unordered_map<std::string, Instruction *> defs_;
+  std::unordered_map<std::string, std::vector<Use>> uses_;
 };
+
+inline Instruction *BasicBlock::Append(std::unique_ptr<Instruction> inst) {
+  return Insert(insts.size(), std::move(inst));
+}
+
+inline Instruction *BasicBlock::Insert(size_t index,
+                                       std::unique_ptr<Instruction> inst) {
+  Instruction *raw = inst.get();
+  raw->parent = this;
+  func->TrackInst(raw);
+  insts.insert(insts.begin() + index, std::move(inst));
+  return raw;
+}
+
+inline std::unique_ptr<Instruction> BasicBlock::Take(Instruction *inst) {
+  // 常见情形是摘下末尾的终结指令，从后往前找
+  for (size_t i = insts.size(); i-- > 0;) {
+    if (insts[i].get() == inst) {
+      std::unique_ptr<Instruction> taken = std::move(insts[i]);
+      insts.erase(insts.begin() + i);
+      func->UntrackInst(inst);
+      inst->parent = nullptr;
+      return taken;
+    }
+  }
+  return nullptr;
+}
+
+inline void BasicBlock::Erase(Instruction *inst) { Take(inst); }
+
+inline void BasicBlock::SplitAt(size_t index, BasicBlock *dest) {
+  for (size_t i = index; i < insts.size(); ++i) {
+    insts[i]->parent = dest;
+    dest->insts.push_back(std::move(insts[i]));
+  }
+  insts.resize(index);
+}
+
+inline void BasicBlock::Splice(BasicBlock *from) {
+  for (auto &inst : from->insts) {
+    inst->parent = this;
+    insts.push_back(std::move(inst));
+  }
+  from->insts.clear();
+}
+
+template <typename Pred> bool BasicBlock::EraseIf(Pred &&pred) {
+  size_t kept = 0;
+  for (size_t i = 0; i < insts.size(); ++i) {
+    if (pred(insts[i].get())) {
+      func->UntrackInst(insts[i].get());
+      continue;
+    }
+    insts[kept++] = std::move(insts[i]);
+  }
+  bool erased = kept != insts.size();
+  insts.resize(kept);
+  return erased;
+}
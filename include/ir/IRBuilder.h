@@ -21,6 +21,9 @@ public:
         std::make_unique<Instruction>(op, std::forward<T>(args)...));
   }
 
+  Value CreateParam(const std::string &type, const std::string &param_name);
+  Value CreateCall(Function *callee, const std::vector<Value> &args);
+
   Value CreateAlloca(const std::string &type, const std::string &var_name = "");
   Value CreateLoad(const Value &addr);
   void CreateStore(const Value &value, const Value &addr);
@@ -9,6 +9,7 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 class IRGenVisitor : public ASTVisitor {
 public:
@@ -16,8 +17,10 @@ public:
 
   // 获取 IR 模块
   const IRModule &GetModule() const { return *module_; }
+  IRModule &GetModule() { return *module_; }
 
   void Visit(CompUnitAST &node) override;
+  void Visit(FuncFParamAST &node) override;
   void Visit(FuncDefAST &node) override;
   void Visit(BlockAST &node) override;
   void Visit(ConstDeclAST &node) override;
@@ -31,6 +34,7 @@ public:
   void Visit(ReturnStmtAST &node) override;
   void Visit(LValAST &node) override;
   void Visit(NumberAST &node) override;
+  void Visit(CallExpAST &node) override;
   void Visit(UnaryExpAST &node) override;
   void Visit(BinaryExpAST &node) override;
 
@@ -39,6 +43,10 @@ private:
   std::unique_ptr<IRBuilder> builder_;
   std::unique_ptr<SymbolTable> symtab_;
 
+  // 表达式子树的寄存器需求（Ershov 数）缓存
+  std::unordered_map<const BaseAST *, int> reg_need_;
+
+  void DeclareLibFunctions_();
   void VisitCompUnit_(const CompUnitAST *ast);
   void VisitFuncDef_(const FuncDefAST *ast);
   void VisitBlock_(const BlockAST *ast);
@@ -55,9 +63,13 @@ private:
   Value Eval(BaseAST *ast);
   Value EvalLVal(LValAST *ast);
   Value EvalNumber(NumberAST *ast);
+  Value EvalCallExp(CallExpAST *ast);
   Value EvalUnaryExp(UnaryExpAST *ast);
   Value EvalBinaryExp(BinaryExpAST *ast);
 
   Value EvalLogicalAnd(BinaryExpAST *ast);
   Value EvalLogicalOr(BinaryExpAST *ast);
+
+  int RegisterNeed(BaseAST *ast);
+  bool IsPure(BaseAST *ast);
 };
@@ -5,24 +5,38 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 class IRModule {
 private:
-  std::unordered_map<std::string, std::unique_ptr<Function>> funcs_;
+  // 按创建顺序保存函数，输出的 IR 与源程序中的定义顺序一致
+  std::vector<std::unique_ptr<Function>> funcs_;
+  std::unordered_map<std::string, Function *> func_index_;
 
 public:
   // 创建并存储函数，返回裸指针供后续使用
   Function *CreateFunction(const std::string &name,
                            const std::string &ret_type) {
-    auto func = std::make_unique<Function>(name, ret_type);
-    Function *ptr = func.get();
-    funcs_[name] = std::move(func);
+    funcs_.push_back(std::make_unique<Function>(name, ret_type));
+    Function *ptr = funcs_.back().get();
+    func_index_[name] = ptr;
     return ptr;
   }
 
   Function *GetFunction(const std::string &func_name) {
-    auto it = funcs_.find(func_name);
-    return it != funcs_.end() ? it->second.get() : nullptr;
+    auto it = func_index_.find(func_name);
+    return it != func_index_.end() ? it->second : nullptr;
+  }
+
+  // 删除不再被调用的函数
+  void RemoveFunction(Function *func) {
+    func_index_.erase(func->name);
+    for (auto it = funcs_.begin(); it != funcs_.end(); ++it) {
+      if (it->get() == func) {
+        funcs_.erase(it);
+        break;
+      }
+    }
   }
 
   // 提供访问所有函数的接口
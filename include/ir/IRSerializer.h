@@ -8,13 +8,33 @@
 
 namespace IRSerializer {
 
+// koopa_raw_program_t 只在生成它的 builder 存活期间有效，
+// 由本类持有 builder，析构时一并释放
+class RawProgram {
+public:
+  explicit RawProgram(const std::string &ir);
+  ~RawProgram();
+
+  RawProgram(const RawProgram &) = delete;
+  RawProgram &operator=(const RawProgram &) = delete;
+
+  const koopa_raw_program_t &Get() const { return raw_; }
+
+private:
+  koopa_raw_program_builder_t builder_;
+  koopa_raw_program_t raw_;
+};
+
 // 从 IRModule 生成 Koopa IR 文本
 std::string ToIR(const IRModule &module);
 
+// 单条指令的 IR 文本（不含缩进），用于诊断输出
+std::string ToIR(const Instruction &inst);
+
 // 从 IR 文本生成 koopa_raw_program_t
-koopa_raw_program_t ToProgram(const std::string &ir);
+RawProgram ToProgram(const std::string &ir);
 
 // 从 IRModule 直接生成 koopa_raw_program_t
-koopa_raw_program_t ToProgram(const IRModule &module);
+RawProgram ToProgram(const IRModule &module);
 
 } // namespace IRSerializer
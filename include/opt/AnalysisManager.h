@@ -0,0 +1,35 @@
+#pragma once
+
+#include "ir/IR.h"
+#include "opt/CFG.h"
+#include "opt/Dominators.h"
+#include "opt/LoopInfo.h"
+
+#include <memory>
+#include <unordered_map>
+
+/*
+ * 按函数缓存 CFG、支配树、支配边界与循环信息。
+ * 分析在第一次请求时计算；优化遍报告修改了 CFG 后才会失效
+ */
+class AnalysisManager {
+public:
+  const CFG &GetCFG(Function &func);
+  const DominatorTree &GetDomTree(Function &func);
+  const DominanceFrontier &GetDomFrontier(Function &func);
+  const LoopInfo &GetLoopInfo(Function &func);
+
+  // 函数的 CFG 被修改后丢弃全部缓存
+  void Invalidate(Function &func) { cache_.erase(&func); }
+  void InvalidateAll() { cache_.clear(); }
+
+private:
+  struct Cache {
+    std::unique_ptr<CFG> cfg;
+    std::unique_ptr<DominatorTree> dom_tree;
+    std::unique_ptr<DominanceFrontier> dom_frontier;
+    std::unique_ptr<LoopInfo> loop_info;
+  };
+
+  std::unordered_map<Function *, Cache> cache_;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "ir/IR.h"
+
+#include <unordered_map>
+#include <vector>
+
+/*
+ * 控制流图：由各基本块终结指令中的跳转目标得到前驱/后继，
+ * 并给出从入口可达的基本块的逆后序
+ */
+class CFG {
+public:
+  explicit CFG(const Function &func);
+
+  BasicBlock *Entry() const { return entry_; }
+
+  const std::vector<BasicBlock *> &Preds(BasicBlock *bb) const;
+  const std::vector<BasicBlock *> &Succs(BasicBlock *bb) const;
+
+  // 逆后序，只包含从入口可达的基本块
+  const std::vector<BasicBlock *> &ReversePostOrder() const { return rpo_; }
+
+  bool IsReachable(BasicBlock *bb) const { return rpo_index_.count(bb); }
+
+  // 基本块在逆后序中的序号
+  size_t RPOIndex(BasicBlock *bb) const { return rpo_index_.at(bb); }
+
+private:
+  BasicBlock *entry_ = nullptr;
+  std::unordered_map<BasicBlock *, std::vector<BasicBlock *>> preds_;
+  std::unordered_map<BasicBlock *, std::vector<BasicBlock *>> succs_;
+  std::vector<BasicBlock *> rpo_;
+  std::unordered_map<BasicBlock *, size_t> rpo_index_;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "ir/IR.h"
+#include "opt/CFG.h"
+#include "opt/Pass.h"
+
+/*
+ * 代码下沉：
+ * 纯计算（运算与 load）的结果只在某个后继块中使用，且该后继块只有
+ * 当前块一个前驱时，把计算移到后继块开头，不经过该后继的路径不再执行它。
+ * load 之后同一块中没有写入同一地址的 store 时才能下沉
+ */
+class CodeSinkingPass : public FunctionPass {
+public:
+  const char *Name() const override { return "sink"; }
+
+  bool Run(Function &func, AnalysisManager &am) override;
+  bool PreservesCFG() const override { return true; }
+
+private:
+  // inst 可以下沉到的后继块，不能下沉时返回 nullptr
+  BasicBlock *SinkTarget(const Function &func, Instruction *inst,
+                         const CFG &cfg) const;
+};
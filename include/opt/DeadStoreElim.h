@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ir/IR.h"
+#include "opt/CFG.h"
+#include "opt/Pass.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * 死存储消除：
+ * 在 CFG 上对函数内 alloc 出的局部变量做逆向的内存活跃性分析，
+ * 删除写入后在任何路径上都不会再被读取（被覆盖或函数返回）的 store，
+ * 例如未初始化变量的 store 0、紧接着被覆盖的赋值；
+ * 之后删除只被写入、从未被读取的 alloc 及其全部 store，
+ * 只为这些 store 计算值的指令随之删除
+ */
+class DeadStoreElimPass : public FunctionPass {
+public:
+  const char *Name() const override { return "dse"; }
+
+  bool Run(Function &func, AnalysisManager &am) override;
+  bool PreservesCFG() const override { return true; }
+
+private:
+  // 以局部变量在 slots_ 中的序号为位的集合
+  using SlotSet = std::vector<bool>;
+
+  bool RemoveDeadStores(const CFG &cfg);
+  bool RemoveUnreadAllocas(Function &func);
+
+  // 地址对应的局部变量序号，非本函数的 alloc 返回 -1
+  int SlotOf(const Value &addr) const;
+  // 自 live_out 起逆向扫描 bb，dead 非空时收集其中的死存储
+  SlotSet Transfer(BasicBlock *bb, SlotSet live,
+                   std::vector<Instruction *> *dead) const;
+
+  std::unordered_map<std::string, int> slots_;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ir/IR.h"
+#include "opt/CFG.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * 支配树，使用 Cooper-Harvey-Kennedy 迭代算法计算直接支配者。
+ * 支配关系查询借助支配树上的 DFS 进入/离开序号，为 O(1)
+ */
+class DominatorTree {
+public:
+  explicit DominatorTree(const CFG &cfg);
+
+  // 入口块与不可达块返回 nullptr
+  BasicBlock *IDom(BasicBlock *bb) const;
+
+  const std::vector<BasicBlock *> &Children(BasicBlock *bb) const;
+
+  // a 支配 b（包括 a == b）
+  bool Dominates(BasicBlock *a, BasicBlock *b) const;
+
+private:
+  std::unordered_map<BasicBlock *, BasicBlock *> idom_;
+  std::unordered_map<BasicBlock *, std::vector<BasicBlock *>> children_;
+  std::unordered_map<BasicBlock *, std::pair<size_t, size_t>> dfs_range_;
+};
+
+// 支配边界 DF(b)：b 支配其某个前驱但不严格支配的块
+class DominanceFrontier {
+public:
+  DominanceFrontier(const CFG &cfg, const DominatorTree &dom_tree);
+
+  const std::unordered_set<BasicBlock *> &Get(BasicBlock *bb) const;
+
+private:
+  std::unordered_map<BasicBlock *, std::unordered_set<BasicBlock *>>
+      frontier_;
+};
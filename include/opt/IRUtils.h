@@ -0,0 +1,37 @@
+#pragma once
+
+#include "ir/IR.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace IRUtils {
+
+// 没有副作用、结果未被使用时可以直接删除的指令
+bool IsPure(const Instruction &inst);
+
+// 删除结果未被使用的纯指令（连带因此变为无用的操作数定义），返回是否有指令被删除
+bool RemoveDeadInsts(Function &func);
+
+// 克隆基本块时旧值名/旧基本块到副本的映射
+struct CloneMap {
+  std::unordered_map<std::string, Value> values;
+  std::unordered_map<BasicBlock *, BasicBlock *> blocks;
+};
+
+/*
+ * 在 func 末尾按序创建 blocks 的副本，副本命名为 <label_prefix><原名>，
+ * 块参数与指令结果重新命名为 %N_<name> / @N_<name>（N 在函数内唯一）。
+ * map.values 中预先填入的映射同样生效；跳转到 blocks 之内的目标改为副本，
+ * 其余目标不变。alloc 不复制而是移到入口块开头，副本与原块共用局部变量
+ */
+std::vector<BasicBlock *> CloneBlocks(Function &func,
+                                      const std::vector<BasicBlock *> &blocks,
+                                      const std::string &label_prefix,
+                                      CloneMap &map);
+
+// 删除从入口不可达的基本块，返回是否有块被删除
+bool RemoveUnreachableBlocks(Function &func);
+
+} // namespace IRUtils
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "ir/IR.h"
+#include "opt/CFG.h"
+#include "opt/KnownBits.h"
+#include "opt/Pass.h"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+ * If 转换：
+ * 将只包含无副作用运算与 store 的小型菱形/三角形分支
+ *   br c, %then, %else;  %then: ...; store a, @x   %else: ...; store b, @x
+ * 改写为无分支的选择序列
+ *   mask = 0 - c;  x = b + ((a - b) & mask)
+ * 比较的操作数恰好是两侧的值时直接选择比较操作数 (min/max)，
+ * x < 0 ? -x : x 则生成 (x ^ (x >> 31)) - (x >> 31) (abs)
+ */
+class IfConversionPass : public FunctionPass {
+public:
+  // max_insts: 两侧基本块中允许被投机执行的指令总数上限
+  explicit IfConversionPass(size_t max_insts = 8) : max_insts_(max_insts) {}
+
+  const char *Name() const override { return "ifcvt"; }
+
+  bool Run(Function &func, AnalysisManager &am) override;
+
+private:
+  struct Side {
+    BasicBlock *bb = nullptr; // 三角形中空的一侧为 nullptr
+    std::vector<Instruction *> body;
+    std::vector<std::pair<Value, Value>> stores; // (addr, value)
+  };
+
+  bool TryConvert(Function &func, BasicBlock *head);
+  bool AnalyzeSide(BasicBlock *bb, BasicBlock *join, Side &side,
+                   size_t &size) const;
+  bool MergeIntoPredecessor(Function &func, BasicBlock *head);
+
+  Value EmitSelect(const Value &cond, const Value &tv, const Value &fv);
+  bool TryEmitAbs(const Value &cond, const Value &tv, const Value &fv,
+                  Value &result);
+  bool Equivalent(const Value &lhs, const Value &rhs) const;
+  const Instruction *GetDef(const Value &value) const;
+  Value Emit(Opcode op, const Value &lhs, const Value &rhs);
+
+  size_t max_insts_;
+
+  Function *func_ = nullptr;
+  const CFG *cfg_ = nullptr;
+  // 转换中的局部信息
+  std::unordered_map<std::string, std::string> load_src_; // 寄存器 -> 地址
+  const Instruction *cond_def_ = nullptr;
+  std::optional<Value> mask_;
+  std::vector<std::unique_ptr<Instruction>> emitted_;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "ir/IR.h"
+#include "ir/IRModule.h"
+#include "opt/Pass.h"
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * 函数内联：
+ * 按调用图的强连通分量自底向上处理，被调函数先完成内联再参与代价估计。
+ * 内联时在调用点拆分基本块，克隆被调函数的基本块并把形参替换为实参，
+ * ret 改写为跳转到携带返回值块参数的后继块
+ *   %res = call @f(%a)   =>   jump %inlN_entry ... jump %inlN_cont(%v)
+ * 代价模型：被调函数的指令数不超过阈值时内联；只有一个调用点的函数
+ * 内联后原函数即可删除，阈值放宽为 4 倍。同一强连通分量内的调用（递归）不内联
+ */
+class InlinerPass : public ModulePass {
+public:
+  explicit InlinerPass(size_t threshold = 30) : threshold_(threshold) {}
+
+  const char *Name() const override { return "inline"; }
+
+  bool Run(IRModule &module, AnalysisManager &am) override;
+
+private:
+  void BuildCallGraph(const IRModule &module);
+  void ComputeSCCs(const IRModule &module);
+  void VisitSCC(Function *func);
+
+  size_t InlineCost(const Function &callee) const;
+  bool ShouldInline(const Function &caller, const Function &callee) const;
+  void InlineCall(Function &caller, Instruction *call);
+  bool RemoveDeadFunctions(IRModule &module);
+
+  size_t threshold_;
+
+  // 调用图：函数 -> 直接调用的函数，以及每个函数在模块中的调用点数
+  std::unordered_map<Function *, std::unordered_set<Function *>> callees_;
+  std::unordered_map<const Function *, size_t> call_sites_;
+  std::unordered_map<const Function *, size_t> size_;
+
+  // Tarjan 算法的状态；scc_order_ 中被调者所在的分量排在调用者之前
+  std::unordered_map<const Function *, int> scc_id_;
+  std::vector<std::vector<Function *>> scc_order_;
+  std::unordered_map<Function *, int> dfs_index_;
+  std::unordered_map<Function *, int> low_link_;
+  std::vector<Function *> scc_stack_;
+  std::unordered_set<Function *> on_stack_;
+};
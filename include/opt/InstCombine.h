@@ -0,0 +1,34 @@
+#pragma once
+
+#include "ir/IR.h"
+#include "opt/KnownBits.h"
+#include "opt/Pass.h"
+
+#include <optional>
+
+/*
+ * 指令合并：
+ * 基于代数恒等式与已知位分析化简单条指令，例如
+ *   x + 0, x * 1, x - x, 0 - (0 - x)
+ *   !!x 产生的 eq (eq x, 0), 0  =>  ne x, 0
+ *   对已经是 0/1 的比较结果再做 ne v, 0
+ * 化简后结果未被使用的指令一并删除
+ */
+class InstCombinePass : public FunctionPass {
+public:
+  const char *Name() const override { return "instcombine"; }
+
+  bool Run(Function &func, AnalysisManager &am) override;
+  bool PreservesCFG() const override { return true; }
+
+private:
+  bool RunOnce(Function &func);
+
+  std::optional<Value> Simplify(Instruction &inst,
+                                const KnownBitsAnalysis &known);
+  bool SimplifyBranch(Instruction &inst);
+
+  const Instruction *GetDef(const Value &value) const;
+
+  Function *func_ = nullptr;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "ir/IR.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// 一个 32 位值中已知为 0 / 已知为 1 的位
+struct KnownBits {
+  uint32_t zero = 0;
+  uint32_t one = 0;
+
+  static KnownBits Constant(int32_t imm) {
+    uint32_t bits = static_cast<uint32_t>(imm);
+    return {~bits, bits};
+  }
+
+  // 比较运算的结果只可能是 0 或 1
+  static KnownBits Boolean() { return {~1u, 0}; }
+
+  bool IsConstant() const { return (zero | one) == ~0u; }
+  bool IsBoolean() const { return (zero & ~1u) == ~1u; }
+  bool IsNonZero() const { return one != 0; }
+
+  // 控制流汇合处取两者共同已知的位
+  KnownBits Meet(const KnownBits &other) const {
+    return {zero & other.zero, one & other.one};
+  }
+
+  bool operator==(const KnownBits &other) const {
+    return zero == other.zero && one == other.one;
+  }
+  bool operator!=(const KnownBits &other) const { return !(*this == other); }
+};
+
+/*
+ * 对函数内所有寄存器（指令结果与块参数）做已知位分析。
+ * 块参数取所有前驱传入实参的交汇，循环中迭代到不动点。
+ * 形参、call 与 load 的结果以及访问时尚未计算的值都按未知处理，
+ * 因此回边传入的值只会使结果更保守
+ */
+class KnownBitsAnalysis {
+public:
+  explicit KnownBitsAnalysis(const Function &func);
+
+  KnownBits Get(const Value &value) const;
+
+  bool IsBoolean(const Value &value) const { return Get(value).IsBoolean(); }
+
+private:
+  bool Lookup(const Value &value, KnownBits &bits) const;
+  KnownBits Transfer(const Instruction &inst) const;
+
+  // 只包含已经到达过的值；Get 把其余的值视为未知
+  std::unordered_map<std::string, KnownBits> known_;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "ir/IR.h"
+#include "opt/CFG.h"
+#include "opt/Dominators.h"
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// 自然循环：由回边 latch -> header（header 支配 latch）确定
+struct Loop {
+  BasicBlock *header = nullptr;
+  std::vector<BasicBlock *> blocks; // 按逆后序排列，header 在最前
+  std::unordered_set<BasicBlock *> block_set;
+  std::vector<BasicBlock *> latches;
+
+  Loop *parent = nullptr;
+  std::vector<Loop *> sub_loops;
+
+  bool Contains(BasicBlock *bb) const { return block_set.count(bb); }
+
+  // 循环嵌套深度，最外层为 1
+  int Depth() const {
+    int depth = 1;
+    for (Loop *loop = parent; loop; loop = loop->parent) {
+      ++depth;
+    }
+    return depth;
+  }
+
+  // 循环外、从循环内跳转到达的块
+  std::vector<BasicBlock *> ExitBlocks(const CFG &cfg) const;
+};
+
+// 函数内的循环嵌套森林
+class LoopInfo {
+public:
+  LoopInfo(const CFG &cfg, const DominatorTree &dom_tree);
+
+  const std::vector<Loop *> &TopLevelLoops() const { return top_level_; }
+
+  // 所有循环，内层循环排在外层循环之前
+  std::vector<Loop *> LoopsInnermostFirst() const;
+
+  // 包含 bb 的最内层循环，不在循环中时返回 nullptr
+  Loop *LoopFor(BasicBlock *bb) const;
+
+  int LoopDepth(BasicBlock *bb) const {
+    Loop *loop = LoopFor(bb);
+    return loop ? loop->Depth() : 0;
+  }
+
+private:
+  std::vector<std::unique_ptr<Loop>> loops_;
+  std::vector<Loop *> top_level_;
+  std::unordered_map<BasicBlock *, Loop *> innermost_;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "ir/IR.h"
+#include "opt/CFG.h"
+#include "opt/LoopInfo.h"
+#include "opt/Pass.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_set>
+
+/*
+ * 循环展开：
+ * 处理 while 生成的最内层计数循环——只从循环头退出、只有一个回边块，
+ * 归纳变量 @i 只在回边块中更新一次 (store @i + step, @i，step 为常量)，
+ * 循环头比较 @i 与循环不变量决定是否继续。
+ * 初值与界都是常量且展开后的代码量不超过预算时完全展开；
+ * 否则按 factor 部分展开：新的守卫块在剩余迭代不少于 factor 次时进入
+ * 展开后的循环体，不足时进入原循环执行余下的迭代。
+ * 循环体越大，实际使用的展开倍数越小
+ */
+class LoopUnrollPass : public FunctionPass {
+public:
+  // factor: 部分展开的最大倍数，不大于 1 时只做完全展开
+  explicit LoopUnrollPass(size_t factor = 4) : factor_(factor) {}
+
+  const char *Name() const override { return "unroll"; }
+
+  bool Run(Function &func, AnalysisManager &am) override;
+
+private:
+  struct CountedLoop {
+    Loop *loop = nullptr;
+    BasicBlock *preheader = nullptr;
+    BasicBlock *latch = nullptr;
+    BasicBlock *body = nullptr; // 条件成立时进入的循环内后继
+    BasicBlock *exit = nullptr; // 条件不成立时跳出的后继
+    std::string iv;             // 归纳变量的地址
+    int32_t step = 0;
+    Opcode cmp = Opcode::Lt; // 规范化为 iv cmp bound
+    Value bound;             // 立即数或在循环外定义的值
+    std::string bound_addr;  // 界由循环头中的 load 读出时为其地址
+    std::optional<int32_t> init; // 进入循环时归纳变量的常量初值
+    size_t size = 0;             // 循环内的指令数
+  };
+
+  bool Analyze(Function &func, Loop *loop, const CFG &cfg,
+               CountedLoop &info) const;
+  bool FindStep(Function &func, const CountedLoop &info, Instruction *store,
+                int32_t &step) const;
+  // 迭代次数不超过 max_trips 时返回迭代次数
+  std::optional<size_t> TripCount(const CountedLoop &info,
+                                  size_t max_trips) const;
+
+  // 按代码量预算选择完全展开或展开倍数，循环未被修改时返回 false
+  bool Unroll(Function &func, const CountedLoop &info);
+  void FullyUnroll(Function &func, const CountedLoop &info, size_t trips);
+  bool PartiallyUnroll(Function &func, const CountedLoop &info,
+                       size_t factor);
+  /*
+   * 复制 copies 份循环，各份循环头的分支改为直接进入循环体，
+   * 第 k 份的回边接到第 k+1 份的循环头，最后一份跳到 next；
+   * reuse_original 为真时第 0 份使用原循环本身。返回第 0 份的循环头
+   */
+  BasicBlock *Replicate(Function &func, const CountedLoop &info,
+                        size_t copies, bool reuse_original, BasicBlock *next,
+                        const std::string &label_prefix);
+
+  size_t factor_;
+  // 已处理过的循环头，展开后留下的余数循环不再重复展开
+  std::unordered_set<std::string> visited_;
+};
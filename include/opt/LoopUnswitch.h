@@ -0,0 +1,50 @@
+#pragma once
+
+#include "ir/IR.h"
+#include "opt/LoopInfo.h"
+#include "opt/Pass.h"
+
+#include <cstddef>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * 循环外提条件（unswitching）：
+ * 循环内的 br 条件只依赖循环外的值与循环内不会被写入的变量时，
+ * 在循环前的新块中计算一次条件并选择循环的两个版本之一：
+ * 原循环中该分支固定走 true 一侧，克隆出的循环固定走 false 一侧，
+ * 每次迭代不再重复求值与跳转。
+ * 优先外提到最外层的循环；每个函数因外提而复制的指令数不超过 threshold
+ */
+class LoopUnswitchPass : public FunctionPass {
+public:
+  explicit LoopUnswitchPass(size_t threshold = 128) : threshold_(threshold) {}
+
+  const char *Name() const override { return "unswitch"; }
+
+  bool Run(Function &func, AnalysisManager &am) override;
+
+private:
+  // 循环中可以外提的分支及其条件的计算过程
+  struct Candidate {
+    Instruction *br = nullptr;
+    std::vector<Instruction *> cond_insts; // 按依赖顺序排列
+    size_t loop_size = 0;                  // 需要复制的指令数
+  };
+
+  bool FindCandidate(Function &func, Loop *loop, Candidate &candidate);
+  // 判断 value 在循环内不变，并收集循环内计算它的指令
+  bool CollectInvariant(Function &func, const Value &value,
+                        std::vector<Instruction *> &insts) const;
+  void Unswitch(Function &func, Loop *loop, BasicBlock *preheader,
+                const Candidate &candidate);
+
+  size_t threshold_;
+  size_t budget_ = 0;
+
+  // 当前循环的信息，由 FindCandidate 设置
+  Loop *loop_ = nullptr;
+  std::unordered_set<std::string> stored_;       // 循环内被写入的地址
+  std::unordered_set<std::string> local_values_; // 循环内的块参数与 alloc
+};
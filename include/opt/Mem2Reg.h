@@ -0,0 +1,45 @@
+#pragma once
+
+#include "ir/IR.h"
+#include "opt/CFG.h"
+#include "opt/Dominators.h"
+#include "opt/Pass.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * 把局部变量提升为寄存器值：
+ * alloc 出的变量只被 load/store 直接访问（SysY 中不会取地址），
+ * 每个 load 改为读取此处变量的当前值，store 只更新当前值后删除。
+ * 多个定义汇合处按迭代支配边界添加块参数，前驱的跳转传入各自的当前值；
+ * 只在变量活跃的汇合处添加（剪枝 SSA）。未初始化就读取的变量取 0。
+ * 放在依赖内存形式的优化之后，使寄存器分配能把局部变量放在寄存器中
+ */
+class Mem2RegPass : public FunctionPass {
+public:
+  const char *Name() const override { return "mem2reg"; }
+
+  bool Run(Function &func, AnalysisManager &am) override;
+
+private:
+  using VarSet = std::vector<bool>;
+
+  void CollectPromotable(Function &func);
+  void ComputeLiveIn(const CFG &cfg);
+  void PlaceParams(const CFG &cfg, const DominanceFrontier &frontier);
+  void Rename(Function &func, const DominatorTree &dom_tree, BasicBlock *bb,
+              std::vector<std::vector<Value>> &stacks);
+  void PassArgs(const CFG &cfg);
+
+  int VarOf(const Value &addr) const;
+
+  std::vector<Instruction *> allocs_;
+  std::unordered_map<std::string, int> vars_;
+  std::unordered_map<BasicBlock *, VarSet> live_in_;
+  // 块上新添加的参数依次对应的变量
+  std::unordered_map<BasicBlock *, std::vector<int>> params_;
+  // 块末尾各变量的当前值
+  std::unordered_map<BasicBlock *, std::vector<Value>> out_values_;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "ir/IR.h"
+#include "opt/CFG.h"
+#include "opt/Pass.h"
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+ * 部分冗余消除（lazy code motion）：
+ * 表达式按叶子（变量的 load、立即数、形参）在词法上判断等价，
+ *   load @a; load @b; mul  记为  mul(@a, @b)
+ * 写入任一叶子变量的 store 使其失效，调用不会修改局部变量。
+ * 先在块内复用同一表达式先前的计算结果，再在 CFG 上求可用性与预期性，
+ * 按 LCM 把计算插入到尽量晚的边上，使部分冗余变为完全冗余后删除。
+ * 表达式的值经新的局部变量 @pre_N 在块间传递：保留的计算之后写入，
+ * 被删除的计算改为读取，多余的写入与变量由死存储消除删除。
+ * 除法与取模不参与，避免在原本不执行的路径上引入除零
+ */
+class PartialRedundancyElimPass : public FunctionPass {
+public:
+  const char *Name() const override { return "pre"; }
+
+  bool Run(Function &func, AnalysisManager &am) override;
+
+private:
+  // 以表达式序号为位的集合
+  using ExprSet = std::vector<bool>;
+
+  // 叶子的键为 @var / #imm / 形参名，运算的键由操作码与操作数的键组成
+  struct Expr {
+    std::string key;
+    Opcode op;
+    std::string lhs;
+    std::string rhs;
+    std::vector<std::string> vars; // 叶子变量，写入任一个都使表达式失效
+  };
+
+  // 表达式在一个基本块中的计算
+  struct Local {
+    Instruction *upward = nullptr;   // 块内第一次失效之前的计算
+    Instruction *downward = nullptr; // 块内最后一次失效之后的计算
+  };
+
+  struct BlockInfo {
+    std::unordered_map<int, Local> locals;
+    std::vector<std::string> stored; // 块内写入的变量
+    ExprSet antloc, comp, transp;
+    ExprSet av_out, ant_in, ant_out, later_in;
+  };
+
+  using Edge = std::pair<BasicBlock *, BasicBlock *>;
+
+  // 扫描基本块：做块内复用，并记录表达式的局部计算与失效
+  bool ScanBlock(Function &func, BasicBlock *bb);
+  int InternExpr(Opcode op, const std::string &lhs, const std::string &rhs,
+                 const std::vector<std::string> &vars);
+  void ComputeLocalSets(const CFG &cfg);
+  void ComputeGlobalSets(const CFG &cfg);
+  bool Transform(Function &func, const CFG &cfg);
+
+  // 在 bb 的 index 处重新计算键为 key 的值，index 随插入的指令后移
+  Value Materialize(Function &func, const std::string &key, BasicBlock *bb,
+                    size_t &index);
+  bool CanInsertOn(const CFG &cfg, const Edge &edge) const;
+  // 边上插入计算的位置，必要时拆分关键边
+  BasicBlock *InsertionPoint(Function &func, const CFG &cfg, const Edge &edge,
+                             size_t &index);
+
+  std::vector<Expr> exprs_;
+  std::unordered_map<std::string, int> expr_ids_;
+  std::unordered_map<std::string, std::vector<int>> var_exprs_;
+  std::unordered_map<BasicBlock *, BlockInfo> blocks_;
+  // 需要插入计算的边，按逆后序排列
+  std::vector<std::pair<Edge, ExprSet>> inserts_;
+  std::map<Edge, BasicBlock *> split_;
+};
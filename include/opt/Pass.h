@@ -0,0 +1,28 @@
+#pragma once
+
+#include "ir/IR.h"
+#include "ir/IRModule.h"
+#include "opt/AnalysisManager.h"
+
+// 以函数为单位运行的优化遍，返回 IR 是否被修改
+class FunctionPass {
+public:
+  virtual ~FunctionPass() = default;
+
+  virtual const char *Name() const = 0;
+  virtual bool Run(Function &func, AnalysisManager &am) = 0;
+
+  // 只改写指令、不增删基本块与跳转边的遍返回 true，缓存的分析保持有效
+  virtual bool PreservesCFG() const { return false; }
+};
+
+// 需要同时观察多个函数的优化遍（如内联）
+class ModulePass {
+public:
+  virtual ~ModulePass() = default;
+
+  virtual const char *Name() const = 0;
+  virtual bool Run(IRModule &module, AnalysisManager &am) = 0;
+
+  virtual bool PreservesCFG() const { return false; }
+};
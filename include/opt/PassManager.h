@@ -0,0 +1,82 @@
+#pragma once
+
+#include "ir/IRModule.h"
+#include "opt/AnalysisManager.h"
+#include "opt/Pass.h"
+
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct PassOptions {
+  int opt_level = 1;               // -O0 / -O1 / -O2
+  std::string passes;              // -passes=a,b,c，非空时覆盖 -O 的流水线
+  bool time_passes = false;        // -time-passes
+  size_t ifcvt_threshold = 8;      // -ifcvt-threshold=N
+  size_t inline_threshold = 30;    // -inline-threshold=N
+  size_t unroll_factor = 4;        // -unroll-factor=N
+  size_t unswitch_threshold = 128; // -unswitch-threshold=N
+  bool pass_remarks = false;       // -pass-remarks
+  // -dump-ir=after:<pass>，在这些遍之后转储 IR，all 表示每个遍之后
+  std::vector<std::string> dump_ir_after;
+};
+
+/*
+ * 按顺序运行函数级与模块级优化遍。
+ * 开启 -time-passes 时统计每个遍的耗时与 IR 指令数的变化，结束后输出到 diag。
+ * 优化遍的提示（-pass-remarks）与流水线的错误也写到 diag。
+ * dump 非空时按 -dump-ir=after: 在指定的遍之后把 IR 写到 dump
+ */
+class PassManager {
+public:
+  explicit PassManager(std::ostream &diag = std::cerr,
+                       std::ostream *dump = nullptr)
+      : diag_(diag), dump_(dump) {}
+  ~PassManager() = default;
+
+  void AddPass(std::unique_ptr<FunctionPass> pass);
+  void AddPass(std::unique_ptr<ModulePass> pass);
+
+  // 按名称添加优化遍，名称未知时返回 false
+  bool AddPass(const std::string &name, const PassOptions &options);
+
+  // 根据 -O 等级或 -passes= 构造流水线，-passes= 中含未知名称时返回 false
+  bool BuildPipeline(const PassOptions &options);
+
+  void Run(IRModule &module);
+
+  void PrintTimingReport() const;
+
+private:
+  struct Entry {
+    std::unique_ptr<FunctionPass> func_pass;
+    std::unique_ptr<ModulePass> module_pass;
+
+    const char *Name() const {
+      return func_pass ? func_pass->Name() : module_pass->Name();
+    }
+    bool PreservesCFG() const {
+      return func_pass ? func_pass->PreservesCFG()
+                       : module_pass->PreservesCFG();
+    }
+  };
+
+  struct Timing {
+    std::string name;
+    double wall_ms = 0;
+    long inst_delta = 0;
+  };
+
+  bool ShouldDumpAfter(const std::string &name) const;
+
+  std::ostream &diag_;
+  std::ostream *dump_;
+  std::vector<std::string> dump_ir_after_;
+  std::vector<Entry> passes_;
+  AnalysisManager am_;
+  bool time_passes_ = false;
+  std::vector<Timing> timings_;
+};
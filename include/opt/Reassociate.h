@@ -0,0 +1,48 @@
+#pragma once
+
+#include "ir/IR.h"
+#include "opt/Pass.h"
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * 重结合：
+ * 将同一基本块内由左递归文法产生的线性加法/乘法链 ((((a+b)+c)+d)+e)
+ * 展开为操作数列表，合并其中的常量 (x + 1 + 2 => x + 3)，
+ * 再按平衡树重建，缩短依赖链的深度
+ */
+class ReassociatePass : public FunctionPass {
+public:
+  const char *Name() const override { return "reassociate"; }
+
+  bool Run(Function &func, AnalysisManager &am) override;
+  bool PreservesCFG() const override { return true; }
+
+private:
+  struct Tree {
+    Instruction *root;
+    std::vector<Value> leaves; // 非常量操作数
+    int64_t constant;          // 常量操作数合并后的结果
+    int num_consts;            // 原链中常量操作数的个数
+    int depth;                 // 原链的深度
+  };
+
+  bool RunOnBlock(BasicBlock *bb);
+
+  void Collect(Instruction *inst, Opcode op, Tree &tree, int depth);
+  bool IsChainNode(const Instruction *inst, Opcode op) const;
+  bool IsInterior(const Instruction *inst) const;
+  bool Profitable(const Tree &tree) const;
+  void Rebuild(const Tree &tree, Opcode op,
+               std::vector<std::unique_ptr<Instruction>> &out);
+
+  Function *func_ = nullptr;
+  // 块内定义：寄存器名 -> 定义它的指令
+  std::unordered_map<std::string, Instruction *> defs_;
+  // 块内只被使用一次的寄存器 -> 唯一的使用者
+  std::unordered_map<std::string, Instruction *> single_user_;
+  std::unordered_set<Instruction *> interior_;
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "ir/IR.h"
+#include "opt/Pass.h"
+
+/*
+ * 尾调用优化：
+ * 先把 call 之后经 store @ret; jump %exit 返回的路径改写为直接返回
+ *   %r = call @f(...); ret %r
+ * 使尾调用在 IR 中显式出现，后端据此把对其它函数的尾调用生成为复用栈帧的 tail；
+ * 再把自递归的尾调用改写为跳回入口之后的循环头，形参变为循环头的块参数，
+ * 递归不再占用栈空间
+ */
+class TailCallElimPass : public FunctionPass {
+public:
+  const char *Name() const override { return "tailcall"; }
+
+  bool Run(Function &func, AnalysisManager &am) override;
+
+private:
+  bool ExposeTailCalls(Function &func);
+  bool EliminateSelfRecursion(Function &func);
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "ir/IR.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 32 位有符号整数的闭区间 [lo, hi]，以 64 位保存，运算时便于判断溢出
+struct ValueRange {
+  int64_t lo = INT32_MIN;
+  int64_t hi = INT32_MAX;
+
+  static ValueRange Full() { return {}; }
+  static ValueRange Constant(int64_t imm) { return {imm, imm}; }
+  // 超出 32 位的区间在运行时会回绕，只能取全集
+  static ValueRange Of(int64_t lo, int64_t hi) {
+    if (lo < INT32_MIN || hi > INT32_MAX) {
+      return Full();
+    }
+    return {lo, hi};
+  }
+
+  bool IsEmpty() const { return lo > hi; }
+  bool IsConstant() const { return lo == hi; }
+  bool Contains(int64_t imm) const { return lo <= imm && imm <= hi; }
+
+  // 控制流汇合处取包含两者的最小区间
+  ValueRange Union(const ValueRange &other) const {
+    return {std::min(lo, other.lo), std::max(hi, other.hi)};
+  }
+  ValueRange Intersect(const ValueRange &other) const {
+    return {std::max(lo, other.lo), std::min(hi, other.hi)};
+  }
+
+  bool operator==(const ValueRange &other) const {
+    return lo == other.lo && hi == other.hi;
+  }
+  bool operator!=(const ValueRange &other) const { return !(*this == other); }
+};
+
+/*
+ * 值域分析：对指令结果与块参数做区间传播。
+ * br 在每条出边上按条件收窄操作数的区间，并记下成立的比较，
+ * 因此被支配的块中重复的检查（如 while (i < n) 体内的 i < n）可以判定。
+ * 只沿可行的边传播，判定为不可行的边不影响其目标块；
+ * 循环中迭代若干轮后仍在扩大的区间直接放宽到 32 位边界，保证收敛
+ */
+class ValueRangeAnalysis {
+public:
+  explicit ValueRangeAnalysis(const Function &func);
+
+  bool IsReachable(const BasicBlock *bb) const { return in_.count(bb); }
+
+  // 指令在所在块中的结果区间，结果恒为常量时返回该常量
+  std::optional<int32_t> GetConstant(const Instruction &inst) const;
+
+  // 基本块的 br 只有一侧可行时返回该侧（true 分支或 false 分支）
+  std::optional<bool> GetBranchDirection(const BasicBlock *bb) const;
+
+private:
+  // 基本块入口处由路径得到的信息：收窄后的区间与成立的比较
+  struct State {
+    std::unordered_map<std::string, ValueRange> ranges;
+    std::set<std::string> facts;
+
+    bool operator==(const State &other) const {
+      return ranges == other.ranges && facts == other.facts;
+    }
+  };
+
+  // 终结指令中的一个跳转目标：所在块与其在 args 中的下标
+  struct Edge {
+    const BasicBlock *from;
+    size_t slot;
+  };
+
+  bool Join(const BasicBlock *bb, State &state) const;
+  void Update(const std::string &name, const ValueRange &range, bool widen);
+
+  ValueRange Lookup(const Value &value, const State &state) const;
+  ValueRange Evaluate(const Instruction &inst, const State &state) const;
+  std::optional<bool> Compare(Opcode op, const Value &lhs, const Value &rhs,
+                              const State &state) const;
+  bool Refine(const Value &cond, bool taken, State &state) const;
+  bool RefineCompare(Opcode op, const Value &lhs, const Value &rhs,
+                     State &state) const;
+  void AddFact(Opcode op, const Value &lhs, const Value &rhs,
+               State &state) const;
+
+  const Function &func_;
+  std::vector<const BasicBlock *> rpo_;
+  std::unordered_map<const BasicBlock *, std::vector<Edge>> incoming_;
+
+  // 值在定义处的区间；没有记录的寄存器（形参、load 与 call 的结果等）为全集
+  std::unordered_map<std::string, ValueRange> ranges_;
+  std::unordered_map<const BasicBlock *, State> in_;
+  // 每条可行出边上的信息，以跳转目标在终结指令 args 中的下标索引
+  std::unordered_map<const BasicBlock *, std::unordered_map<size_t, State>>
+      out_;
+
+  size_t round_ = 0;
+  bool changed_ = false;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "ir/IR.h"
+#include "opt/Pass.h"
+#include "opt/ValueRange.h"
+
+#include <ostream>
+#include <string>
+
+/*
+ * 值域传播：按值域分析把结果恒定的指令（主要是比较）替换为常量，
+ * 只有一侧可行的 br 改为 jump，并删除因此不可达的基本块。
+ * remarks 非空时（-pass-remarks）在其中报告每个被删除的检查
+ */
+class ValueRangePropPass : public FunctionPass {
+public:
+  explicit ValueRangePropPass(std::ostream *remarks = nullptr)
+      : remarks_(remarks) {}
+
+  const char *Name() const override { return "vrp"; }
+
+  bool Run(Function &func, AnalysisManager &am) override;
+
+private:
+  void Remark(const Function &func, const BasicBlock &bb,
+              const std::string &message) const;
+
+  std::ostream *remarks_;
+};
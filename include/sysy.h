@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * libsysy：在进程内把 SysY 源程序编译为 Koopa IR 或 RISC-V 汇编。
+ * 输入与输出都在内存中，不读写文件，也不使用全局的输入输出流；
+ * 不同线程可以同时调用
+ */
+namespace sysy {
+
+enum class Target { Koopa, RiscV };
+
+// 接收输出的回调，每次传入一段输出，按顺序拼接即为完整结果
+using Sink = std::function<void(const char *data, size_t size)>;
+
+struct Result {
+  bool succeeded = false;
+  std::string diagnostics; // 错误信息、-pass-remarks 与 -time-passes 的输出
+};
+
+// args 为与命令行相同的编译选项，如 {"-O2", "-regalloc=graph"}。
+// 结果分段交给 sink；编译失败时 sink 可能已经收到部分输出
+Result Compile(std::string_view source, Target target,
+               const std::vector<std::string> &args, const Sink &sink);
+
+// 结果写入 output，编译失败时 output 为空
+Result Compile(std::string_view source, Target target,
+               const std::vector<std::string> &args, std::string &output);
+
+} // namespace sysy
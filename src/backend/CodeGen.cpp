@@ -1,26 +1,78 @@
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
 
 #include "backend/CodeGen.h"
+#include "backend/Liveness.h"
+#include "backend/MachineCFG.h"
+#include "backend/RegAlloc.h"
 
 #include "koopa.h"
 
+namespace {
+
+// 栈槽与 callee-saved 寄存器只能在栈帧建立之后使用
+bool LocationNeedsFrame(const Location &loc) {
+  return loc.kind == Location::Kind::Stack ||
+         (loc.kind == Location::Kind::Reg && IsCalleeSaved(loc.reg));
+}
+
+} // namespace
+
+/**
+ * 按调用图的后序生成各函数，被调函数的改写集合先于调用者确定；
+ * 每个函数的汇编先写入缓冲区，最后按源程序中的顺序输出
+ */
 void ProgramCodeGen::Emit(const koopa_raw_program_t &program) {
   EmitTextSection();
 
   const koopa_raw_slice_t &funcs = program.funcs;
+  std::vector<koopa_raw_function_t> order;
+  std::unordered_set<koopa_raw_function_t> visited;
+  std::function<void(koopa_raw_function_t)> visit =
+      [&](koopa_raw_function_t func) {
+        // 库函数只有声明，由运行时提供
+        if (func->bbs.len == 0 || !visited.insert(func).second)
+          return;
+        for (size_t i = 0; i < func->bbs.len; ++i) {
+          auto bb = reinterpret_cast<koopa_raw_basic_block_t>(
+              func->bbs.buffer[i]);
+          for (size_t j = 0; j < bb->insts.len; ++j) {
+            auto inst = reinterpret_cast<koopa_raw_value_t>(bb->insts.buffer[j]);
+            if (inst->kind.tag == KOOPA_RVT_CALL)
+              visit(inst->kind.data.call.callee);
+          }
+        }
+        order.push_back(func);
+      };
   for (size_t i = 0; i < funcs.len; ++i) {
-    koopa_raw_function_t func =
-        reinterpret_cast<koopa_raw_function_t>(funcs.buffer[i]);
-    FunctionCodeGen func_gen;
+    visit(reinterpret_cast<koopa_raw_function_t>(funcs.buffer[i]));
+  }
+
+  std::unordered_map<koopa_raw_function_t, std::string> text;
+  for (koopa_raw_function_t func : order) {
+    std::ostringstream out;
+    FunctionCodeGen func_gen(out, regalloc_, clobbers_, mir_);
     func_gen.Emit(func);
+    clobbers_[func] = func_gen.Clobbers();
+    text[func] = out.str();
+  }
+  for (size_t i = 0; i < funcs.len; ++i) {
+    auto it = text.find(reinterpret_cast<koopa_raw_function_t>(funcs.buffer[i]));
+    if (it != text.end())
+      out_ << it->second;
   }
 }
 
-void ProgramCodeGen::EmitTextSection() { std::cout << "  .text" << std::endl; }
+void ProgramCodeGen::EmitTextSection() { out_ << "  .text" << std::endl; }
 
 void FunctionCodeGen::Emit(const koopa_raw_function_t &func) {
   func_ = func;
@@ -29,15 +81,17 @@ void FunctionCodeGen::Emit(const koopa_raw_function_t &func) {
   assert(name.length() > 0 && name[0] == '@');
 
   name = name.substr(1);
-  std::cout << "  .globl " << name << std::endl;
-  std::cout << name << ":" << std::endl;
+  out_ << "  .globl " << name << std::endl;
+  out_ << name << ":" << std::endl;
 
   AllocateStackSpace();
+  ShrinkWrap();
+  if (mir_)
+    DumpMIR();
   EmitPrologue();
 
+  // 尾声在每个 ret 处就地展开，不再共享 epilogue 标签
   EmitSlice(func_->bbs);
-
-  EmitEpilogue();
 }
 
 void FunctionCodeGen::EmitSlice(const koopa_raw_slice_t &slice) {
@@ -61,15 +115,92 @@ void FunctionCodeGen::EmitSlice(const koopa_raw_slice_t &slice) {
 }
 
 void FunctionCodeGen::EmitPrologue() {
+  // 栈帧经收缩包装移到其它基本块时，入口处不调整 sp
+  if (!save_point_)
+    EmitFrameSetup();
+
+  // 前 8 个形参由 a0 ~ a7 传入，先移到各自的位置，之后的调用会覆盖这些寄存器
+  const koopa_raw_slice_t &params = func_->params;
+  std::vector<Move> copies;
+  for (size_t i = 0; i < params.len && i < 8; ++i) {
+    koopa_raw_value_t param = (koopa_raw_value_t)params.buffer[i];
+    if (deferred_params_.count(param))
+      continue;
+    copies.push_back(
+        {GetLocation(param), Location::Reg("a" + std::to_string(i))});
+  }
+  EmitCopies(SequentializeCopies(copies, Location::Reg("t2")));
+}
+
+// 分配栈帧并保存 ra 与用到的 callee-saved 寄存器
+void FunctionCodeGen::EmitFrameSetup() {
+  // 不需要栈帧的函数（如不访问内存的叶子函数）直接省略 sp 调整
+  if (!stack_frame_.NeedsFrame())
+    return;
   int size = static_cast<int>(stack_frame_.GetStackSize());
-  std::cout << "  addi sp, sp, " << -size << std::endl;
+  out_ << "  addi sp, sp, " << -size << std::endl;
+  for (const auto &[reg, offset] : stack_frame_.GetSavedRegs()) {
+    out_ << "  sw " << reg << ", " << offset << "(sp)" << std::endl;
+  }
 }
 
+/**
+ * 尾声较短，在每个返回点复制一份，省去跳转到公共出口的 j 指令
+ */
 void FunctionCodeGen::EmitEpilogue() {
+  if (in_frame_)
+    EmitFrameTeardown();
+  out_ << "  ret" << std::endl;
+}
+
+// 恢复保存的寄存器并释放栈帧，ret 与尾调用共用
+void FunctionCodeGen::EmitFrameTeardown() {
+  if (!stack_frame_.NeedsFrame())
+    return;
+  for (const auto &[reg, offset] : stack_frame_.GetSavedRegs()) {
+    out_ << "  lw " << reg << ", " << offset << "(sp)" << std::endl;
+  }
   int size = static_cast<int>(stack_frame_.GetStackSize());
-  std::cout << "epilogue:" << std::endl;
-  std::cout << "  addi sp, sp, " << size << std::endl;
-  std::cout << "  ret" << std::endl;
+  out_ << "  addi sp, sp, " << size << std::endl;
+}
+
+/**
+ * 尾调用：实参装入 a0 ~ a7 后释放本函数的栈帧，再用 tail 跳转到被调函数，
+ * 被调函数直接返回到本函数的调用者，栈帧所在的空间由被调函数复用
+ */
+void FunctionCodeGen::EmitTailCall(const koopa_raw_value_t &value) {
+  const auto &call = value->kind.data.call;
+  std::vector<Move> copies;
+  for (size_t i = 0; i < call.args.len; ++i) {
+    koopa_raw_value_t arg = (koopa_raw_value_t)call.args.buffer[i];
+    copies.push_back({Location::Reg("a" + std::to_string(i)), GetLocation(arg)});
+  }
+  EmitCopies(SequentializeCopies(copies, Location::Reg("t2")));
+  if (in_frame_)
+    EmitFrameTeardown();
+  out_ << "  tail " << std::string(call.callee->name).substr(1)
+            << std::endl;
+  out_ << std::endl;
+}
+
+/**
+ * 基本块以 call; ret 结尾且直接返回调用结果时为尾调用。
+ * 实参需全部通过寄存器传递，否则被调函数会读到已释放的栈帧
+ */
+bool FunctionCodeGen::IsTailCall(const koopa_raw_basic_block_t &bb,
+                                 size_t index) const {
+  const koopa_raw_slice_t &insts = bb->insts;
+  if (index + 2 != insts.len)
+    return false;
+  koopa_raw_value_t call = (koopa_raw_value_t)insts.buffer[index];
+  koopa_raw_value_t ret = (koopa_raw_value_t)insts.buffer[index + 1];
+  if (call->kind.tag != KOOPA_RVT_CALL || ret->kind.tag != KOOPA_RVT_RETURN ||
+      call->kind.data.call.args.len > 8)
+    return false;
+  koopa_raw_value_t ret_value = ret->kind.data.ret.value;
+  if (call->ty->tag == KOOPA_RTT_UNIT)
+    return ret_value == nullptr;
+  return ret_value == call;
 }
 
 void FunctionCodeGen::EmitBasicBlock(const koopa_raw_basic_block_t &bb) {
@@ -77,29 +208,41 @@ void FunctionCodeGen::EmitBasicBlock(const koopa_raw_basic_block_t &bb) {
   label_name = label_name.substr(1);
   // 函数入口的 Block 不需要再添加 label 了，已经有 main 入口了
   if (label_name != "entry")
-    std::cout << label_name << ':' << std::endl;
-  EmitSlice(bb->insts);
+    out_ << label_name << ':' << std::endl;
+  // 各函数的入口块同名，以函数名区分
+  block_label_ = label_name != "entry"
+                     ? label_name
+                     : std::string(func_->name).substr(1) + "_entry";
+
+  in_frame_ = !save_point_ || frame_blocks_.count(bb);
+  if (bb == save_point_) {
+    EmitFrameSetup();
+    EmitCopies(deferred_copies_);
+  }
+
+  const koopa_raw_slice_t &insts = bb->insts;
+  for (size_t i = 0; i < insts.len; ++i) {
+    koopa_raw_value_t inst = (koopa_raw_value_t)insts.buffer[i];
+    // 尾调用之后的 ret 不会被执行
+    if (IsTailCall(bb, i)) {
+      EmitTailCall(inst);
+      break;
+    }
+    EmitValue(inst);
+  }
 }
 
 void FunctionCodeGen::EmitValue(const koopa_raw_value_t &value) {
   const auto &kind = value->kind;
   switch (kind.tag) {
   case KOOPA_RVT_RETURN: {
+    koopa_raw_value_t ret_value = kind.data.ret.value;
 
-    switch (kind.data.ret.value->kind.tag) {
-    case KOOPA_RVT_INTEGER:
-      // 整数常量直接放到 a0
-      std::cout << "  li a0, " << kind.data.ret.value->kind.data.integer.value
-                << std::endl;
-      break;
-    default: {
-      // 其他值从栈中加载到 a0
-      size_t ret_offset = GetStackOffset(kind.data.ret.value);
-      std::cout << "  lw a0, " << ret_offset << "(sp)" << std::endl;
-    }
-    }
+    // void 函数的 ret 没有返回值，其余的返回值放到 a0
+    if (ret_value)
+      EmitMove(Location::Reg("a0"), GetLocation(ret_value));
 
-    std::cout << "  j epilogue" << std::endl;
+    EmitEpilogue();
 
     break;
   }
@@ -108,89 +251,75 @@ void FunctionCodeGen::EmitValue(const koopa_raw_value_t &value) {
     break;
   case KOOPA_RVT_BINARY: {
     const auto &binary = kind.data.binary;
-    size_t res_offset = GetStackOffset(value);
 
-    // 加载左操作数到 t0
-    if (binary.lhs->kind.tag == KOOPA_RVT_INTEGER) {
-      std::cout << "  li t0, " << binary.lhs->kind.data.integer.value
-                << std::endl;
-    } else {
-      size_t lhs_offset = GetStackOffset(binary.lhs);
-      std::cout << "  lw t0, " << lhs_offset << "(sp)" << std::endl;
-    }
-
-    // 加载右操作数到 t1
-    if (binary.rhs->kind.tag == KOOPA_RVT_INTEGER) {
-      std::cout << "  li t1, " << binary.rhs->kind.data.integer.value
-                << std::endl;
-    } else {
-      size_t rhs_offset = GetStackOffset(binary.rhs);
-      std::cout << "  lw t1, " << rhs_offset << "(sp)" << std::endl;
-    }
+    // 不在寄存器中的左、右操作数分别装入 t0、t1
+    std::string lhs = UseReg(binary.lhs, "t0");
+    std::string rhs = UseReg(binary.rhs, "t1");
+    std::string res = DefReg(value);
+    std::string ops = res + ", " + lhs + ", " + rhs;
 
     switch (binary.op) {
     case KOOPA_RBO_NOT_EQ:
-      std::cout << "  sub t0, t0, t1" << std::endl;
-      std::cout << "  snez t0, t0" << std::endl;
+      out_ << "  sub " << ops << std::endl;
+      out_ << "  snez " << res << ", " << res << std::endl;
       break;
     case KOOPA_RBO_EQ:
-      std::cout << "  sub t0, t0, t1" << std::endl;
-      std::cout << "  seqz t0, t0" << std::endl;
+      out_ << "  sub " << ops << std::endl;
+      out_ << "  seqz " << res << ", " << res << std::endl;
       break;
     case KOOPA_RBO_GT:
-      std::cout << "  sgt t0, t0, t1" << std::endl;
+      out_ << "  sgt " << ops << std::endl;
       break;
     case KOOPA_RBO_LT:
-      std::cout << "  slt t0, t0, t1" << std::endl;
+      out_ << "  slt " << ops << std::endl;
       break;
     case KOOPA_RBO_GE:
-      std::cout << "  slt t0, t0, t1" << std::endl;
-      std::cout << "  xori t0, t0, 1" << std::endl;
+      out_ << "  slt " << ops << std::endl;
+      out_ << "  xori " << res << ", " << res << ", 1" << std::endl;
       break;
     case KOOPA_RBO_LE:
-      std::cout << "  sgt t0, t0, t1" << std::endl;
-      std::cout << "  xori t0, t0, 1" << std::endl;
+      out_ << "  sgt " << ops << std::endl;
+      out_ << "  xori " << res << ", " << res << ", 1" << std::endl;
       break;
     case KOOPA_RBO_ADD:
-      std::cout << "  add t0, t0, t1" << std::endl;
+      out_ << "  add " << ops << std::endl;
       break;
     case KOOPA_RBO_SUB:
-      std::cout << "  sub t0, t0, t1" << std::endl;
+      out_ << "  sub " << ops << std::endl;
       break;
     case KOOPA_RBO_MUL:
-      std::cout << "  mul t0, t0, t1" << std::endl;
+      out_ << "  mul " << ops << std::endl;
       break;
     case KOOPA_RBO_DIV:
-      std::cout << "  div t0, t0, t1" << std::endl;
+      out_ << "  div " << ops << std::endl;
       break;
     case KOOPA_RBO_MOD:
-      std::cout << "  rem t0, t0, t1" << std::endl;
+      out_ << "  rem " << ops << std::endl;
       break;
     case KOOPA_RBO_AND:
-      std::cout << "  and t0, t0, t1" << std::endl;
+      out_ << "  and " << ops << std::endl;
       break;
     case KOOPA_RBO_OR:
-      std::cout << "  or t0, t0, t1" << std::endl;
+      out_ << "  or " << ops << std::endl;
       break;
     case KOOPA_RBO_XOR:
-      std::cout << "  xor t0, t0, t1" << std::endl;
+      out_ << "  xor " << ops << std::endl;
       break;
     case KOOPA_RBO_SHL:
-      std::cout << "  sll t0, t0, t1" << std::endl;
+      out_ << "  sll " << ops << std::endl;
       break;
     case KOOPA_RBO_SHR:
-      std::cout << "  srl t0, t0, t1" << std::endl;
+      out_ << "  srl " << ops << std::endl;
       break;
     case KOOPA_RBO_SAR:
-      std::cout << "  sra t0, t0, t1" << std::endl;
+      out_ << "  sra " << ops << std::endl;
       break;
     default:
-      std::cerr << "Unsupported binary operation: " << binary.op << std::endl;
-      assert(false);
+      throw std::runtime_error("Unsupported binary operation: " +
+                               std::to_string(binary.op));
     }
 
-    // 将结果存回栈
-    std::cout << "  sw t0, " << res_offset << "(sp)" << std::endl;
+    FinishDef(value, res);
     break;
   }
   case KOOPA_RVT_ALLOC:
@@ -199,30 +328,19 @@ void FunctionCodeGen::EmitValue(const koopa_raw_value_t &value) {
   case KOOPA_RVT_LOAD: {
     const auto &load = kind.data.load;
     size_t src_offset = GetStackOffset(load.src);
-    size_t res_offset = GetStackOffset(value);
+    std::string res = DefReg(value);
 
-    std::cout << "  lw t0, " << src_offset << "(sp)" << std::endl;
-    std::cout << "  sw t0, " << res_offset << "(sp)" << std::endl;
+    out_ << "  lw " << res << ", " << src_offset << "(sp)" << std::endl;
+    FinishDef(value, res);
     break;
   }
   case KOOPA_RVT_STORE: {
-    // "store src_imm/src_offset, dest_offset"
+    // "store src_imm/src_reg/src_offset, dest_offset"
     const auto &store = kind.data.store;
-    switch (store.value->kind.tag) {
-    case KOOPA_RVT_INTEGER: {
-      int32_t src_imm = store.value->kind.data.integer.value;
-      std::cout << "  li t0, " << src_imm << std::endl;
-      break;
-    }
-    default:
-      // 除了立即数，其余都放在栈上
-      size_t src_offset = GetStackOffset(store.value);
-      std::cout << "  lw t0, " << src_offset << "(sp)" << std::endl;
-      break;
-    }
+    std::string src = UseReg(store.value, "t0");
 
     size_t dest_offset = GetStackOffset(store.dest);
-    std::cout << "  sw t0, " << dest_offset << "(sp)" << std::endl;
+    out_ << "  sw " << src << ", " << dest_offset << "(sp)" << std::endl;
     break;
   }
   case KOOPA_RVT_BRANCH: {
@@ -230,45 +348,105 @@ void FunctionCodeGen::EmitValue(const koopa_raw_value_t &value) {
     std::string true_label = std::string(branch.true_bb->name).substr(1);
     std::string false_label = std::string(branch.false_bb->name).substr(1);
 
-    // 加载条件
-    if (branch.cond->kind.tag == KOOPA_RVT_INTEGER) {
-      std::cout << "  li t0, " << branch.cond->kind.data.integer.value
-                << std::endl;
+    // 加载条件，条件跳转在传递块参数之前，复制不会改写条件
+    std::string cond = UseReg(branch.cond, "t0");
+
+    // 只有一侧的边上有代码（传递块参数或释放栈帧）时，
+    // 条件跳转直接跳到另一侧的目标块
+    auto true_copies = BlockArgCopies(branch.true_bb, branch.true_args);
+    auto false_copies = BlockArgCopies(branch.false_bb, branch.false_args);
+    bool true_empty = true_copies.empty() && !LeavesFrame(branch.true_bb);
+    bool false_empty = false_copies.empty() && !LeavesFrame(branch.false_bb);
+    if (false_empty) {
+      out_ << "  beqz " << cond << ", " << false_label << std::endl;
+      EmitEdge(branch.true_bb, true_copies);
+    } else if (true_empty) {
+      out_ << "  bnez " << cond << ", " << true_label << std::endl;
+      EmitEdge(branch.false_bb, false_copies);
     } else {
-      size_t cond_offset = GetStackOffset(branch.cond);
-      std::cout << "  lw t0, " << cond_offset << "(sp)" << std::endl;
+      // 每个基本块只有一条分支指令，以所在块命名的标签在函数内唯一
+      std::string edge_label = block_label_ + "_to_" + false_label;
+      out_ << "  beqz " << cond << ", " << edge_label << std::endl;
+      EmitEdge(branch.true_bb, true_copies);
+      out_ << edge_label << ":" << std::endl;
+      EmitEdge(branch.false_bb, false_copies);
     }
+    break;
+  }
+  case KOOPA_RVT_CALL: {
+    // 前 8 个实参放入 a0 ~ a7，其余依次放到栈底的传参区
+    // 先写栈上的实参，再把寄存器实参作为并行复制装入 a0 ~ a7
+    const auto &call = kind.data.call;
+    std::vector<Move> copies;
+    for (size_t i = 0; i < call.args.len; ++i) {
+      koopa_raw_value_t arg = (koopa_raw_value_t)call.args.buffer[i];
+      if (i < 8) {
+        copies.push_back(
+            {Location::Reg("a" + std::to_string(i)), GetLocation(arg)});
+      } else {
+        std::string reg = UseReg(arg, "t0");
+        out_ << "  sw " << reg << ", " << (i - 8) * 4 << "(sp)"
+                  << std::endl;
+      }
+    }
+    EmitCopies(SequentializeCopies(copies, Location::Reg("t2")));
+    out_ << "  call " << std::string(call.callee->name).substr(1)
+              << std::endl;
 
-    // 条件为 false 时跳到 false 分支
-    std::cout << "  beqz t0, " << false_label << "_args" << std::endl;
-
-    // 条件为 true：传递 true_args 并跳转
-    EmitBlockArgs(branch.true_bb, branch.true_args);
-    std::cout << "  j " << true_label << std::endl;
-
-    // false 分支的参数传递
-    std::cout << false_label << "_args:" << std::endl;
-    EmitBlockArgs(branch.false_bb, branch.false_args);
-    std::cout << "  j " << false_label << std::endl;
+    // 有返回值时将 a0 移到结果的位置
+    if (value->ty->tag != KOOPA_RTT_UNIT)
+      EmitMove(GetLocation(value), Location::Reg("a0"));
     break;
   }
   case KOOPA_RVT_JUMP: {
     const auto &jump = kind.data.jump;
-    std::string jump_label = std::string(jump.target->name).substr(1);
-    std::cout << "  j " << jump_label << std::endl;
+    EmitEdge(jump.target, BlockArgCopies(jump.target, jump.args));
     break;
   }
 
   default:
-    std::cerr << "Error: Unsupported value kind: " << kind.tag << std::endl;
-    assert(false);
-    break;
+    throw std::runtime_error("Unsupported value kind: " +
+                             std::to_string(kind.tag));
   }
-  std::cout << std::endl;
+  out_ << std::endl;
 }
 
 void FunctionCodeGen::AllocateStackSpace() {
   koopa_raw_slice_t bbs = func_->bbs;
+
+  // 先确定传参区大小，它位于栈帧的最底部
+  size_t max_call_args = 0;
+  for (size_t i = 0; i < bbs.len; ++i) {
+    koopa_raw_basic_block_t bb = (koopa_raw_basic_block_t)bbs.buffer[i];
+    for (size_t j = 0; j < bb->insts.len; ++j) {
+      koopa_raw_value_t inst = (koopa_raw_value_t)bb->insts.buffer[j];
+      // 存在调用的函数不是叶子函数，需要保存 ra；尾调用不会返回到本函数
+      if (inst->kind.tag == KOOPA_RVT_CALL && !IsTailCall(bb, j)) {
+        stack_frame_.MarkHasCall();
+        max_call_args = std::max<size_t>(max_call_args,
+                                         inst->kind.data.call.args.len);
+      }
+    }
+  }
+  stack_frame_.ReserveOutgoingArgs(max_call_args);
+
+  if (regalloc_ == RegAllocKind::Graph)
+    AllocateRegisters();
+  else
+    CoalesceBlockArgs();
+
+  // 寄存器传入的形参分配栈槽，其余形参直接使用调用者的传参区
+  koopa_raw_slice_t params = func_->params;
+  for (size_t i = 0; i < params.len; ++i) {
+    koopa_raw_value_t param = (koopa_raw_value_t)params.buffer[i];
+    if (regs_.count(param))
+      continue;
+    if (i < 8)
+      AllocValueSlot(param);
+    else
+      stack_frame_.BindIncomingArg(param, i);
+  }
+
   for (size_t i = 0; i < bbs.len; ++i) {
     koopa_raw_basic_block_t bb = (koopa_raw_basic_block_t)bbs.buffer[i];
 
@@ -276,7 +454,8 @@ void FunctionCodeGen::AllocateStackSpace() {
     koopa_raw_slice_t params = bb->params;
     for (size_t j = 0; j < params.len; ++j) {
       koopa_raw_value_t param = (koopa_raw_value_t)params.buffer[j];
-      stack_frame_.AllocSlot(param);
+      if (!regs_.count(param))
+        AllocValueSlot(param);
     }
 
     // 分配指令的栈空间
@@ -285,35 +464,498 @@ void FunctionCodeGen::AllocateStackSpace() {
       koopa_raw_value_t inst = (koopa_raw_value_t)insts.buffer[j];
 
       koopa_raw_type_tag_t tag = inst->ty->tag;
-      // 没有返回值的指令不分配栈空间
-      if (tag == KOOPA_RTT_UNIT)
+      // 没有返回值的指令、尾调用的结果与分配到寄存器的值不分配栈空间
+      if (tag == KOOPA_RTT_UNIT || IsTailCall(bb, j) || regs_.count(inst))
         continue;
 
-      stack_frame_.AllocSlot(inst);
+      AllocValueSlot(inst);
     }
   }
   stack_frame_.Align();
 }
 
+/**
+ * 收缩包装：只在用到栈帧的路径上建立栈帧、保存 ra 与 callee-saved 寄存器。
+ * 栈帧建立在所有用到它的基本块的最近公共支配者处，它在循环中时上移到
+ * 循环之外，以免每次迭代都保存与恢复；它后支配入口时收缩没有收益。
+ * 栈帧存在于被它支配的基本块中，ret、尾调用与离开这些块的边负责释放，
+ * 提前返回的路径不访问栈
+ */
+void FunctionCodeGen::ShrinkWrap() {
+  if (!stack_frame_.NeedsFrame())
+    return;
+
+  // 位于栈上或 callee-saved 寄存器中的形参，建立栈帧之前仍从 a0 ~ a7 读取
+  const koopa_raw_slice_t &params = func_->params;
+  for (size_t i = 0; i < params.len && i < 8; ++i) {
+    koopa_raw_value_t param = (koopa_raw_value_t)params.buffer[i];
+    if (LocationNeedsFrame(GetLocation(param)))
+      deferred_params_[param] = "a" + std::to_string(i);
+  }
+
+  MachineCFG cfg(func_);
+  koopa_raw_basic_block_t entry = cfg.Entry();
+  koopa_raw_basic_block_t save_point = nullptr;
+  for (koopa_raw_basic_block_t bb : cfg.ReversePostOrder()) {
+    if (BlockUsesFrame(bb))
+      save_point =
+          save_point ? cfg.NearestCommonDominator(save_point, bb) : bb;
+  }
+  while (save_point && save_point != entry && cfg.LoopDepth(save_point) > 0)
+    save_point = cfg.IDom(save_point);
+  if (!save_point || save_point == entry ||
+      cfg.PostDominates(save_point, entry)) {
+    deferred_params_.clear();
+    return;
+  }
+
+  save_point_ = save_point;
+  for (koopa_raw_basic_block_t bb : cfg.Blocks()) {
+    // 不可达的基本块不会执行，视为位于栈帧之中
+    if (!cfg.IsReachable(bb) || cfg.Dominates(save_point, bb))
+      frame_blocks_.insert(bb);
+  }
+
+  // 栈帧之中用到的形参在建立栈帧后移到各自的位置
+  std::vector<Move> copies;
+  for (size_t i = 0; i < params.len && i < 8; ++i) {
+    koopa_raw_value_t param = (koopa_raw_value_t)params.buffer[i];
+    auto it = deferred_params_.find(param);
+    if (it == deferred_params_.end())
+      continue;
+    if (!CanDeferParam(param, it->second, cfg)) {
+      save_point_ = nullptr;
+      frame_blocks_.clear();
+      deferred_params_.clear();
+      return;
+    }
+    bool used = false;
+    for (koopa_raw_basic_block_t bb : frame_blocks_) {
+      for (size_t j = 0; j < bb->insts.len && !used; ++j) {
+        auto uses = Liveness::Uses((koopa_raw_value_t)bb->insts.buffer[j]);
+        used = std::find(uses.begin(), uses.end(), param) != uses.end();
+      }
+    }
+    if (used)
+      copies.push_back({GetLocation(param), Location::Reg(it->second)});
+  }
+  deferred_copies_ = SequentializeCopies(copies, Location::Reg("t2"));
+}
+
+/**
+ * -dump-mir：输出寄存器分配与栈帧布局的结果，即每个值所在的寄存器或栈槽、
+ * 栈帧大小与保存的寄存器，以及收缩包装后建立栈帧的位置
+ */
+void FunctionCodeGen::DumpMIR() {
+  std::ostream &out = *mir_;
+  auto name_of = [](const char *name) {
+    return name ? std::string(name) : std::string("<unnamed>");
+  };
+  auto location_of = [&](koopa_raw_value_t val) -> std::string {
+    auto it = regs_.find(val);
+    if (it != regs_.end())
+      return it->second;
+    if (stack_frame_.HasSlot(val))
+      return std::to_string(stack_frame_.GetOffset(val)) + "(sp)";
+    return "-";
+  };
+
+  out << "MIR for " << func_->name << ": frame " << stack_frame_.GetStackSize()
+      << " bytes";
+  if (!stack_frame_.GetSavedRegs().empty()) {
+    out << ", saves";
+    for (const auto &[reg, offset] : stack_frame_.GetSavedRegs())
+      out << " " << reg << "@" << offset;
+  }
+  if (save_point_)
+    out << ", frame set up in " << name_of(save_point_->name);
+  out << std::endl;
+
+  const koopa_raw_slice_t &params = func_->params;
+  for (size_t i = 0; i < params.len; ++i) {
+    koopa_raw_value_t param = (koopa_raw_value_t)params.buffer[i];
+    out << "  param " << name_of(param->name) << " = " << location_of(param);
+    auto it = deferred_params_.find(param);
+    if (it != deferred_params_.end())
+      out << " (" << it->second << " until frame setup)";
+    out << std::endl;
+  }
+
+  for (size_t i = 0; i < func_->bbs.len; ++i) {
+    auto bb = (koopa_raw_basic_block_t)func_->bbs.buffer[i];
+    out << "  " << name_of(bb->name) << ":";
+    if (save_point_ && !frame_blocks_.count(bb))
+      out << " (no frame)";
+    out << std::endl;
+    for (size_t j = 0; j < bb->params.len; ++j) {
+      auto param = (koopa_raw_value_t)bb->params.buffer[j];
+      out << "    " << name_of(param->name) << " = " << location_of(param)
+          << std::endl;
+    }
+    for (size_t j = 0; j < bb->insts.len; ++j) {
+      auto inst = (koopa_raw_value_t)bb->insts.buffer[j];
+      if (inst->ty->tag == KOOPA_RTT_UNIT)
+        continue;
+      out << "    " << name_of(inst->name) << " = " << location_of(inst)
+          << std::endl;
+    }
+  }
+}
+
+// 访问栈槽、调用其它函数，或读写栈上与 callee-saved 寄存器中的值的基本块需要栈帧
+bool FunctionCodeGen::BlockUsesFrame(koopa_raw_basic_block_t bb) {
+  auto needs_frame = [&](koopa_raw_value_t val) {
+    return !deferred_params_.count(val) &&
+           LocationNeedsFrame(GetLocation(val));
+  };
+  auto params_need_frame = [&](koopa_raw_basic_block_t target) {
+    for (size_t i = 0; i < target->params.len; ++i) {
+      if (needs_frame((koopa_raw_value_t)target->params.buffer[i]))
+        return true;
+    }
+    return false;
+  };
+
+  if (params_need_frame(bb))
+    return true;
+  for (size_t i = 0; i < bb->insts.len; ++i) {
+    koopa_raw_value_t inst = (koopa_raw_value_t)bb->insts.buffer[i];
+    for (koopa_raw_value_t use : Liveness::Uses(inst)) {
+      if (needs_frame(use))
+        return true;
+    }
+    // 尾调用之后的 ret 不会被执行
+    if (IsTailCall(bb, i))
+      break;
+    koopa_raw_value_tag_t tag = inst->kind.tag;
+    if (tag == KOOPA_RVT_LOAD || tag == KOOPA_RVT_STORE ||
+        tag == KOOPA_RVT_CALL)
+      return true;
+    if (Liveness::IsVariable(inst) && needs_frame(inst))
+      return true;
+    // 边上的复制写入目标块的参数
+    for (koopa_raw_basic_block_t succ : Liveness::Succs(inst)) {
+      if (params_need_frame(succ))
+        return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * 形参能否在建立栈帧之前留在传入它的寄存器 reg 中：栈帧之外读取它的地方
+ * 以及 save_point_ 的入口处，reg 在所有路径上都未被改写。
+ * 对栈帧之外的基本块做前向的必经数据流分析，初值乐观地取为未改写
+ */
+bool FunctionCodeGen::CanDeferParam(koopa_raw_value_t param,
+                                    const std::string &reg,
+                                    const MachineCFG &cfg) {
+  // 入口处其它形参的复制可能写入 reg
+  bool entry_intact = true;
+  for (size_t i = 0; i < func_->params.len && i < 8; ++i) {
+    koopa_raw_value_t other = (koopa_raw_value_t)func_->params.buffer[i];
+    if (!deferred_params_.count(other) &&
+        GetLocation(other) == Location::Reg(reg))
+      entry_intact = false;
+  }
+
+  std::unordered_map<koopa_raw_basic_block_t, bool> intact_out;
+  for (koopa_raw_basic_block_t bb : cfg.ReversePostOrder()) {
+    if (!frame_blocks_.count(bb))
+      intact_out[bb] = true;
+  }
+  auto intact_in = [&](koopa_raw_basic_block_t bb) {
+    if (bb == cfg.Entry())
+      return entry_intact;
+    for (koopa_raw_basic_block_t pred : cfg.Preds(bb)) {
+      if (!cfg.IsReachable(pred))
+        continue;
+      auto it = intact_out.find(pred);
+      if (it == intact_out.end() || !it->second)
+        return false;
+    }
+    return true;
+  };
+  auto writes_reg = [&](koopa_raw_value_t val) {
+    auto it = regs_.find(val);
+    return it != regs_.end() && it->second == reg;
+  };
+
+  // 逐条扫描指令，返回块末尾 reg 是否仍保存形参；读取已改写的 reg 时清除 valid
+  auto transfer = [&](koopa_raw_basic_block_t bb, bool intact, bool &valid) {
+    for (size_t i = 0; i < bb->insts.len; ++i) {
+      koopa_raw_value_t inst = (koopa_raw_value_t)bb->insts.buffer[i];
+      auto uses = Liveness::Uses(inst);
+      if (!intact && std::find(uses.begin(), uses.end(), param) != uses.end())
+        valid = false;
+      if (writes_reg(inst))
+        intact = false;
+      for (koopa_raw_basic_block_t succ : Liveness::Succs(inst)) {
+        for (size_t j = 0; j < succ->params.len; ++j) {
+          if (writes_reg((koopa_raw_value_t)succ->params.buffer[j]))
+            intact = false;
+        }
+      }
+    }
+    return intact;
+  };
+
+  bool valid = true;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto &[bb, out] : intact_out) {
+      bool new_out = transfer(bb, intact_in(bb), valid);
+      if (new_out != out) {
+        out = new_out;
+        changed = true;
+      }
+    }
+  }
+
+  valid = true;
+  for (const auto &[bb, out] : intact_out) {
+    transfer(bb, intact_in(bb), valid);
+  }
+  return valid && intact_in(save_point_);
+}
+
+// 从栈帧所在的区域跳到区域之外时，边上需要释放栈帧
+bool FunctionCodeGen::LeavesFrame(koopa_raw_basic_block_t target) const {
+  return save_point_ && in_frame_ && !frame_blocks_.count(target);
+}
+
 size_t FunctionCodeGen::GetStackOffset(koopa_raw_value_t val) {
   // 不应为立即数分配栈空间
   assert(val->kind.tag != KOOPA_RVT_INTEGER);
   return stack_frame_.GetOffset(val);
 }
 
-void FunctionCodeGen::EmitBlockArgs(koopa_raw_basic_block_t bb,
-                                    koopa_raw_slice_t args) {
+// 分配给值的调用者保存寄存器、返回值所用的 a0，以及各调用改写的寄存器
+ClobberSet FunctionCodeGen::Clobbers() const {
+  ClobberSet clobbers;
+  for (const auto &[value, reg] : regs_) {
+    if (!IsCalleeSaved(reg))
+      clobbers.insert(reg);
+  }
+  for (size_t i = 0; i < func_->bbs.len; ++i) {
+    auto bb = (koopa_raw_basic_block_t)func_->bbs.buffer[i];
+    for (size_t j = 0; j < bb->insts.len; ++j) {
+      auto inst = (koopa_raw_value_t)bb->insts.buffer[j];
+      if (inst->kind.tag == KOOPA_RVT_CALL) {
+        ClobberSet callee = CallClobbers(inst, clobbers_);
+        clobbers.insert(callee.begin(), callee.end());
+      } else if (inst->kind.tag == KOOPA_RVT_RETURN &&
+                 inst->kind.data.ret.value) {
+        clobbers.insert("a0");
+      }
+    }
+  }
+  return clobbers;
+}
+
+/**
+ * 图着色分配寄存器。同一节点上溢出的值共用栈槽；
+ * 用到的 callee-saved 寄存器按固定顺序登记，保证栈帧布局稳定
+ */
+void FunctionCodeGen::AllocateRegisters() {
+  Liveness liveness(func_);
+  MachineCFG cfg(func_);
+  GraphColoringAllocator allocator(func_, liveness, cfg, clobbers_);
+  allocator.Run();
+  regs_ = allocator.Assignment();
+
+  for (const auto &reg : AllocatableRegs()) {
+    if (!IsCalleeSaved(reg))
+      continue;
+    for (const auto &[value, assigned] : regs_) {
+      if (assigned == reg) {
+        stack_frame_.MarkCalleeSavedUsed(reg);
+        break;
+      }
+    }
+  }
+
+  auto share_spill_slot = [&](koopa_raw_value_t val) {
+    koopa_raw_value_t leader = allocator.SpillLeader(val);
+    if (!regs_.count(val) && leader != val)
+      slot_leader_[val] = leader;
+  };
+  for (size_t i = 0; i < func_->params.len && i < 8; ++i)
+    share_spill_slot((koopa_raw_value_t)func_->params.buffer[i]);
+  for (size_t i = 0; i < func_->bbs.len; ++i) {
+    koopa_raw_basic_block_t bb = (koopa_raw_basic_block_t)func_->bbs.buffer[i];
+    for (size_t j = 0; j < bb->params.len; ++j)
+      share_spill_slot((koopa_raw_value_t)bb->params.buffer[j]);
+    for (size_t j = 0; j < bb->insts.len; ++j)
+      share_spill_slot((koopa_raw_value_t)bb->insts.buffer[j]);
+  }
+}
+
+/**
+ * 块参数与传给它的实参活跃范围不冲突时合并到同一个集合，共用一个栈槽，
+ * 跳转时这一对之间的复制随之消失。集合之间的冲突取成员冲突的并集
+ */
+void FunctionCodeGen::CoalesceBlockArgs() {
+  Liveness liveness(func_);
+  auto graph = liveness.BuildInterference();
+  std::unordered_map<koopa_raw_value_t, std::vector<koopa_raw_value_t>>
+      members;
+
+  auto try_coalesce = [&](koopa_raw_basic_block_t target,
+                          koopa_raw_slice_t args) {
+    for (size_t i = 0; i < args.len; ++i) {
+      koopa_raw_value_t arg = (koopa_raw_value_t)args.buffer[i];
+      // 通过栈传入的形参位于调用者的栈帧，不能与块参数共用
+      if (!Liveness::IsVariable(arg) ||
+          (arg->kind.tag == KOOPA_RVT_FUNC_ARG_REF &&
+           arg->kind.data.func_arg_ref.index >= 8))
+        continue;
+      koopa_raw_value_t lhs =
+          FindSlotLeader((koopa_raw_value_t)target->params.buffer[i]);
+      koopa_raw_value_t rhs = FindSlotLeader(arg);
+      if (lhs == rhs)
+        continue;
+      if (members[lhs].empty())
+        members[lhs].push_back(lhs);
+      if (members[rhs].empty())
+        members[rhs].push_back(rhs);
+      const ValueSet &conflicts = graph[lhs];
+      bool interferes = std::any_of(
+          members[rhs].begin(), members[rhs].end(),
+          [&](koopa_raw_value_t value) { return conflicts.count(value); });
+      if (interferes)
+        continue;
+
+      slot_leader_[rhs] = lhs;
+      members[lhs].insert(members[lhs].end(), members[rhs].begin(),
+                          members[rhs].end());
+      for (koopa_raw_value_t neighbor : graph[rhs]) {
+        graph[lhs].insert(neighbor);
+      }
+    }
+  };
+
+  koopa_raw_slice_t bbs = func_->bbs;
+  for (size_t i = 0; i < bbs.len; ++i) {
+    koopa_raw_basic_block_t bb = (koopa_raw_basic_block_t)bbs.buffer[i];
+    koopa_raw_value_t term =
+        (koopa_raw_value_t)bb->insts.buffer[bb->insts.len - 1];
+    if (term->kind.tag == KOOPA_RVT_BRANCH) {
+      const auto &branch = term->kind.data.branch;
+      try_coalesce(branch.true_bb, branch.true_args);
+      try_coalesce(branch.false_bb, branch.false_args);
+    } else if (term->kind.tag == KOOPA_RVT_JUMP) {
+      try_coalesce(term->kind.data.jump.target, term->kind.data.jump.args);
+    }
+  }
+}
+
+koopa_raw_value_t FunctionCodeGen::FindSlotLeader(koopa_raw_value_t val) {
+  auto it = slot_leader_.find(val);
+  if (it == slot_leader_.end())
+    return val;
+  koopa_raw_value_t leader = FindSlotLeader(it->second);
+  it->second = leader;
+  return leader;
+}
+
+// 同一集合中第一个分配的值拥有栈槽，其余成员共用
+void FunctionCodeGen::AllocValueSlot(koopa_raw_value_t val) {
+  koopa_raw_value_t leader = FindSlotLeader(val);
+  auto it = slot_owner_.find(leader);
+  if (it != slot_owner_.end()) {
+    stack_frame_.ShareSlot(val, it->second);
+    return;
+  }
+  stack_frame_.AllocSlot(val);
+  slot_owner_[leader] = val;
+}
+
+Location FunctionCodeGen::GetLocation(koopa_raw_value_t val) {
+  if (val->kind.tag == KOOPA_RVT_INTEGER)
+    return Location::Imm(val->kind.data.integer.value);
+  if (!in_frame_) {
+    auto it = deferred_params_.find(val);
+    if (it != deferred_params_.end())
+      return Location::Reg(it->second);
+  }
+  auto it = regs_.find(val);
+  if (it != regs_.end())
+    return Location::Reg(it->second);
+  return Location::Stack(GetStackOffset(val));
+}
+
+// 操作数所在的寄存器：不在寄存器中的整数常量与栈上的值装入 scratch
+std::string FunctionCodeGen::UseReg(koopa_raw_value_t val,
+                                    const std::string &scratch) {
+  Location loc = GetLocation(val);
+  if (loc.kind == Location::Kind::Reg)
+    return loc.reg;
+  EmitMove(Location::Reg(scratch), loc);
+  return scratch;
+}
+
+// 结果写入的寄存器：溢出到栈上的值先写入 t0，再由 FinishDef 存回栈
+std::string FunctionCodeGen::DefReg(koopa_raw_value_t val) {
+  auto it = regs_.find(val);
+  return it != regs_.end() ? it->second : "t0";
+}
+
+void FunctionCodeGen::FinishDef(koopa_raw_value_t val,
+                                const std::string &reg) {
+  if (!regs_.count(val))
+    out_ << "  sw " << reg << ", " << GetStackOffset(val) << "(sp)"
+              << std::endl;
+}
+
+// 栈槽之间的复制经 t1 中转
+void FunctionCodeGen::EmitMove(const Location &dst, const Location &src) {
+  using Kind = Location::Kind;
+  if (dst == src)
+    return;
+  std::string reg = dst.kind == Kind::Reg ? dst.reg : "t1";
+  switch (src.kind) {
+  case Kind::Imm:
+    out_ << "  li " << reg << ", " << src.imm << std::endl;
+    break;
+  case Kind::Reg:
+    if (dst.kind == Kind::Reg)
+      out_ << "  mv " << reg << ", " << src.reg << std::endl;
+    else
+      reg = src.reg;
+    break;
+  case Kind::Stack:
+    out_ << "  lw " << reg << ", " << src.offset << "(sp)" << std::endl;
+    break;
+  }
+  if (dst.kind == Kind::Stack)
+    out_ << "  sw " << reg << ", " << dst.offset << "(sp)" << std::endl;
+}
+
+// 块参数的传递是并行复制，实参之间交换位置时不能逐个复制
+std::vector<Move> FunctionCodeGen::BlockArgCopies(koopa_raw_basic_block_t bb,
+                                                  koopa_raw_slice_t args) {
+  std::vector<Move> copies;
   for (size_t i = 0; i < args.len; ++i) {
     koopa_raw_value_t arg = (koopa_raw_value_t)args.buffer[i];
     koopa_raw_value_t param = (koopa_raw_value_t)bb->params.buffer[i];
-    size_t param_offset = GetStackOffset(param);
+    copies.push_back({GetLocation(param), GetLocation(arg)});
+  }
+  return SequentializeCopies(copies, Location::Reg("t2"));
+}
 
-    if (arg->kind.tag == KOOPA_RVT_INTEGER) {
-      std::cout << "  li t1, " << arg->kind.data.integer.value << std::endl;
-    } else {
-      size_t arg_offset = GetStackOffset(arg);
-      std::cout << "  lw t1, " << arg_offset << "(sp)" << std::endl;
-    }
-    std::cout << "  sw t1, " << param_offset << "(sp)" << std::endl;
+void FunctionCodeGen::EmitCopies(const std::vector<Move> &copies) {
+  for (const auto &copy : copies) {
+    EmitMove(copy.dst, copy.src);
   }
-}
\ No newline at end of file
+}
+
+// 边上先传递块参数，离开栈帧所在的区域时再释放栈帧，复制可能读取栈槽
+void FunctionCodeGen::EmitEdge(koopa_raw_basic_block_t target,
+                               const std::vector<Move> &copies) {
+  EmitCopies(copies);
+  if (LeavesFrame(target))
+    EmitFrameTeardown();
+  out_ << "  j " << std::string(target->name).substr(1) << std::endl;
+}
@@ -0,0 +1,211 @@
+#include "backend/Liveness.h"
+
+namespace {
+
+koopa_raw_value_t ValueAt(const koopa_raw_slice_t &slice, size_t i) {
+  return reinterpret_cast<koopa_raw_value_t>(slice.buffer[i]);
+}
+
+koopa_raw_value_t Terminator(koopa_raw_basic_block_t bb) {
+  return ValueAt(bb->insts, bb->insts.len - 1);
+}
+
+// 在 def 处定义的值与此时活跃的其它值冲突
+void AddDefs(const std::vector<koopa_raw_value_t> &defs, ValueSet &live,
+             std::unordered_map<koopa_raw_value_t, ValueSet> &graph) {
+  for (koopa_raw_value_t def : defs) {
+    live.erase(def);
+  }
+  for (koopa_raw_value_t def : defs) {
+    graph[def];
+    for (koopa_raw_value_t other : live) {
+      graph[def].insert(other);
+      graph[other].insert(def);
+    }
+    // 同时定义的值之间也冲突
+    for (koopa_raw_value_t other : defs) {
+      if (other != def) {
+        graph[def].insert(other);
+      }
+    }
+  }
+}
+
+} // namespace
+
+Liveness::Liveness(koopa_raw_function_t func) : func_(func) {
+  std::unordered_map<koopa_raw_basic_block_t, ValueSet> uses, defs;
+  for (size_t i = 0; i < func->bbs.len; ++i) {
+    auto bb = reinterpret_cast<koopa_raw_basic_block_t>(func->bbs.buffer[i]);
+    blocks_.push_back(bb);
+    ValueSet &use = uses[bb];
+    ValueSet &def = defs[bb];
+    for (size_t j = 0; j < bb->params.len; ++j) {
+      def.insert(ValueAt(bb->params, j));
+    }
+    for (size_t j = 0; j < bb->insts.len; ++j) {
+      koopa_raw_value_t inst = ValueAt(bb->insts, j);
+      for (koopa_raw_value_t value : Uses(inst)) {
+        if (!def.count(value)) {
+          use.insert(value);
+        }
+      }
+      if (IsVariable(inst)) {
+        def.insert(inst);
+      }
+    }
+    live_in_[bb];
+    live_out_[bb];
+  }
+
+  // 逆序迭代到不动点
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto it = blocks_.rbegin(); it != blocks_.rend(); ++it) {
+      koopa_raw_basic_block_t bb = *it;
+      ValueSet &out = live_out_[bb];
+      for (koopa_raw_basic_block_t succ : Succs(Terminator(bb))) {
+        const ValueSet &in = live_in_[succ];
+        out.insert(in.begin(), in.end());
+      }
+      ValueSet in = uses[bb];
+      for (koopa_raw_value_t value : out) {
+        if (!defs[bb].count(value)) {
+          in.insert(value);
+        }
+      }
+      if (in.size() != live_in_[bb].size()) {
+        live_in_[bb] = std::move(in);
+        changed = true;
+      }
+    }
+  }
+}
+
+bool Liveness::IsVariable(koopa_raw_value_t value) {
+  switch (value->kind.tag) {
+  case KOOPA_RVT_FUNC_ARG_REF:
+  case KOOPA_RVT_BLOCK_ARG_REF:
+    return true;
+  case KOOPA_RVT_INTEGER:
+  case KOOPA_RVT_ALLOC:
+  case KOOPA_RVT_GLOBAL_ALLOC:
+    return false;
+  default:
+    return value->ty->tag != KOOPA_RTT_UNIT;
+  }
+}
+
+std::vector<koopa_raw_value_t> Liveness::Uses(koopa_raw_value_t inst) {
+  std::vector<koopa_raw_value_t> operands;
+  const auto &kind = inst->kind;
+  auto append = [&](const koopa_raw_slice_t &slice) {
+    for (size_t i = 0; i < slice.len; ++i) {
+      operands.push_back(ValueAt(slice, i));
+    }
+  };
+  switch (kind.tag) {
+  case KOOPA_RVT_RETURN:
+    if (kind.data.ret.value) {
+      operands.push_back(kind.data.ret.value);
+    }
+    break;
+  case KOOPA_RVT_BINARY:
+    operands = {kind.data.binary.lhs, kind.data.binary.rhs};
+    break;
+  case KOOPA_RVT_LOAD:
+    operands = {kind.data.load.src};
+    break;
+  case KOOPA_RVT_STORE:
+    operands = {kind.data.store.value, kind.data.store.dest};
+    break;
+  case KOOPA_RVT_BRANCH:
+    operands = {kind.data.branch.cond};
+    append(kind.data.branch.true_args);
+    append(kind.data.branch.false_args);
+    break;
+  case KOOPA_RVT_JUMP:
+    append(kind.data.jump.args);
+    break;
+  case KOOPA_RVT_CALL:
+    append(kind.data.call.args);
+    break;
+  default:
+    break;
+  }
+
+  std::vector<koopa_raw_value_t> uses;
+  for (koopa_raw_value_t value : operands) {
+    if (IsVariable(value)) {
+      uses.push_back(value);
+    }
+  }
+  return uses;
+}
+
+std::vector<koopa_raw_basic_block_t>
+Liveness::Succs(koopa_raw_value_t terminator) {
+  const auto &kind = terminator->kind;
+  if (kind.tag == KOOPA_RVT_BRANCH) {
+    return {kind.data.branch.true_bb, kind.data.branch.false_bb};
+  }
+  if (kind.tag == KOOPA_RVT_JUMP) {
+    return {kind.data.jump.target};
+  }
+  return {};
+}
+
+/**
+ * 逆序扫描每个基本块，定义点与其后仍活跃的值冲突。
+ * 块参数在块入口处同时定义，函数形参在入口块的块参数之前定义
+ */
+std::unordered_map<koopa_raw_value_t, ValueSet>
+Liveness::BuildInterference() const {
+  std::unordered_map<koopa_raw_value_t, ValueSet> graph;
+  for (koopa_raw_basic_block_t bb : blocks_) {
+    ValueSet live = live_out_.at(bb);
+    for (size_t j = bb->insts.len; j-- > 0;) {
+      koopa_raw_value_t inst = ValueAt(bb->insts, j);
+      if (IsVariable(inst)) {
+        AddDefs({inst}, live, graph);
+      }
+      for (koopa_raw_value_t value : Uses(inst)) {
+        live.insert(value);
+      }
+    }
+
+    std::vector<koopa_raw_value_t> params;
+    for (size_t j = 0; j < bb->params.len; ++j) {
+      params.push_back(ValueAt(bb->params, j));
+    }
+    AddDefs(params, live, graph);
+  }
+
+  std::vector<koopa_raw_value_t> params;
+  for (size_t i = 0; i < func_->params.len; ++i) {
+    params.push_back(ValueAt(func_->params, i));
+  }
+  ValueSet live = live_in_.at(blocks_.front());
+  AddDefs(params, live, graph);
+  return graph;
+}
+
+std::vector<std::pair<koopa_raw_value_t, ValueSet>>
+Liveness::CallCrossings() const {
+  std::vector<std::pair<koopa_raw_value_t, ValueSet>> crossings;
+  for (koopa_raw_basic_block_t bb : blocks_) {
+    ValueSet live = live_out_.at(bb);
+    for (size_t j = bb->insts.len; j-- > 0;) {
+      koopa_raw_value_t inst = ValueAt(bb->insts, j);
+      live.erase(inst);
+      if (inst->kind.tag == KOOPA_RVT_CALL) {
+        crossings.push_back({inst, live});
+      }
+      for (koopa_raw_value_t value : Uses(inst)) {
+        live.insert(value);
+      }
+    }
+  }
+  return crossings;
+}
@@ -0,0 +1,163 @@
+#include "backend/MachineCFG.h"
+#include "backend/Liveness.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+MachineCFG::MachineCFG(koopa_raw_function_t func) {
+  for (size_t i = 0; i < func->bbs.len; ++i) {
+    auto bb = reinterpret_cast<koopa_raw_basic_block_t>(func->bbs.buffer[i]);
+    blocks_.push_back(bb);
+    preds_[bb];
+  }
+  for (koopa_raw_basic_block_t bb : blocks_) {
+    auto term = reinterpret_cast<koopa_raw_value_t>(
+        bb->insts.buffer[bb->insts.len - 1]);
+    auto &succs = succs_[bb];
+    for (koopa_raw_basic_block_t succ : Liveness::Succs(term)) {
+      // 两个分支指向同一基本块时只记一次
+      if (std::find(succs.begin(), succs.end(), succ) == succs.end()) {
+        succs.push_back(succ);
+        preds_[succ].push_back(bb);
+      }
+    }
+  }
+
+  // 迭代的深度优先遍历求后序
+  std::vector<koopa_raw_basic_block_t> post_order;
+  std::unordered_set<koopa_raw_basic_block_t> visited{Entry()};
+  std::vector<std::pair<koopa_raw_basic_block_t, size_t>> stack{{Entry(), 0}};
+  while (!stack.empty()) {
+    auto &[bb, next] = stack.back();
+    const auto &succs = succs_[bb];
+    if (next < succs.size()) {
+      koopa_raw_basic_block_t succ = succs[next++];
+      if (visited.insert(succ).second) {
+        stack.push_back({succ, 0});
+      }
+      continue;
+    }
+    post_order.push_back(bb);
+    stack.pop_back();
+  }
+  rpo_.assign(post_order.rbegin(), post_order.rend());
+  for (size_t i = 0; i < rpo_.size(); ++i) {
+    rpo_index_[rpo_[i]] = i;
+  }
+
+  ComputeDominators();
+  ComputeLoopDepth();
+}
+
+/**
+ * Cooper-Harvey-Kennedy 迭代算法，按逆后序求直接支配者
+ */
+void MachineCFG::ComputeDominators() {
+  koopa_raw_basic_block_t entry = Entry();
+  idom_[entry] = entry;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (koopa_raw_basic_block_t bb : rpo_) {
+      if (bb == entry) {
+        continue;
+      }
+      koopa_raw_basic_block_t idom = nullptr;
+      for (koopa_raw_basic_block_t pred : preds_.at(bb)) {
+        if (!idom_.count(pred)) {
+          continue;
+        }
+        idom = idom ? NearestCommonDominator(pred, idom) : pred;
+      }
+      auto it = idom_.find(bb);
+      if (it == idom_.end() || it->second != idom) {
+        idom_[bb] = idom;
+        changed = true;
+      }
+    }
+  }
+}
+
+bool MachineCFG::Dominates(koopa_raw_basic_block_t a,
+                           koopa_raw_basic_block_t b) const {
+  if (!IsReachable(b)) {
+    return false;
+  }
+  while (b != a) {
+    koopa_raw_basic_block_t idom = idom_.at(b);
+    if (idom == b) {
+      return false;
+    }
+    b = idom;
+  }
+  return true;
+}
+
+// 沿支配树向上走到两者的公共祖先，逆后序编号大的一方先走
+koopa_raw_basic_block_t
+MachineCFG::NearestCommonDominator(koopa_raw_basic_block_t a,
+                                   koopa_raw_basic_block_t b) const {
+  while (a != b) {
+    while (rpo_index_.at(a) > rpo_index_.at(b)) {
+      a = idom_.at(a);
+    }
+    while (rpo_index_.at(b) > rpo_index_.at(a)) {
+      b = idom_.at(b);
+    }
+  }
+  return a;
+}
+
+// 从 b 出发、不经过 a 能到达以 ret 结尾（没有后继）的块时，a 不后支配 b
+bool MachineCFG::PostDominates(koopa_raw_basic_block_t a,
+                               koopa_raw_basic_block_t b) const {
+  std::unordered_set<koopa_raw_basic_block_t> visited{a};
+  std::vector<koopa_raw_basic_block_t> worklist{b};
+  while (!worklist.empty()) {
+    koopa_raw_basic_block_t bb = worklist.back();
+    worklist.pop_back();
+    if (!visited.insert(bb).second) {
+      continue;
+    }
+    const auto &succs = succs_.at(bb);
+    if (succs.empty()) {
+      return false;
+    }
+    worklist.insert(worklist.end(), succs.begin(), succs.end());
+  }
+  return true;
+}
+
+// 每条回边 latch -> header 的自然循环中的基本块深度加一
+void MachineCFG::ComputeLoopDepth() {
+  for (koopa_raw_basic_block_t header : rpo_) {
+    std::unordered_set<koopa_raw_basic_block_t> body;
+    for (koopa_raw_basic_block_t latch : preds_.at(header)) {
+      if (!Dominates(header, latch)) {
+        continue;
+      }
+      std::vector<koopa_raw_basic_block_t> worklist{latch};
+      body.insert(header);
+      while (!worklist.empty()) {
+        koopa_raw_basic_block_t bb = worklist.back();
+        worklist.pop_back();
+        if (!body.insert(bb).second) {
+          continue;
+        }
+        for (koopa_raw_basic_block_t pred : preds_.at(bb)) {
+          if (IsReachable(pred)) {
+            worklist.push_back(pred);
+          }
+        }
+      }
+    }
+    for (koopa_raw_basic_block_t bb : body) {
+      ++loop_depth_[bb];
+    }
+  }
+}
+
+int MachineCFG::LoopDepth(koopa_raw_basic_block_t bb) const {
+  auto it = loop_depth_.find(bb);
+  return it == loop_depth_.end() ? 0 : it->second;
+}
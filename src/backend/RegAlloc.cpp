@@ -0,0 +1,525 @@
+#include "backend/RegAlloc.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+koopa_raw_value_t ValueAt(const koopa_raw_slice_t &slice, size_t i) {
+  return reinterpret_cast<koopa_raw_value_t>(slice.buffer[i]);
+}
+
+// 预着色节点的度数视为无穷大，永远不会被简化或溢出
+constexpr int kInfiniteDegree = std::numeric_limits<int>::max() / 2;
+
+} // namespace
+
+GraphColoringAllocator::GraphColoringAllocator(koopa_raw_function_t func,
+                                               const Liveness &liveness,
+                                               const MachineCFG &cfg,
+                                               const ClobberMap &clobbers)
+    : K(static_cast<int>(AllocatableRegs().size())), func_(func),
+      liveness_(liveness), cfg_(cfg), clobbers_(clobbers) {}
+
+void GraphColoringAllocator::Run() {
+  Build();
+  MakeWorklist();
+  while (!simplify_worklist_.empty() || !worklist_moves_.empty() ||
+         !freeze_worklist_.empty() || !spill_worklist_.empty()) {
+    if (!simplify_worklist_.empty()) {
+      Simplify();
+    } else if (!worklist_moves_.empty()) {
+      Coalesce();
+    } else if (!freeze_worklist_.empty()) {
+      Freeze();
+    } else {
+      SelectSpill();
+    }
+  }
+  AssignColors();
+
+  for (size_t i = 0; i < values_.size(); ++i) {
+    int n = K + static_cast<int>(i);
+    if (color_[n] >= 0) {
+      assignment_[values_[i]] = AllocatableRegs()[color_[n]];
+    }
+  }
+}
+
+koopa_raw_value_t
+GraphColoringAllocator::SpillLeader(koopa_raw_value_t value) const {
+  int n = NodeOf(value);
+  if (n < 0) {
+    return value;
+  }
+  // 合并到预着色节点的变量一定分到了寄存器，不会溢出
+  int alias = GetAlias(n);
+  return IsPrecolored(alias) ? value : values_[alias - K];
+}
+
+int GraphColoringAllocator::NodeOf(koopa_raw_value_t value) const {
+  auto it = nodes_.find(value);
+  return it == nodes_.end() ? -1 : it->second;
+}
+
+/**
+ * 通过栈传入的形参（第 8 个之后）留在调用者的传参区，不参与分配
+ */
+void GraphColoringAllocator::Build() {
+  auto graph = liveness_.BuildInterference();
+  std::vector<koopa_raw_value_t> vars;
+  for (const auto &[value, neighbors] : graph) {
+    if (value->kind.tag == KOOPA_RVT_FUNC_ARG_REF &&
+        value->kind.data.func_arg_ref.index >= 8) {
+      continue;
+    }
+    vars.push_back(value);
+  }
+  // 节点按变量在函数中出现的顺序编号，与哈希表的遍历顺序无关，保证输出稳定
+  std::unordered_map<koopa_raw_value_t, size_t> position;
+  for (size_t i = 0; i < func_->params.len; ++i) {
+    position.insert({ValueAt(func_->params, i), position.size()});
+  }
+  for (koopa_raw_basic_block_t bb : cfg_.Blocks()) {
+    for (size_t i = 0; i < bb->params.len; ++i) {
+      position.insert({ValueAt(bb->params, i), position.size()});
+    }
+    for (size_t i = 0; i < bb->insts.len; ++i) {
+      position.insert({ValueAt(bb->insts, i), position.size()});
+    }
+  }
+  std::sort(vars.begin(), vars.end(),
+            [&](koopa_raw_value_t a, koopa_raw_value_t b) {
+              return position.at(a) < position.at(b);
+            });
+
+  size_t count = K + vars.size();
+  adj_list_.assign(count, {});
+  degree_.assign(count, 0);
+  state_.assign(count, NodeState::Initial);
+  alias_.resize(count);
+  color_.assign(count, -1);
+  move_list_.assign(count, {});
+  for (int i = 0; i < static_cast<int>(count); ++i) {
+    alias_[i] = i;
+  }
+  for (int r = 0; r < K; ++r) {
+    state_[r] = NodeState::Precolored;
+    degree_[r] = kInfiniteDegree;
+    color_[r] = r;
+  }
+  for (koopa_raw_value_t value : vars) {
+    nodes_[value] = K + static_cast<int>(values_.size());
+    values_.push_back(value);
+  }
+
+  for (koopa_raw_value_t value : values_) {
+    std::vector<int> neighbors;
+    for (koopa_raw_value_t other : graph.at(value)) {
+      int n = NodeOf(other);
+      if (n >= 0) {
+        neighbors.push_back(n);
+      }
+    }
+    std::sort(neighbors.begin(), neighbors.end());
+    for (int n : neighbors) {
+      AddEdge(NodeOf(value), n);
+    }
+  }
+
+  // 调用只改写被调函数用到的调用者保存寄存器，其余的可以跨越调用
+  for (const auto &[call, live] : liveness_.CallCrossings()) {
+    ClobberSet clobbered = CallClobbers(call, clobbers_);
+    for (koopa_raw_value_t value : live) {
+      int n = NodeOf(value);
+      if (n < 0) {
+        continue;
+      }
+      for (int r = 0; r < K; ++r) {
+        if (clobbered.count(AllocatableRegs()[r])) {
+          AddEdge(n, r);
+        }
+      }
+    }
+  }
+
+  auto a_reg = [&](size_t i) {
+    auto &regs = AllocatableRegs();
+    return static_cast<int>(
+        std::find(regs.begin(), regs.end(), "a" + std::to_string(i)) -
+        regs.begin());
+  };
+  for (size_t i = 0; i < func_->params.len && i < 8; ++i) {
+    AddMove(ValueAt(func_->params, i), a_reg(i));
+  }
+  for (koopa_raw_basic_block_t bb : cfg_.Blocks()) {
+    for (size_t j = 0; j < bb->insts.len; ++j) {
+      koopa_raw_value_t inst = ValueAt(bb->insts, j);
+      const auto &kind = inst->kind;
+      if (kind.tag == KOOPA_RVT_CALL) {
+        for (size_t i = 0; i < kind.data.call.args.len && i < 8; ++i) {
+          AddMove(ValueAt(kind.data.call.args, i), a_reg(i));
+        }
+        AddMove(inst, a_reg(0));
+      } else if (kind.tag == KOOPA_RVT_RETURN && kind.data.ret.value) {
+        AddMove(kind.data.ret.value, a_reg(0));
+      } else if (kind.tag == KOOPA_RVT_BRANCH) {
+        const auto &branch = kind.data.branch;
+        for (size_t i = 0; i < branch.true_args.len; ++i) {
+          AddMove(ValueAt(branch.true_bb->params, i),
+                  ValueAt(branch.true_args, i));
+        }
+        for (size_t i = 0; i < branch.false_args.len; ++i) {
+          AddMove(ValueAt(branch.false_bb->params, i),
+                  ValueAt(branch.false_args, i));
+        }
+      } else if (kind.tag == KOOPA_RVT_JUMP) {
+        const auto &jump = kind.data.jump;
+        for (size_t i = 0; i < jump.args.len; ++i) {
+          AddMove(ValueAt(jump.target->params, i), ValueAt(jump.args, i));
+        }
+      }
+    }
+  }
+
+  ComputeSpillCosts();
+}
+
+void GraphColoringAllocator::AddEdge(int u, int v) {
+  if (u == v || Interferes(u, v)) {
+    return;
+  }
+  adj_set_.insert(EdgeKey(u, v));
+  adj_set_.insert(EdgeKey(v, u));
+  if (!IsPrecolored(u)) {
+    adj_list_[u].push_back(v);
+    ++degree_[u];
+  }
+  if (!IsPrecolored(v)) {
+    adj_list_[v].push_back(u);
+    ++degree_[v];
+  }
+}
+
+void GraphColoringAllocator::AddMove(koopa_raw_value_t value, int reg) {
+  int n = NodeOf(value);
+  if (n < 0) {
+    return;
+  }
+  int m = static_cast<int>(moves_.size());
+  moves_.push_back({n, reg});
+  move_state_.push_back(MoveState::Worklist);
+  move_list_[n].push_back(m);
+  move_list_[reg].push_back(m);
+  worklist_moves_.insert(m);
+}
+
+void GraphColoringAllocator::AddMove(koopa_raw_value_t dst,
+                                     koopa_raw_value_t src) {
+  int u = NodeOf(dst);
+  int v = NodeOf(src);
+  if (u < 0 || v < 0 || u == v) {
+    return;
+  }
+  int m = static_cast<int>(moves_.size());
+  moves_.push_back({u, v});
+  move_state_.push_back(MoveState::Worklist);
+  move_list_[u].push_back(m);
+  move_list_[v].push_back(m);
+  worklist_moves_.insert(m);
+}
+
+// 每次定义与使用按所在基本块的循环深度加权，深度每加一权重乘 10
+void GraphColoringAllocator::ComputeSpillCosts() {
+  spill_cost_.assign(K + values_.size(), 0);
+  auto add = [&](koopa_raw_value_t value, double weight) {
+    int n = NodeOf(value);
+    if (n >= 0) {
+      spill_cost_[n] += weight;
+    }
+  };
+  for (koopa_raw_basic_block_t bb : cfg_.Blocks()) {
+    double weight = std::pow(10.0, std::min(cfg_.LoopDepth(bb), 8));
+    for (size_t i = 0; i < bb->params.len; ++i) {
+      add(ValueAt(bb->params, i), weight);
+    }
+    for (size_t j = 0; j < bb->insts.len; ++j) {
+      koopa_raw_value_t inst = ValueAt(bb->insts, j);
+      add(inst, weight);
+      for (koopa_raw_value_t value : Liveness::Uses(inst)) {
+        add(value, weight);
+      }
+    }
+  }
+}
+
+void GraphColoringAllocator::SetState(int n, NodeState state) {
+  switch (state_[n]) {
+  case NodeState::Simplify:
+    simplify_worklist_.erase(n);
+    break;
+  case NodeState::Freeze:
+    freeze_worklist_.erase(n);
+    break;
+  case NodeState::Spill:
+    spill_worklist_.erase(n);
+    break;
+  default:
+    break;
+  }
+  state_[n] = state;
+  switch (state) {
+  case NodeState::Simplify:
+    simplify_worklist_.insert(n);
+    break;
+  case NodeState::Freeze:
+    freeze_worklist_.insert(n);
+    break;
+  case NodeState::Spill:
+    spill_worklist_.insert(n);
+    break;
+  default:
+    break;
+  }
+}
+
+void GraphColoringAllocator::MakeWorklist() {
+  for (int n = K; n < static_cast<int>(state_.size()); ++n) {
+    if (degree_[n] >= K) {
+      SetState(n, NodeState::Spill);
+    } else if (MoveRelated(n)) {
+      SetState(n, NodeState::Freeze);
+    } else {
+      SetState(n, NodeState::Simplify);
+    }
+  }
+}
+
+std::vector<int> GraphColoringAllocator::Adjacent(int n) const {
+  std::vector<int> nodes;
+  for (int m : adj_list_[n]) {
+    if (state_[m] != NodeState::OnStack && state_[m] != NodeState::Coalesced) {
+      nodes.push_back(m);
+    }
+  }
+  return nodes;
+}
+
+std::vector<int> GraphColoringAllocator::NodeMoves(int n) const {
+  std::vector<int> moves;
+  for (int m : move_list_[n]) {
+    if (move_state_[m] == MoveState::Worklist ||
+        move_state_[m] == MoveState::Active) {
+      moves.push_back(m);
+    }
+  }
+  return moves;
+}
+
+void GraphColoringAllocator::Simplify() {
+  int n = *simplify_worklist_.begin();
+  SetState(n, NodeState::OnStack);
+  select_stack_.push_back(n);
+  for (int m : Adjacent(n)) {
+    DecrementDegree(m);
+  }
+}
+
+void GraphColoringAllocator::DecrementDegree(int m) {
+  if (IsPrecolored(m)) {
+    return;
+  }
+  int d = degree_[m]--;
+  if (d != K) {
+    return;
+  }
+  EnableMoves(m);
+  for (int n : Adjacent(m)) {
+    EnableMoves(n);
+  }
+  if (state_[m] == NodeState::Spill) {
+    SetState(m, MoveRelated(m) ? NodeState::Freeze : NodeState::Simplify);
+  }
+}
+
+void GraphColoringAllocator::EnableMoves(int n) {
+  for (int m : NodeMoves(n)) {
+    if (move_state_[m] == MoveState::Active) {
+      active_moves_.erase(m);
+      move_state_[m] = MoveState::Worklist;
+      worklist_moves_.insert(m);
+    }
+  }
+}
+
+void GraphColoringAllocator::Coalesce() {
+  int m = *worklist_moves_.begin();
+  worklist_moves_.erase(m);
+  int x = GetAlias(moves_[m].first);
+  int y = GetAlias(moves_[m].second);
+  int u = IsPrecolored(y) ? y : x;
+  int v = IsPrecolored(y) ? x : y;
+
+  if (u == v) {
+    move_state_[m] = MoveState::Coalesced;
+    AddWorkList(u);
+  } else if (IsPrecolored(v) || Interferes(u, v)) {
+    move_state_[m] = MoveState::Constrained;
+    AddWorkList(u);
+    AddWorkList(v);
+  } else {
+    bool can_combine;
+    if (IsPrecolored(u)) {
+      // George：v 的每个邻居都与 u 冲突或是低度数节点
+      auto adjacent = Adjacent(v);
+      can_combine = std::all_of(adjacent.begin(), adjacent.end(),
+                                [&](int t) { return OK(t, u); });
+    } else {
+      // Briggs：合并后高度数邻居少于 K 个
+      auto nodes = Adjacent(u);
+      for (int t : Adjacent(v)) {
+        if (std::find(nodes.begin(), nodes.end(), t) == nodes.end()) {
+          nodes.push_back(t);
+        }
+      }
+      can_combine = Conservative(nodes);
+    }
+    if (can_combine) {
+      move_state_[m] = MoveState::Coalesced;
+      Combine(u, v);
+      AddWorkList(u);
+    } else {
+      move_state_[m] = MoveState::Active;
+      active_moves_.insert(m);
+    }
+  }
+}
+
+void GraphColoringAllocator::AddWorkList(int u) {
+  if (!IsPrecolored(u) && !MoveRelated(u) && degree_[u] < K &&
+      state_[u] == NodeState::Freeze) {
+    SetState(u, NodeState::Simplify);
+  }
+}
+
+bool GraphColoringAllocator::OK(int t, int r) const {
+  return degree_[t] < K || IsPrecolored(t) || Interferes(t, r);
+}
+
+bool GraphColoringAllocator::Conservative(const std::vector<int> &nodes) const {
+  int k = 0;
+  for (int n : nodes) {
+    if (degree_[n] >= K) {
+      ++k;
+    }
+  }
+  return k < K;
+}
+
+int GraphColoringAllocator::GetAlias(int n) const {
+  while (state_[n] == NodeState::Coalesced) {
+    n = alias_[n];
+  }
+  return n;
+}
+
+void GraphColoringAllocator::Combine(int u, int v) {
+  SetState(v, NodeState::Coalesced);
+  alias_[v] = u;
+  move_list_[u].insert(move_list_[u].end(), move_list_[v].begin(),
+                       move_list_[v].end());
+  spill_cost_[u] += spill_cost_[v];
+  EnableMoves(v);
+  for (int t : Adjacent(v)) {
+    AddEdge(t, u);
+    DecrementDegree(t);
+  }
+  if (degree_[u] >= K && state_[u] == NodeState::Freeze) {
+    SetState(u, NodeState::Spill);
+  }
+}
+
+void GraphColoringAllocator::Freeze() {
+  int u = *freeze_worklist_.begin();
+  SetState(u, NodeState::Simplify);
+  FreezeMoves(u);
+}
+
+void GraphColoringAllocator::FreezeMoves(int u) {
+  for (int m : NodeMoves(u)) {
+    int x = moves_[m].first;
+    int y = moves_[m].second;
+    int v = GetAlias(y) == GetAlias(u) ? GetAlias(x) : GetAlias(y);
+    if (move_state_[m] == MoveState::Active) {
+      active_moves_.erase(m);
+    } else {
+      worklist_moves_.erase(m);
+    }
+    move_state_[m] = MoveState::Frozen;
+    if (!IsPrecolored(v) && !MoveRelated(v) && degree_[v] < K &&
+        state_[v] == NodeState::Freeze) {
+      SetState(v, NodeState::Simplify);
+    }
+  }
+}
+
+void GraphColoringAllocator::SelectSpill() {
+  int best = -1;
+  double best_cost = 0;
+  for (int n : spill_worklist_) {
+    double cost = spill_cost_[n] / degree_[n];
+    if (best < 0 || cost < best_cost) {
+      best = n;
+      best_cost = cost;
+    }
+  }
+  SetState(best, NodeState::Simplify);
+  FreezeMoves(best);
+}
+
+/**
+ * 依次弹出选择栈着色。可选的颜色中优先使用复制另一端已经得到的颜色，
+ * 使未能合并的复制也尽量消失
+ */
+void GraphColoringAllocator::AssignColors() {
+  while (!select_stack_.empty()) {
+    int n = select_stack_.back();
+    select_stack_.pop_back();
+    std::vector<bool> ok(K, true);
+    for (int w : adj_list_[n]) {
+      int a = GetAlias(w);
+      if (state_[a] == NodeState::Colored || IsPrecolored(a)) {
+        ok[color_[a]] = false;
+      }
+    }
+
+    int color = -1;
+    for (int m : move_list_[n]) {
+      int other = GetAlias(moves_[m].first) == n ? GetAlias(moves_[m].second)
+                                                  : GetAlias(moves_[m].first);
+      if (color_[other] >= 0 && ok[color_[other]]) {
+        color = color_[other];
+        break;
+      }
+    }
+    for (int c = 0; c < K && color < 0; ++c) {
+      if (ok[c]) {
+        color = c;
+      }
+    }
+
+    if (color < 0) {
+      state_[n] = NodeState::Spilled;
+    } else {
+      state_[n] = NodeState::Colored;
+      color_[n] = color;
+    }
+  }
+
+  for (int n = K; n < static_cast<int>(state_.size()); ++n) {
+    if (state_[n] == NodeState::Coalesced) {
+      color_[n] = color_[GetAlias(n)];
+    }
+  }
+}
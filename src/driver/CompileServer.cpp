@@ -0,0 +1,270 @@
+#include "driver/CompileServer.h"
+#include "driver/Driver.h"
+#include "driver/ThreadPool.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <pthread.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+// 单帧的长度上限，防止错误的长度导致分配过大的缓冲区
+constexpr uint32_t kMaxFrameSize = 1u << 30;
+
+// 已接受的连接上单次收发的超时，不发送请求的客户端不会一直占用工作线程
+constexpr time_t kIoTimeoutSeconds = 30;
+
+// 描述符等资源耗尽时，accept 失败后等待已有的连接处理完再重试
+constexpr long kAcceptBackoffMillis = 100;
+
+volatile sig_atomic_t stop_requested = 0;
+
+void HandleStopSignal(int) { stop_requested = 1; }
+
+bool WriteAll(int fd, const char *data, size_t size) {
+  while (size > 0) {
+    // 对方提前断开时返回 EPIPE，而不是用 SIGPIPE 结束进程
+    ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    data += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+bool ReadAll(int fd, char *data, size_t size) {
+  while (size > 0) {
+    ssize_t n = recv(fd, data, size, 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    data += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+bool WriteFrame(int fd, const std::string &frame) {
+  uint32_t size = htonl(static_cast<uint32_t>(frame.size()));
+  return WriteAll(fd, reinterpret_cast<const char *>(&size), sizeof(size)) &&
+         WriteAll(fd, frame.data(), frame.size());
+}
+
+bool ReadFrame(int fd, std::string &frame) {
+  uint32_t size;
+  if (!ReadAll(fd, reinterpret_cast<char *>(&size), sizeof(size))) {
+    return false;
+  }
+  size = ntohl(size);
+  if (size > kMaxFrameSize) {
+    return false;
+  }
+  frame.resize(size);
+  return ReadAll(fd, &frame[0], size);
+}
+
+bool MakeAddress(const std::string &path, sockaddr_un &addr) {
+  if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+    std::cerr << "Error: Invalid socket path " << path << std::endl;
+    return false;
+  }
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+  return true;
+}
+
+// 只删除残留的套接字文件：socket_path 是其他文件，或者仍有服务器在监听时
+// 报错并返回 false
+bool RemoveStaleSocket(const std::string &socket_path,
+                       const sockaddr_un &addr) {
+  struct stat st;
+  if (lstat(socket_path.c_str(), &st) < 0) {
+    return errno == ENOENT;
+  }
+  if (!S_ISSOCK(st.st_mode)) {
+    std::cerr << "Error: " << socket_path << " exists and is not a socket"
+              << std::endl;
+    return false;
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return false;
+  }
+  bool live = connect(fd, reinterpret_cast<const sockaddr *>(&addr),
+                      sizeof(addr)) == 0;
+  close(fd);
+  if (live) {
+    std::cerr << "Error: A server is already listening on " << socket_path
+              << std::endl;
+    return false;
+  }
+  return unlink(socket_path.c_str()) == 0 || errno == ENOENT;
+}
+
+void SetIoTimeout(int fd) {
+  timeval timeout{kIoTimeoutSeconds, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+// 读取一个请求并编译，写回响应后关闭连接
+void HandleConnection(int fd) {
+  std::string mode, args, source;
+  if (ReadFrame(fd, mode) && ReadFrame(fd, args) && ReadFrame(fd, source)) {
+    std::vector<std::string> arg_list;
+    std::istringstream iss(args);
+    std::string arg;
+    while (std::getline(iss, arg)) {
+      if (!arg.empty()) {
+        arg_list.push_back(arg);
+      }
+    }
+
+    CompileOptions options;
+    std::ostringstream out, err;
+    bool succeeded = Driver::ParseOptions(arg_list, options, err) &&
+                     Driver::CompileSource(source, mode, options, out, err);
+    if (WriteFrame(fd, succeeded ? "ok" : "error") &&
+        WriteFrame(fd, succeeded ? out.str() : "")) {
+      WriteFrame(fd, err.str());
+    }
+  }
+  close(fd);
+}
+
+} // namespace
+
+namespace CompileServer {
+
+bool Serve(const std::string &socket_path, size_t threads) {
+  sockaddr_un addr;
+  if (!MakeAddress(socket_path, addr)) {
+    return false;
+  }
+  int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0) {
+    std::cerr << "Error: socket: " << std::strerror(errno) << std::endl;
+    return false;
+  }
+  // 上次异常退出时留下的套接字文件会导致 bind 失败
+  if (!RemoveStaleSocket(socket_path, addr)) {
+    close(listen_fd);
+    return false;
+  }
+  struct stat bound;
+  if (bind(listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+      listen(listen_fd, SOMAXCONN) < 0 ||
+      lstat(socket_path.c_str(), &bound) < 0) {
+    std::cerr << "Error: Cannot listen on " << socket_path << ": "
+              << std::strerror(errno) << std::endl;
+    close(listen_fd);
+    return false;
+  }
+
+  // 工作线程屏蔽 SIGINT 与 SIGTERM，使信号只打断主线程中的 accept
+  sigset_t stop_signals, old_mask;
+  sigemptyset(&stop_signals);
+  sigaddset(&stop_signals, SIGINT);
+  sigaddset(&stop_signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &stop_signals, &old_mask);
+  bool succeeded = true;
+  {
+    ThreadPool pool(threads);
+    pthread_sigmask(SIG_SETMASK, &old_mask, nullptr);
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = HandleStopSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    bool backing_off = false;
+    while (!stop_requested) {
+      int fd = accept(listen_fd, nullptr, nullptr);
+      if (fd < 0) {
+        if (errno == EINTR || errno == ECONNABORTED) {
+          continue;
+        }
+        if (errno != EMFILE && errno != ENFILE && errno != ENOBUFS &&
+            errno != ENOMEM) {
+          std::cerr << "Error: accept: " << std::strerror(errno) << std::endl;
+          succeeded = false;
+          break;
+        }
+        // 资源暂时耗尽：只报告一次，等待后重试而不是空转
+        if (!backing_off) {
+          std::cerr << "Error: accept: " << std::strerror(errno)
+                    << ", retrying" << std::endl;
+          backing_off = true;
+        }
+        timespec delay{0, kAcceptBackoffMillis * 1000000};
+        nanosleep(&delay, nullptr);
+        continue;
+      }
+      backing_off = false;
+      SetIoTimeout(fd);
+      pool.Submit([fd] { HandleConnection(fd); });
+    }
+    // 析构线程池前处理完已经接受的连接
+  }
+
+  close(listen_fd);
+  // 套接字文件已被替换时不删除
+  struct stat current;
+  if (lstat(socket_path.c_str(), &current) == 0 &&
+      current.st_dev == bound.st_dev && current.st_ino == bound.st_ino) {
+    unlink(socket_path.c_str());
+  }
+  return succeeded;
+}
+
+bool Request(const std::string &socket_path, const CompileRequest &request,
+             CompileResponse &response) {
+  sockaddr_un addr;
+  if (!MakeAddress(socket_path, addr)) {
+    return false;
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return false;
+  }
+  if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+    close(fd);
+    return false;
+  }
+
+  std::string args;
+  for (const std::string &arg : request.args) {
+    args += arg + "\n";
+  }
+  std::string status;
+  bool ok = WriteFrame(fd, request.mode) && WriteFrame(fd, args) &&
+            WriteFrame(fd, request.source) && ReadFrame(fd, status) &&
+            ReadFrame(fd, response.output) &&
+            ReadFrame(fd, response.diagnostics);
+  close(fd);
+  response.succeeded = status == "ok";
+  return ok;
+}
+
+} // namespace CompileServer
@@ -0,0 +1,309 @@
+#include "driver/Driver.h"
+#include "driver/MappedFile.h"
+#include "driver/ThreadPool.h"
+#include "frontend/DumpVisitor.h"
+#include "frontend/Lexer.h"
+#include "ir/IRGenVisitor.h"
+#include "ir/IRSerializer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// 声明可重入 lexer 的创建、输入缓冲区与销毁函数, 以及 parser 函数
+// 为什么不引用 sysy.tab.hpp 呢? 因为首先里面没有 scanner 相关函数的定义
+// 其次, 因为这个文件不是我们自己写的, 而是被 Bison 生成出来的
+// 你的代码编辑器/IDE 很可能找不到这个文件, 然后会给你报错 (虽然编译不会出错)
+// 看起来会很烦人, 于是干脆采用这种看起来 dirty 但实际很有效的手段
+extern int yylex_init_extra(std::ostream *err, yyscan_t *scanner);
+extern int yylex_destroy(yyscan_t scanner);
+struct yy_buffer_state;
+extern yy_buffer_state *yy_scan_buffer(char *base, size_t size,
+                                       yyscan_t scanner);
+extern yy_buffer_state *yy_scan_bytes(const char *bytes, int len,
+                                      yyscan_t scanner);
+extern int yyparse(LexerHandle lexer, std::unique_ptr<BaseAST> &ast);
+
+namespace {
+
+// 整条消息一次写出，多个线程同时报错时不会交错
+void ReportError(const std::string &message) {
+  std::cerr << message + "\n";
+}
+
+// 解析 -<name>=<n> 形式的数值选项，值不合法时报错并返回 false
+bool ParseUnsignedOption(const std::string &arg, size_t &value,
+                         std::ostream &err) {
+  size_t eq = arg.find('=');
+  if (!Driver::ParseUnsigned(std::string_view(arg).substr(eq + 1), value)) {
+    err << "Error: Invalid value for " << arg.substr(0, eq) << "\n";
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<BaseAST> RunParser(LexerHandle lexer) {
+  std::unique_ptr<BaseAST> ast;
+  if (yyparse(lexer, ast) != 0) {
+    return nullptr;
+  }
+  return ast;
+}
+
+// 手写的 Lexer 只读取输入，两种输入都直接在原处扫描
+std::unique_ptr<BaseAST> ParseWithLexer(const char *source, size_t size,
+                                        std::ostream &err) {
+  Lexer lexer(source, size, err);
+  return RunParser({nullptr, &lexer});
+}
+
+// AST -> Koopa IR，优化后按 mode 输出 IR 文本或 RISC-V 汇编
+bool Generate(BaseAST &ast, const std::string &mode,
+              const CompileOptions &options, std::ostream &out,
+              std::ostream &err) {
+  // 没有转储时 dump 为空，各阶段只多一次判空
+  std::ofstream dump_file;
+  std::ostream *dump = nullptr;
+  if (options.DumpEnabled()) {
+    dump = &err;
+    if (!options.dump.file.empty()) {
+      dump_file.open(options.dump.file);
+      if (!dump_file) {
+        err << "Error: Cannot open file " << options.dump.file << "\n";
+        return false;
+      }
+      dump = &dump_file;
+    }
+  }
+
+  if (options.dump.ast) {
+    DumpVisitor dumper(*dump);
+    ast.Accept(dumper);
+  }
+
+  try {
+    IRGenVisitor irgen;
+    ast.Accept(irgen);
+
+    PassManager pm(err, dump);
+    if (!pm.BuildPipeline(options.pass_options)) {
+      return false;
+    }
+    pm.Run(irgen.GetModule());
+
+    if (mode == "-koopa") {
+      out << IRSerializer::ToIR(irgen.GetModule());
+    } else {
+      IRSerializer::RawProgram program =
+          IRSerializer::ToProgram(irgen.GetModule());
+      ProgramCodeGen codegen(out, options.regalloc,
+                             options.dump.mir ? dump : nullptr);
+      codegen.Emit(program.Get());
+    }
+  } catch (const std::exception &e) {
+    err << e.what() << "\n";
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+namespace Driver {
+
+bool ParseUnsigned(std::string_view text, size_t &value) {
+  const char *end = text.data() + text.size();
+  auto [ptr, ec] = std::from_chars(text.data(), end, value);
+  return ec == std::errc() && ptr == end;
+}
+
+bool ParseOptions(const std::vector<std::string> &args,
+                  CompileOptions &options, std::ostream &err) {
+  PassOptions &pass_options = options.pass_options;
+  std::string regalloc;
+  for (const std::string &arg : args) {
+    if (arg == "-O0" || arg == "-O1" || arg == "-O2") {
+      pass_options.opt_level = arg[2] - '0';
+    } else if (arg.rfind("-passes=", 0) == 0) {
+      pass_options.passes = arg.substr(8);
+    } else if (arg == "-time-passes") {
+      pass_options.time_passes = true;
+    } else if (arg.rfind("-ifcvt-threshold=", 0) == 0) {
+      if (!ParseUnsignedOption(arg, pass_options.ifcvt_threshold, err)) {
+        return false;
+      }
+    } else if (arg.rfind("-inline-threshold=", 0) == 0) {
+      if (!ParseUnsignedOption(arg, pass_options.inline_threshold, err)) {
+        return false;
+      }
+    } else if (arg.rfind("-unroll-factor=", 0) == 0) {
+      if (!ParseUnsignedOption(arg, pass_options.unroll_factor, err)) {
+        return false;
+      }
+    } else if (arg.rfind("-unswitch-threshold=", 0) == 0) {
+      if (!ParseUnsignedOption(arg, pass_options.unswitch_threshold, err)) {
+        return false;
+      }
+    } else if (arg == "-pass-remarks") {
+      pass_options.pass_remarks = true;
+    } else if (arg == "-regalloc=stack" || arg == "-regalloc=graph") {
+      regalloc = arg.substr(10);
+    } else if (arg == "-dump-ast") {
+      options.dump.ast = true;
+    } else if (arg.rfind("-dump-ir=after:", 0) == 0 && arg.size() > 15) {
+      pass_options.dump_ir_after.push_back(arg.substr(15));
+    } else if (arg == "-dump-mir") {
+      options.dump.mir = true;
+    } else if (arg.rfind("-dump-file=", 0) == 0) {
+      options.dump.file = arg.substr(11);
+    } else if (arg == "-lexer=flex") {
+      options.lexer = LexerKind::Flex;
+    } else if (arg == "-lexer=hand") {
+      options.lexer = LexerKind::Hand;
+    } else {
+      err << "Error: Unknown option " << arg << "\n";
+      return false;
+    }
+  }
+
+  if (regalloc.empty()) {
+    regalloc = pass_options.opt_level >= 2 ? "graph" : "stack";
+  }
+  options.regalloc =
+      regalloc == "graph" ? RegAllocKind::Graph : RegAllocKind::Stack;
+  return true;
+}
+
+std::unique_ptr<BaseAST> Parse(char *buffer, size_t size, LexerKind lexer,
+                               std::ostream &err) {
+  if (lexer == LexerKind::Hand) {
+    return ParseWithLexer(buffer, size, err);
+  }
+  yyscan_t scanner;
+  if (yylex_init_extra(&err, &scanner) != 0) {
+    return nullptr;
+  }
+  // 缓冲区仍归调用者所有，yylex_destroy 不会释放它
+  yy_scan_buffer(buffer, size + 2, scanner);
+  std::unique_ptr<BaseAST> ast = RunParser({scanner, nullptr});
+  yylex_destroy(scanner);
+  return ast;
+}
+
+std::unique_ptr<BaseAST> Parse(std::string_view source, LexerKind lexer,
+                               std::ostream &err) {
+  if (lexer == LexerKind::Hand) {
+    return ParseWithLexer(source.data(), source.size(), err);
+  }
+  yyscan_t scanner;
+  if (yylex_init_extra(&err, &scanner) != 0) {
+    return nullptr;
+  }
+  // 缓冲区由 scanner 持有，随 yylex_destroy 释放
+  yy_scan_bytes(source.data(), static_cast<int>(source.size()), scanner);
+  std::unique_ptr<BaseAST> ast = RunParser({scanner, nullptr});
+  yylex_destroy(scanner);
+  return ast;
+}
+
+bool CompileSource(std::string_view source, const std::string &mode,
+                   const CompileOptions &options, std::ostream &out,
+                   std::ostream &err) {
+  if (mode != "-koopa" && mode != "-riscv") {
+    err << "Error: Unsupported mode " << mode << "\n";
+    return false;
+  }
+  // 服务器与库的调用者不应能让编译器写任意文件，转储一律写入 err
+  if (!options.dump.file.empty()) {
+    err << "Error: -dump-file= is only supported on the command line\n";
+    return false;
+  }
+  std::unique_ptr<BaseAST> ast = Parse(source, options.lexer, err);
+  return ast && Generate(*ast, mode, options, out, err);
+}
+
+bool Compile(const CompileJob &job, const CompileOptions &options) {
+  if (job.mode != "-koopa" && job.mode != "-riscv") {
+    ReportError("Error: Unsupported mode " + job.mode);
+    return false;
+  }
+
+  MappedFile source;
+  if (!source.Open(job.input)) {
+    ReportError("Error: Cannot open file " + job.input);
+    return false;
+  }
+  // 诊断信息先写入缓冲区，多个线程同时编译时整段输出
+  std::ostringstream out, err;
+  std::unique_ptr<BaseAST> ast =
+      Parse(source.Data(), source.Size(), options.lexer, err);
+  bool succeeded = ast && Generate(*ast, job.mode, options, out, err);
+  std::cerr << err.str();
+  if (!succeeded) {
+    ReportError("Error: Failed to compile " + job.input);
+    return false;
+  }
+
+  // 生成成功后才写输出文件，失败时不留下不完整的结果
+  std::ofstream file(job.output);
+  if (!(file << out.str())) {
+    ReportError("Error: Cannot write file " + job.output);
+    return false;
+  }
+  return true;
+}
+
+bool ReadJobList(const std::string &path, std::vector<CompileJob> &jobs) {
+  std::ifstream list(path);
+  if (!list) {
+    ReportError("Error: Cannot open file " + path);
+    return false;
+  }
+
+  std::string line;
+  size_t line_no = 0;
+  while (std::getline(list, line)) {
+    ++line_no;
+    std::istringstream iss(line);
+    CompileJob job;
+    std::string flag, rest;
+    if (!(iss >> job.mode) || job.mode[0] == '#') {
+      continue;
+    }
+    if (!(iss >> job.input >> flag >> job.output) || flag != "-o" ||
+        (iss >> rest)) {
+      ReportError(path + ":" + std::to_string(line_no) +
+                  ": Error: Expected <mode> <input> -o <output>");
+      return false;
+    }
+    jobs.push_back(std::move(job));
+  }
+  return true;
+}
+
+size_t CompileBatch(const std::vector<CompileJob> &jobs,
+                    const CompileOptions &options, size_t threads) {
+  // 流水线有误时每个任务都会失败，先检查一次
+  PassManager pm;
+  if (!pm.BuildPipeline(options.pass_options)) {
+    return jobs.size();
+  }
+
+  std::atomic<size_t> failures{0};
+  ThreadPool pool(std::min(threads, std::max<size_t>(jobs.size(), 1)));
+  for (const CompileJob &job : jobs) {
+    pool.Submit([&job, &options, &failures] {
+      if (!Compile(job, options)) {
+        ++failures;
+      }
+    });
+  }
+  pool.Wait();
+  return failures;
+}
+
+} // namespace Driver
@@ -0,0 +1,64 @@
+#include "driver/MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::~MappedFile() {
+  if (mapped_size_ > 0) {
+    munmap(data_, mapped_size_);
+  }
+}
+
+bool MappedFile::Open(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    close(fd);
+    return false;
+  }
+
+  if (!S_ISREG(st.st_mode)) {
+    char chunk[65536];
+    ssize_t n;
+    while ((n = read(fd, chunk, sizeof(chunk))) > 0) {
+      fallback_.insert(fallback_.end(), chunk, chunk + n);
+    }
+    close(fd);
+    if (n < 0) {
+      return false;
+    }
+    size_ = fallback_.size();
+    fallback_.resize(size_ + 2, '\0');
+    data_ = fallback_.data();
+    return true;
+  }
+
+  // 先占住足够长的匿名映射，再把文件映射到它的开头：
+  // 文件最后一页中超出文件长度的部分由内核填 0，文件长度恰为整页时
+  // 末尾的 '\0' 落在其后的匿名页中
+  size_ = static_cast<size_t>(st.st_size);
+  size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t length = (size_ + 2 + page - 1) / page * page;
+  void *base = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    close(fd);
+    return false;
+  }
+  if (size_ > 0 && mmap(base, size_, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+    munmap(base, length);
+    close(fd);
+    return false;
+  }
+  close(fd);
+
+  data_ = static_cast<char *>(base);
+  mapped_size_ = length;
+  return true;
+}
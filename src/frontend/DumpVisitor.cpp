@@ -4,18 +4,6 @@
 
 #include "frontend/AST.h"
 
-DumpVisitor::DumpVisitor(const std::string &filename) : out_file(filename) {
-  if (!out_file.is_open()) {
-    std::cerr << "Error: Cannot open file " << filename << std::endl;
-  }
-}
-
-DumpVisitor::~DumpVisitor() {
-  if (out_file.is_open()) {
-    out_file.close();
-  }
-}
-
 // 用于缩进
 struct IndentGuard {
   int &indent;
@@ -25,28 +13,38 @@ struct IndentGuard {
 
 void DumpVisitor::print_indent() const {
   for (int i = 0; i < indent_level; ++i)
-    out_file << "  ";
+    out_stream << "  ";
 }
 
 void DumpVisitor::print_node(const std::string &name) {
   print_indent();
-  out_file << name << std::endl;
+  out_stream << name << std::endl;
 }
 
 void DumpVisitor::Visit(CompUnitAST &node) {
   print_node("CompUnitAST");
   IndentGuard _{indent_level};
-  if (node.func_def)
-    node.func_def->Accept(*this);
+  for (auto &func_def : node.func_defs) {
+    if (func_def)
+      func_def->Accept(*this);
+  }
+}
+
+void DumpVisitor::Visit(FuncFParamAST &node) {
+  print_indent();
+  out_stream << "FuncFParamAST " << node.btype << " " << node.ident
+           << std::endl;
 }
 
 void DumpVisitor::Visit(FuncDefAST &node) {
   print_node("FuncDefAST");
   IndentGuard _{indent_level};
   print_indent();
-  out_file << "RetType: " << node.ret_type << std::endl;
+  out_stream << "RetType: " << node.ret_type << std::endl;
   print_indent();
-  out_file << "Ident: " << node.ident << std::endl;
+  out_stream << "Ident: " << node.ident << std::endl;
+  for (auto &param : node.params)
+    param->Accept(*this);
   if (node.block)
     node.block->Accept(*this);
 }
@@ -64,7 +62,7 @@ void DumpVisitor::Visit(ConstDeclAST &node) {
   print_node("ConstDeclAST");
   IndentGuard _{indent_level};
   print_indent();
-  out_file << "BType: " << node.btype << std::endl;
+  out_stream << "BType: " << node.btype << std::endl;
   for (auto &def : node.const_defs) {
     if (def)
       def->Accept(*this);
@@ -75,7 +73,7 @@ void DumpVisitor::Visit(ConstDefAST &node) {
   print_node("ConstDefAST");
   IndentGuard _{indent_level};
   print_indent();
-  out_file << "Ident: " << node.ident << std::endl;
+  out_stream << "Ident: " << node.ident << std::endl;
   if (node.init_val)
     node.init_val->Accept(*this);
 }
@@ -84,7 +82,7 @@ void DumpVisitor::Visit(VarDeclAST &node) {
   print_node("VarDeclAST");
   IndentGuard _{indent_level};
   print_indent();
-  out_file << "BType: " << node.btype << std::endl;
+  out_stream << "BType: " << node.btype << std::endl;
   for (auto &def : node.var_defs) {
     if (def)
       def->Accept(*this);
@@ -95,7 +93,7 @@ void DumpVisitor::Visit(VarDefAST &node) {
   print_node("VarDefAST");
   IndentGuard _{indent_level};
   print_indent();
-  out_file << "Ident: " << node.ident << std::endl;
+  out_stream << "Ident: " << node.ident << std::endl;
   if (node.init_val)
     node.init_val->Accept(*this);
 }
@@ -144,19 +142,30 @@ void DumpVisitor::Visit(ReturnStmtAST &node) {
 
 void DumpVisitor::Visit(LValAST &node) {
   print_indent();
-  out_file << "LValAST Ident: " << node.ident << std::endl;
+  out_stream << "LValAST Ident: " << node.ident << std::endl;
 }
 
 void DumpVisitor::Visit(NumberAST &node) {
   print_indent();
-  out_file << "NumberAST Val: " << node.val << std::endl;
+  out_stream << "NumberAST Val: " << node.val << std::endl;
+}
+
+void DumpVisitor::Visit(CallExpAST &node) {
+  print_node("CallExpAST");
+  IndentGuard _{indent_level};
+  print_indent();
+  out_stream << "Ident: " << node.ident << std::endl;
+  for (auto &arg : node.args) {
+    if (arg)
+      arg->Accept(*this);
+  }
 }
 
 void DumpVisitor::Visit(UnaryExpAST &node) {
   print_node("UnaryExpAST");
   IndentGuard _{indent_level};
   print_indent();
-  out_file << "Op: " << node.op << std::endl;
+  out_stream << "Op: " << node.op << std::endl;
   if (node.exp)
     node.exp->Accept(*this);
 }
@@ -165,7 +174,7 @@ void DumpVisitor::Visit(BinaryExpAST &node) {
   print_node("BinaryExpAST");
   IndentGuard _{indent_level};
   print_indent();
-  out_file << "Op: " << node.op << std::endl;
+  out_stream << "Op: " << node.op << std::endl;
   if (node.lhs)
     node.lhs->Accept(*this);
   if (node.rhs)
@@ -0,0 +1,331 @@
+#include "frontend/Lexer.h"
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "frontend/AST.h"
+#include "parser.tab.hpp"
+
+namespace {
+
+// 关键字的完美哈希：首字符与长度即可区分全部关键字
+constexpr size_t kKeywordTableSize = 16;
+
+constexpr size_t KeywordHash(unsigned char first, size_t len) {
+  return (first * 2 + len) & (kKeywordTableSize - 1);
+}
+
+struct Keyword {
+  const char *text;
+  size_t len;
+  int token;
+};
+
+constexpr std::array<Keyword, 7> kKeywords = {{
+    {"const", 5, CONST},
+    {"int", 3, INT},
+    {"void", 4, VOID},
+    {"return", 6, RETURN},
+    {"if", 2, IF},
+    {"else", 4, ELSE},
+    {"while", 5, WHILE},
+}};
+
+constexpr size_t kMaxKeywordLen = 6;
+
+constexpr std::array<Keyword, kKeywordTableSize> BuildKeywordTable() {
+  std::array<Keyword, kKeywordTableSize> table{};
+  for (const Keyword &keyword : kKeywords) {
+    table[KeywordHash(keyword.text[0], keyword.len)] = keyword;
+  }
+  return table;
+}
+
+constexpr bool IsPerfectHash() {
+  for (size_t i = 0; i < kKeywords.size(); ++i) {
+    for (size_t j = i + 1; j < kKeywords.size(); ++j) {
+      if (KeywordHash(kKeywords[i].text[0], kKeywords[i].len) ==
+          KeywordHash(kKeywords[j].text[0], kKeywords[j].len)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static_assert(IsPerfectHash(), "keyword hash has collisions");
+
+constexpr std::array<Keyword, kKeywordTableSize> kKeywordTable =
+    BuildKeywordTable();
+
+// 是关键字时返回其 token，否则返回 IDENT
+int LookupKeyword(const char *text, size_t len) {
+  if (len > kMaxKeywordLen) {
+    return IDENT;
+  }
+  const Keyword &keyword =
+      kKeywordTable[KeywordHash(static_cast<unsigned char>(text[0]), len)];
+  if (keyword.len == len && std::memcmp(keyword.text, text, len) == 0) {
+    return keyword.token;
+  }
+  return IDENT;
+}
+
+bool IsWhitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool IsIdentStart(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+bool IsIdentChar(char c) { return IsIdentStart(c) || (c >= '0' && c <= '9'); }
+
+int DigitValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+    return (c | 0x20) - 'a' + 10;
+  }
+  return 16;
+}
+
+/*
+ * 按块检查字节的向量操作。掩码的第 i 位对应块中的第 i 个字节；
+ * 比较按有符号字节进行，非 ASCII 字节为负数，不会落入任何 ASCII 区间
+ */
+#if defined(__AVX2__)
+#define LEXER_SIMD 1
+constexpr size_t kBlock = 32;
+using Vec = __m256i;
+inline Vec Load(const char *p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+inline Vec Splat(char c) { return _mm256_set1_epi8(c); }
+inline Vec Eq(Vec a, Vec b) { return _mm256_cmpeq_epi8(a, b); }
+inline Vec Gt(Vec a, Vec b) { return _mm256_cmpgt_epi8(a, b); }
+inline Vec Or(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+inline Vec And(Vec a, Vec b) { return _mm256_and_si256(a, b); }
+inline uint32_t Mask(Vec v) {
+  return static_cast<uint32_t>(_mm256_movemask_epi8(v));
+}
+constexpr uint32_t kFullMask = 0xFFFFFFFFu;
+#elif defined(__SSE2__)
+#define LEXER_SIMD 1
+constexpr size_t kBlock = 16;
+using Vec = __m128i;
+inline Vec Load(const char *p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+inline Vec Splat(char c) { return _mm_set1_epi8(c); }
+inline Vec Eq(Vec a, Vec b) { return _mm_cmpeq_epi8(a, b); }
+inline Vec Gt(Vec a, Vec b) { return _mm_cmpgt_epi8(a, b); }
+inline Vec Or(Vec a, Vec b) { return _mm_or_si128(a, b); }
+inline Vec And(Vec a, Vec b) { return _mm_and_si128(a, b); }
+inline uint32_t Mask(Vec v) {
+  return static_cast<uint32_t>(_mm_movemask_epi8(v));
+}
+constexpr uint32_t kFullMask = 0xFFFFu;
+#endif
+
+#ifdef LEXER_SIMD
+// c 在 [lo, hi] 中的字节
+inline Vec InRange(Vec v, char lo, char hi) {
+  return And(Gt(v, Splat(static_cast<char>(lo - 1))),
+             Gt(Splat(static_cast<char>(hi + 1)), v));
+}
+
+inline Vec WhitespaceBytes(Vec v) {
+  return Or(Or(Eq(v, Splat(' ')), Eq(v, Splat('\t'))),
+            Or(Eq(v, Splat('\n')), Eq(v, Splat('\r'))));
+}
+
+// 字母统一转成小写后判断范围，再并上数字与下划线
+inline Vec IdentBytes(Vec v) {
+  Vec lower = Or(v, Splat(0x20));
+  return Or(Or(InRange(lower, 'a', 'z'), InRange(v, '0', '9')),
+            Eq(v, Splat('_')));
+}
+#endif
+
+/*
+ * 空白与标识符多数只有几个字节，先逐字节检查 kScalarPrefix 个字节，
+ * 仍未结束时才按块扫描，避免短的片段也付出一次向量比较的代价
+ */
+constexpr ptrdiff_t kScalarPrefix = 8;
+
+// 跳过空白 [ \t\n\r]，返回第一个非空白字符的位置
+const char *SkipWhitespace(const char *p, const char *end) {
+  for (const char *stop = p + std::min(end - p, kScalarPrefix); p < stop;
+       ++p) {
+    if (!IsWhitespace(*p)) {
+      return p;
+    }
+  }
+#ifdef LEXER_SIMD
+  while (static_cast<size_t>(end - p) >= kBlock) {
+    uint32_t mask = ~Mask(WhitespaceBytes(Load(p))) & kFullMask;
+    if (mask) {
+      return p + __builtin_ctz(mask);
+    }
+    p += kBlock;
+  }
+#endif
+  while (p < end && IsWhitespace(*p)) {
+    ++p;
+  }
+  return p;
+}
+
+// 跳过标识符的剩余字符 [a-zA-Z0-9_]
+const char *ScanIdentifier(const char *p, const char *end) {
+  for (const char *stop = p + std::min(end - p, kScalarPrefix); p < stop;
+       ++p) {
+    if (!IsIdentChar(*p)) {
+      return p;
+    }
+  }
+#ifdef LEXER_SIMD
+  while (static_cast<size_t>(end - p) >= kBlock) {
+    uint32_t mask = ~Mask(IdentBytes(Load(p))) & kFullMask;
+    if (mask) {
+      return p + __builtin_ctz(mask);
+    }
+    p += kBlock;
+  }
+#endif
+  while (p < end && IsIdentChar(*p)) {
+    ++p;
+  }
+  return p;
+}
+
+// 返回块注释结束符 "*/" 的位置，没有时返回 end
+const char *FindCommentEnd(const char *p, const char *end) {
+#ifdef LEXER_SIMD
+  // 同时比较 p[i] == '*' 与 p[i + 1] == '/'
+  while (static_cast<size_t>(end - p) > kBlock) {
+    uint32_t mask =
+        Mask(And(Eq(Load(p), Splat('*')), Eq(Load(p + 1), Splat('/'))));
+    if (mask) {
+      return p + __builtin_ctz(mask);
+    }
+    p += kBlock;
+  }
+#endif
+  for (; p + 1 < end; ++p) {
+    if (p[0] == '*' && p[1] == '/') {
+      return p;
+    }
+  }
+  return end;
+}
+
+} // namespace
+
+int Lexer::Next(YYSTYPE *lval) {
+  // 空白与注释
+  while (true) {
+    cur_ = SkipWhitespace(cur_, end_);
+    if (cur_ == end_) {
+      return 0;
+    }
+    if (cur_[0] != '/' || end_ - cur_ < 2) {
+      break;
+    }
+    if (cur_[1] == '/') {
+      const void *newline = std::memchr(cur_, '\n', end_ - cur_);
+      cur_ = newline ? static_cast<const char *>(newline) : end_;
+    } else if (cur_[1] == '*') {
+      const char *close = FindCommentEnd(cur_ + 2, end_);
+      if (close == end_) {
+        // 与 lexer.l 相同，返回 YYerror 让 parser 以失败结束
+        err_ << "error: unterminated block comment" << std::endl;
+        cur_ = end_;
+        return YYerror;
+      }
+      cur_ = close + 2;
+    } else {
+      break;
+    }
+  }
+
+  const char *start = cur_;
+  char c = *cur_;
+
+  // 标识符与关键字
+  if (IsIdentStart(c)) {
+    cur_ = ScanIdentifier(cur_ + 1, end_);
+    size_t len = static_cast<size_t>(cur_ - start);
+    int token = LookupKeyword(start, len);
+    if (token == IDENT) {
+      lval->ident_val = {start, static_cast<int>(len)};
+    }
+    return token;
+  }
+
+  // 整数字面量：十进制 [1-9][0-9]*、八进制 0[0-7]*、十六进制 0[xX][0-9a-fA-F]+，
+  // 与 strtol 一样在超出 long 时取 LONG_MAX，再截断为 int
+  if (c >= '0' && c <= '9') {
+    int base = 10;
+    if (c == '0') {
+      base = 8;
+      ++cur_;
+      if (end_ - cur_ >= 2 && (cur_[0] | 0x20) == 'x' &&
+          DigitValue(cur_[1]) < 16) {
+        base = 16;
+        ++cur_;
+      }
+    }
+    uint64_t value = 0;
+    bool overflow = false;
+    for (; cur_ < end_; ++cur_) {
+      int digit = DigitValue(*cur_);
+      if (digit >= base) {
+        break;
+      }
+      if (value > (static_cast<uint64_t>(LONG_MAX) - digit) / base) {
+        overflow = true;
+      } else {
+        value = value * base + digit;
+      }
+    }
+    long result = overflow ? LONG_MAX : static_cast<long>(value);
+    lval->int_val = static_cast<int>(result);
+    return INT_CONST;
+  }
+
+  // 运算符与标点
+  ++cur_;
+  char next = cur_ < end_ ? *cur_ : '\0';
+  int token = 0;
+  if (c == '<' && next == '=') {
+    token = LE;
+  } else if (c == '>' && next == '=') {
+    token = GE;
+  } else if (c == '=' && next == '=') {
+    token = EQ;
+  } else if (c == '!' && next == '=') {
+    token = NE;
+  } else if (c == '&' && next == '&') {
+    token = AND;
+  } else if (c == '|' && next == '|') {
+    token = OR;
+  }
+  if (token != 0) {
+    ++cur_;
+    return token;
+  }
+  return c;
+}
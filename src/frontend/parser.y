@@ -1,7 +1,29 @@
 %code requires {
   #include <memory>
+  #include <ostream>
   #include <string>
   #include "frontend/AST.h"
+
+  // 标识符在源程序缓冲区中的位置, 不必为每个标识符分配字符串
+  // 整个源程序在解析期间都留在同一个缓冲区中, 因此 text 一直有效
+  struct IdentToken {
+    const char *text;
+    int len;
+  };
+
+  // 词法分析器的句柄: Flex 的 scanner 或手写的 Lexer
+  #include "frontend/Lexer.h"
+}
+
+%code provides {
+  // 声明 lexer 函数和错误处理函数
+  // yylval 由 parser 传入, scanner 的状态都保存在 scanner 中
+  // 第一个 yylex 由 Flex 生成, 第二个按 lexer 选择 Flex 或手写的 Lexer
+  int yylex(YYSTYPE *yylval_param, yyscan_t yyscanner);
+  int yylex(YYSTYPE *yylval_param, LexerHandle lexer);
+  void yyerror(LexerHandle lexer, std::unique_ptr<BaseAST> &ast, const char *s);
+  // 取出 scanner 中保存的错误输出流, 由 Flex 生成
+  std::ostream *yyget_extra(yyscan_t yyscanner);
 }
 
 %{
@@ -11,26 +33,29 @@
 #include <string>
 #include "frontend/AST.h"
 
-// 声明 lexer 函数和错误处理函数
-int yylex();
-void yyerror(std::unique_ptr<BaseAST> &ast, const char *s);
-
 using namespace std;
 
 %}
 
+// 生成可重入的 parser: yylval 等状态都在 yyparse 的局部变量中,
+// 不同线程可以同时解析不同的文件
+%define api.pure full
+
 // 定义 parser 函数和错误处理函数的附加参数
+// lexer 为本次解析使用的词法分析器, 同时传给 yylex
 // 我们需要返回一个字符串作为 AST, 所以我们把附加参数定义成字符串的智能指针
 // 解析完成后, 我们要手动修改这个参数, 把它设置成解析得到的字符串
-%parse-param { std::unique_ptr<BaseAST> &ast }
+%lex-param { LexerHandle lexer }
+%parse-param { LexerHandle lexer } { std::unique_ptr<BaseAST> &ast }
 
 // yylval 的定义, 我们把它定义成了一个联合体 (union)
 // 因为 token 的值有的是字符串指针, 有的是整数
-// 之前我们在 lexer 中用到的 str_val 和 int_val 就是在这里被定义的
+// 之前我们在 lexer 中用到的 ident_val 和 int_val 就是在这里被定义的
 // 至于为什么要用字符串指针而不直接用 string 或者 unique_ptr<string>?
 // 请自行 STFW 在 union 里写一个带析构函数的类会出现什么情况
 %union {
   std::string *str_val;
+  IdentToken ident_val;
   int int_val;
   BaseAST *ast_val;
   std::vector<std::unique_ptr<BaseAST>> *ast_list;
@@ -38,9 +63,9 @@ using namespace std;
 
 // lexer 返回的所有 token 种类的声明
 /* 关键字 */
-%token INT RETURN CONST IF ELSE WHILE
+%token INT VOID RETURN CONST IF ELSE WHILE
 /* 标识符与数值 */
-%token <str_val> IDENT
+%token <ident_val> IDENT
 %token <int_val> INT_CONST
 /* 运算符与标点 */
 %token LE GE EQ NE  /* <=, >=, ==, != */
@@ -48,23 +73,40 @@ using namespace std;
 
 // 非终结符的类型定义
 %type <ast_val> Decl ConstDecl VarDecl ConstDef VarDef ConstInitVal InitVal
-%type <ast_val> FuncDef Block BlockItem Stmt MatchedStmt UnMatchedStmt
+%type <ast_val> FuncDef FuncFParam Block BlockItem Stmt MatchedStmt UnMatchedStmt
 %type <ast_val> Exp LVal PrimaryExp Number UnaryExp
 %type <ast_val> MulExp AddExp RelExp EqExp LAndExp LOrExp ConstExp
 %type <str_val> BType FuncType UnaryOp
 %type <ast_list> ConstDefList VarDefList BlockItemList
+%type <ast_list> FuncDefList FuncFParams FuncRParams
+
+// 语法错误时 Bison 丢弃栈上已经构造出的值, 由这里释放
+// 批量编译、编译服务器与 libsysy 在同一进程中解析很多文件, 不能泄漏
+%destructor { delete $$; } <ast_val> <ast_list> <str_val>
 
 %%
 
-// CompUnit ::= FuncDef
+// CompUnit ::= FuncDef {FuncDef}
 CompUnit
-  : FuncDef {
+  : FuncDefList {
     auto comp_unit = make_unique<CompUnitAST>();
-    comp_unit->func_def = unique_ptr<BaseAST>($1);
+    comp_unit->func_defs = std::move(*$1);
+    delete $1;
     ast = std::move(comp_unit);
   }
   ;
 
+FuncDefList
+  : FuncDef {
+    $$ = new vector<unique_ptr<BaseAST>>();
+    $$->push_back(unique_ptr<BaseAST>($1));
+  }
+  | FuncDefList FuncDef {
+    $1->push_back(unique_ptr<BaseAST>($2));
+    $$ = $1;
+  }
+  ;
+
 // BType ::= "int"
 BType
   : INT {
@@ -104,7 +146,7 @@ ConstDefList
 ConstDef
   : IDENT '=' ConstInitVal {
     auto ast = new ConstDefAST();
-    ast->ident = *unique_ptr<string>($1);
+    ast->ident.assign($1.text, $1.len);
     ast->init_val = unique_ptr<BaseAST>($3);
     $$ = ast;
   }
@@ -141,13 +183,13 @@ VarDefList
 VarDef
   : IDENT {
     auto ast = new VarDefAST();
-    ast->ident = *unique_ptr<string>($1);
+    ast->ident.assign($1.text, $1.len);
     ast->init_val = nullptr;
     $$ = ast;
   }
   | IDENT '=' InitVal {
     auto ast = new VarDefAST();
-    ast->ident = *unique_ptr<string>($1);
+    ast->ident.assign($1.text, $1.len);
     ast->init_val = unique_ptr<BaseAST>($3);
     $$ = ast;
   }
@@ -158,24 +200,60 @@ InitVal
   : Exp { $$ = $1; }
   ;
 
-// FuncDef ::= FuncType IDENT "(" ")" Block
+// FuncDef ::= FuncType IDENT "(" [FuncFParams] ")" Block
 FuncDef
   : FuncType IDENT '(' ')' Block {
     auto ast = new FuncDefAST();
     ast->ret_type = *unique_ptr<string>($1);
-    ast->ident = *unique_ptr<string>($2);
+    ast->ident.assign($2.text, $2.len);
     ast->block = unique_ptr<BaseAST>($5);
     $$ = ast;
   }
+  | FuncType IDENT '(' FuncFParams ')' Block {
+    auto ast = new FuncDefAST();
+    ast->ret_type = *unique_ptr<string>($1);
+    ast->ident.assign($2.text, $2.len);
+    for (auto &param : *$4) {
+      ast->params.emplace_back(static_cast<FuncFParamAST*>(param.release()));
+    }
+    delete $4;
+    ast->block = unique_ptr<BaseAST>($6);
+    $$ = ast;
+  }
   ;
 
-// FuncType ::= "int"
+// FuncType ::= "void" | "int"
 FuncType
-  : INT {
+  : VOID {
+    $$ = new string("void");
+  }
+  | INT {
     $$ = new string("int");
   }
   ;
 
+// FuncFParams ::= FuncFParam {"," FuncFParam}
+FuncFParams
+  : FuncFParam {
+    $$ = new vector<unique_ptr<BaseAST>>();
+    $$->push_back(unique_ptr<BaseAST>($1));
+  }
+  | FuncFParams ',' FuncFParam {
+    $1->push_back(unique_ptr<BaseAST>($3));
+    $$ = $1;
+  }
+  ;
+
+// FuncFParam ::= BType IDENT
+FuncFParam
+  : BType IDENT {
+    auto ast = new FuncFParamAST();
+    ast->btype = *unique_ptr<string>($1);
+    ast->ident.assign($2.text, $2.len);
+    $$ = ast;
+  }
+  ;
+
 // Block ::= "{" {BlockItem} "}"
 Block
   : '{' BlockItemList '}' {
@@ -295,7 +373,7 @@ PrimaryExp
 LVal
   : IDENT {
     auto ast = new LValAST();
-    ast->ident = *unique_ptr<string>($1);
+    ast->ident.assign($1.text, $1.len);
     $$ = ast;
   }
   ;
@@ -309,9 +387,21 @@ Number
   }
   ;
 
-// UnaryExp ::= PrimaryExp | UnaryOp UnaryExp
+// UnaryExp ::= PrimaryExp | IDENT "(" [FuncRParams] ")" | UnaryOp UnaryExp
 UnaryExp
   : PrimaryExp { $$ = $1; }
+  | IDENT '(' ')' {
+    auto ast = new CallExpAST();
+    ast->ident.assign($1.text, $1.len);
+    $$ = ast;
+  }
+  | IDENT '(' FuncRParams ')' {
+    auto ast = new CallExpAST();
+    ast->ident.assign($1.text, $1.len);
+    ast->args = std::move(*$3);
+    delete $3;
+    $$ = ast;
+  }
   | UnaryOp UnaryExp {
     auto ast = new UnaryExpAST();
     ast->op = *unique_ptr<string>($1);
@@ -320,6 +410,18 @@ UnaryExp
   }
   ;
 
+// FuncRParams ::= Exp {"," Exp}
+FuncRParams
+  : Exp {
+    $$ = new vector<unique_ptr<BaseAST>>();
+    $$->push_back(unique_ptr<BaseAST>($1));
+  }
+  | FuncRParams ',' Exp {
+    $1->push_back(unique_ptr<BaseAST>($3));
+    $$ = $1;
+  }
+  ;
+
 // UnaryOp ::= "+" | "-" | "!"
 UnaryOp
   : '+' { $$ = new string("+"); }
@@ -460,8 +562,16 @@ ConstExp
 
 %%
 
-// 定义错误处理函数, 其中第二个参数是错误信息
+// 定义错误处理函数, 其中最后一个参数是错误信息
 // parser 如果发生错误 (例如输入的程序出现了语法错误), 就会调用这个函数
-void yyerror(unique_ptr<BaseAST> &ast, const char *s) {
-  cerr << "error: " << s << endl;
+void yyerror(LexerHandle lexer, unique_ptr<BaseAST> &ast, const char *s) {
+  ostream &err = lexer.hand ? lexer.hand->Err() : *yyget_extra(lexer.flex);
+  err << "error: " << s << endl;
+}
+
+int yylex(YYSTYPE *yylval_param, LexerHandle lexer) {
+  if (lexer.hand) {
+    return lexer.hand->Next(yylval_param);
+  }
+  return yylex(yylval_param, lexer.flex);
 }
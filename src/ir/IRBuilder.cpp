@@ -2,7 +2,7 @@
 #include "ir/IR.h"
 
 #include <cassert>
-#include <iostream>
+#include <stdexcept>
 
 void IRBuilder::SetCurrentFunction(Function *func) { cur_func_ = func; }
 
@@ -18,6 +18,35 @@ BasicBlock *IRBuilder::CreateBlock(const std::string &name) {
 
 void IRBuilder::SetInsertPoint(BasicBlock *bb) { cur_bb_ = bb; }
 
+/**
+ * 函数形参 @name_N: type，与局部变量共用命名计数，保证名称不冲突
+ */
+Value IRBuilder::CreateParam(const std::string &type,
+                             const std::string &param_name) {
+  return cur_func_->AddParam(NewTempAddr_(param_name).reg_or_addr, type);
+}
+
+/**
+ * @input: args (imm | @reg | @addr)
+ *
+ * @res_reg = call @callee(args...)，void 函数没有结果，返回 0 占位
+ */
+Value IRBuilder::CreateCall(Function *callee, const std::vector<Value> &args) {
+  auto inst = std::make_unique<Instruction>(Opcode::Call);
+  Value res_reg = Value::Imm(0);
+  if (callee->ret_type != "void") {
+    res_reg = NewTempReg_();
+    inst->args.emplace_back(res_reg);
+  }
+  inst->args.emplace_back(callee);
+  for (const auto &arg : args) {
+    // 如果是地址，先load
+    inst->args.emplace_back(arg.isAddress() ? CreateLoad(arg) : arg);
+  }
+  cur_bb_->Append(std::move(inst));
+  return res_reg;
+}
+
 /**
  * @addr = alloc type
  */
@@ -125,8 +154,7 @@ Value IRBuilder::CreateUnaryOp(const std::string &op, const Value &value) {
   } else if (op == "!") {
     Emit(Opcode::Eq, res_reg, val_reg, Value::Imm(0));
   } else {
-    std::cerr << "Unknown unary operator: " << op << std::endl;
-    assert(false);
+    throw std::runtime_error("Unknown unary operator: " + op);
   }
 
   return res_reg;
@@ -178,8 +206,7 @@ Value IRBuilder::CreateBinaryOp(const std::string &op, const Value &lhs,
   else if (op == "||")
     opcode = Opcode::Or;
   else {
-    std::cerr << "Unknown binary operator: " << op << std::endl;
-    assert(false);
+    throw std::runtime_error("Unknown binary operator: " + op);
   }
 
   Value res_reg = NewTempReg_();
@@ -2,8 +2,9 @@
 #include "frontend/SymbolTable.h"
 #include "ir/IR.h"
 #include "ir/IRBuilder.h"
+#include <algorithm>
 #include <cassert>
-#include <iostream>
+#include <cstdint>
 #include <memory>
 #include <stdexcept>
 
@@ -12,9 +13,20 @@ IRGenVisitor::IRGenVisitor()
       builder_(std::make_unique<IRBuilder>()),
       symtab_(std::make_unique<SymbolTable>()) {}
 
+/**
+ * SysY 运行时库中的标量输入输出函数，以 decl 形式出现在 IR 中
+ */
+void IRGenVisitor::DeclareLibFunctions_() {
+  module_->CreateFunction("getint", "i32");
+  module_->CreateFunction("getch", "i32");
+  module_->CreateFunction("putint", "void")->AddParam("@x", "i32");
+  module_->CreateFunction("putch", "void")->AddParam("@x", "i32");
+}
+
 void IRGenVisitor::VisitCompUnit_(const CompUnitAST *ast) {
-  if (ast->func_def) {
-    ast->func_def->Accept(*this);
+  DeclareLibFunctions_();
+  for (auto &func_def : ast->func_defs) {
+    func_def->Accept(*this);
   }
 }
 
@@ -34,6 +46,17 @@ void IRGenVisitor::VisitFuncDef_(const FuncDefAST *ast) {
 
   builder_->SetInsertPoint(entry_bb);
 
+  // 形参与返回值变量属于函数自己的作用域
+  symtab_->EnterScope();
+
+  // 形参按值传递，复制到局部变量后与普通变量一样读写
+  for (const auto &param : ast->params) {
+    Value param_val = builder_->CreateParam("i32", param->ident);
+    Value param_addr = builder_->CreateAlloca("i32", param->ident);
+    builder_->CreateStore(param_val, param_addr);
+    symtab_->Define(param->ident, SYMBOL_TYPE_VARIABLE, param_addr);
+  }
+
   // 分配返回值变量
   if (ret_type == "i32") {
     Value ret_addr = builder_->CreateAlloca("i32", "ret");
@@ -59,6 +82,7 @@ void IRGenVisitor::VisitFuncDef_(const FuncDefAST *ast) {
     builder_->CreateReturn();
   }
 
+  symtab_->ExitScope();
   builder_->EndFunction();
 }
 
@@ -86,8 +110,8 @@ void IRGenVisitor::VisitConstDef_(const ConstDefAST *ast) {
   Value init_val = Eval(ast->init_val.get());
 
   if (!init_val.isImmediate()) {
-    std::cerr << "const init must be a constant expression" << std::endl;
-    assert(false);
+    throw std::runtime_error("[Semantic Error]: Initializer of constant " +
+                             ast->ident + " is not a constant expression");
   }
 
   symtab_->Define(ast->ident, SYMBOL_TYPE_CONSTANT, init_val);
@@ -122,20 +146,18 @@ void IRGenVisitor::VisitVarDef_(const VarDefAST *ast) {
 
 void IRGenVisitor::VisitAssignStmt_(const AssignStmtAST *ast) {
   if (!ast->lval || !ast->exp) {
-    std::cerr << "assign: lval or exp is null" << std::endl;
-    return;
+    throw std::runtime_error("assign: lval or exp is null");
   }
 
   auto symbol_opt = symtab_->Lookup(ast->lval->ident);
   if (!symbol_opt.has_value()) {
-    std::cerr << "symbol not found: " << ast->lval->ident << std::endl;
-    assert(false);
+    throw std::runtime_error("[Semantic Error]: Undefined variable " +
+                             ast->lval->ident);
   }
 
   if (symbol_opt->type != SYMBOL_TYPE_VARIABLE) {
-    std::cerr << "cannot assign to non-variable: " << ast->lval->ident
-              << std::endl;
-    assert(false);
+    throw std::runtime_error("[Semantic Error]: Cannot assign to constant " +
+                             ast->lval->ident);
   }
 
   Value addr = symbol_opt->value;
@@ -232,8 +254,10 @@ void IRGenVisitor::VisitReturnStmt_(const ReturnStmtAST *ast) {
 
     auto ret_symbol_opt = symtab_->Lookup("@ret");
     if (!ret_symbol_opt.has_value()) {
-      std::cerr << "symbol not found: @ret" << std::endl;
-      assert(false);
+      // 只有返回 int 的函数定义了 @ret
+      throw std::runtime_error(
+          "[Semantic Error]: Return with a value in void function " +
+          builder_->cur_func_->name);
     }
 
     // 如果是地址，先load
@@ -257,21 +281,21 @@ Value IRGenVisitor::Eval(BaseAST *ast) {
     return EvalLVal(lval);
   } else if (auto *number = dynamic_cast<NumberAST *>(ast)) {
     return EvalNumber(number);
+  } else if (auto *call = dynamic_cast<CallExpAST *>(ast)) {
+    return EvalCallExp(call);
   } else if (auto *unary = dynamic_cast<UnaryExpAST *>(ast)) {
     return EvalUnaryExp(unary);
   } else if (auto *binary = dynamic_cast<BinaryExpAST *>(ast)) {
     return EvalBinaryExp(binary);
   }
-  std::cerr << "Eval: unknown expression type" << std::endl;
-  assert(false);
-  return Value::Imm(0);
+  throw std::runtime_error("Eval: unknown expression type");
 }
 
 Value IRGenVisitor::EvalLVal(LValAST *ast) {
   auto symbol_opt = symtab_->Lookup(ast->ident);
   if (!symbol_opt.has_value()) {
-    std::cerr << "symbol not found: " << ast->ident << std::endl;
-    assert(false);
+    throw std::runtime_error("[Semantic Error]: Undefined variable " +
+                             ast->ident);
   }
 
   // 常量直接返回立即数，变量返回地址
@@ -280,10 +304,36 @@ Value IRGenVisitor::EvalLVal(LValAST *ast) {
 
 Value IRGenVisitor::EvalNumber(NumberAST *ast) { return Value::Imm(ast->val); }
 
+/**
+ * 实参按从左到右的顺序求值；void 函数的调用结果不应被使用
+ */
+Value IRGenVisitor::EvalCallExp(CallExpAST *ast) {
+  Function *callee = module_->GetFunction(ast->ident);
+  if (!callee) {
+    throw std::runtime_error("[Semantic Error]: Undefined function " +
+                             ast->ident);
+  }
+  if (callee->params.size() != ast->args.size()) {
+    throw std::runtime_error("[Semantic Error]: Wrong number of arguments "
+                             "to function " +
+                             ast->ident);
+  }
+
+  std::vector<Value> args;
+  for (auto &arg : ast->args) {
+    Value val = Eval(arg.get());
+    // 如果是地址，先load
+    if (val.isAddress()) {
+      val = builder_->CreateLoad(val);
+    }
+    args.push_back(val);
+  }
+  return builder_->CreateCall(callee, args);
+}
+
 Value IRGenVisitor::EvalUnaryExp(UnaryExpAST *ast) {
   if (!ast->exp) {
-    std::cerr << "unary operand is null" << std::endl;
-    assert(false);
+    throw std::runtime_error("unary operand is null");
   }
 
   Value operand = Eval(ast->exp.get());
@@ -292,15 +342,36 @@ Value IRGenVisitor::EvalUnaryExp(UnaryExpAST *ast) {
 
 Value IRGenVisitor::EvalBinaryExp(BinaryExpAST *ast) {
   if (!ast->lhs || !ast->rhs) {
-    std::cerr << "binary operand is null" << std::endl;
-    assert(false);
+    throw std::runtime_error("binary operand is null");
   }
 
-  Value lhs = Eval(ast->lhs.get());
-  Value rhs = Eval(ast->rhs.get());
+  // 短路求值 && 与 ||，操作数的求值顺序由语义决定
+  if (ast->op == "&&") {
+    return EvalLogicalAnd(ast);
+  }
 
-  // 常量折叠
-  if (lhs.isImmediate() && rhs.isImmediate()) {
+  if (ast->op == "||") {
+    return EvalLogicalOr(ast);
+  }
+
+  // Sethi-Ullman：先求值寄存器需求更大的子树，
+  // 求值另一棵子树时只需多占用一个寄存器保存其结果
+  Value lhs, rhs;
+  if (RegisterNeed(ast->rhs.get()) > RegisterNeed(ast->lhs.get()) &&
+      IsPure(ast->lhs.get()) && IsPure(ast->rhs.get())) {
+    rhs = Eval(ast->rhs.get());
+    lhs = Eval(ast->lhs.get());
+  } else {
+    lhs = Eval(ast->lhs.get());
+    rhs = Eval(ast->rhs.get());
+  }
+
+  // 常量折叠；与 InstCombine 一样，除零或溢出留给运行时，
+  // 不在编译器中触发 SIGFPE
+  bool traps = (ast->op == "/" || ast->op == "%") && rhs.isImmediate() &&
+               (rhs.imm == 0 || (lhs.isImmediate() && lhs.imm == INT32_MIN &&
+                                 rhs.imm == -1));
+  if (lhs.isImmediate() && rhs.isImmediate() && !traps) {
     int l = lhs.imm, r = rhs.imm;
     int result;
     if (ast->op == "+")
@@ -325,26 +396,12 @@ Value IRGenVisitor::EvalBinaryExp(BinaryExpAST *ast) {
       result = l == r;
     else if (ast->op == "!=")
       result = l != r;
-    else if (ast->op == "&&")
-      result = l && r;
-    else if (ast->op == "||")
-      result = l || r;
     else {
-      std::cerr << "Unknown binary operator: " << ast->op << std::endl;
-      assert(false);
+      throw std::runtime_error("Unknown binary operator: " + ast->op);
     }
     return Value::Imm(result);
   }
 
-  // 短路求值 && 与 ||
-  if (ast->op == "&&") {
-    return EvalLogicalAnd(ast);
-  }
-
-  if (ast->op == "||") {
-    return EvalLogicalOr(ast);
-  }
-
   return builder_->CreateBinaryOp(ast->op, lhs, rhs);
 }
 
@@ -352,11 +409,24 @@ Value IRGenVisitor::EvalBinaryExp(BinaryExpAST *ast) {
  * 逻辑与的返回值一定是 i32 类型的立即数
  */
 Value IRGenVisitor::EvalLogicalAnd(BinaryExpAST *ast) {
+  // 计算左操作数
+  Value lhs = Eval(ast->lhs.get());
+
+  // 左操作数为常量时在编译期决定是否短路
+  if (lhs.isImmediate()) {
+    if (lhs.imm == 0) {
+      return Value::Imm(0);
+    }
+    Value rhs = Eval(ast->rhs.get());
+    if (rhs.isImmediate()) {
+      return Value::Imm(rhs.imm != 0);
+    }
+    return builder_->CreateBinaryOp("!=", rhs, Value::Imm(0));
+  }
+
   auto *rhs_bb = builder_->CreateBlock("and_rhs");
   auto *end_bb = builder_->CreateBlock("and_end");
 
-  // 计算左操作数
-  Value lhs = Eval(ast->lhs.get());
   builder_->CreateBranch(lhs, rhs_bb, {}, end_bb, {Value::Imm(0)});
 
   // 计算右操作数
@@ -375,11 +445,24 @@ Value IRGenVisitor::EvalLogicalAnd(BinaryExpAST *ast) {
  * 逻辑或的返回值一定是 i32 类型的立即数
  */
 Value IRGenVisitor::EvalLogicalOr(BinaryExpAST *ast) {
+  // 计算左操作数
+  Value lhs = Eval(ast->lhs.get());
+
+  // 左操作数为常量时在编译期决定是否短路
+  if (lhs.isImmediate()) {
+    if (lhs.imm != 0) {
+      return Value::Imm(1);
+    }
+    Value rhs = Eval(ast->rhs.get());
+    if (rhs.isImmediate()) {
+      return Value::Imm(rhs.imm != 0);
+    }
+    return builder_->CreateBinaryOp("!=", rhs, Value::Imm(0));
+  }
+
   auto *rhs_bb = builder_->CreateBlock("or_rhs");
   auto *end_bb = builder_->CreateBlock("or_end");
 
-  // 计算左操作数
-  Value lhs = Eval(ast->lhs.get());
   builder_->CreateBranch(lhs, end_bb, {Value::Imm(1)}, rhs_bb, {});
 
   // 计算右操作数
@@ -393,9 +476,55 @@ Value IRGenVisitor::EvalLogicalOr(BinaryExpAST *ast) {
   Value res_reg = end_bb->AddParam("i32");
   return res_reg;
 }
+
+/**
+ * 子树求值所需的寄存器数（Ershov 数）：
+ * 常量可作为立即数，不占寄存器；变量需要一个寄存器装载；
+ * 两棵子树需求相同时需要额外一个寄存器保存先求出的结果
+ */
+int IRGenVisitor::RegisterNeed(BaseAST *ast) {
+  auto it = reg_need_.find(ast);
+  if (it != reg_need_.end()) {
+    return it->second;
+  }
+
+  int need = 1;
+  if (dynamic_cast<NumberAST *>(ast)) {
+    need = 0;
+  } else if (auto *lval = dynamic_cast<LValAST *>(ast)) {
+    auto symbol_opt = symtab_->Lookup(lval->ident);
+    need = symbol_opt && symbol_opt->type == SYMBOL_TYPE_CONSTANT ? 0 : 1;
+  } else if (auto *unary = dynamic_cast<UnaryExpAST *>(ast)) {
+    need = std::max(1, RegisterNeed(unary->exp.get()));
+  } else if (auto *binary = dynamic_cast<BinaryExpAST *>(ast)) {
+    int l = RegisterNeed(binary->lhs.get());
+    int r = RegisterNeed(binary->rhs.get());
+    need = l == r ? l + 1 : std::max(l, r);
+  }
+
+  reg_need_[ast] = need;
+  return need;
+}
+
+/**
+ * 子树求值没有副作用时才能调整求值顺序。
+ * 目前 SysY 表达式只含运算与变量读取；未知节点（如后续加入的函数调用）
+ * 一律视为有副作用
+ */
+bool IRGenVisitor::IsPure(BaseAST *ast) {
+  if (dynamic_cast<NumberAST *>(ast) || dynamic_cast<LValAST *>(ast)) {
+    return true;
+  } else if (auto *unary = dynamic_cast<UnaryExpAST *>(ast)) {
+    return IsPure(unary->exp.get());
+  } else if (auto *binary = dynamic_cast<BinaryExpAST *>(ast)) {
+    return IsPure(binary->lhs.get()) && IsPure(binary->rhs.get());
+  }
+  return false;
+}
 // ==================== Visitor接口实现 ====================
 
 void IRGenVisitor::Visit(CompUnitAST &node) { VisitCompUnit_(&node); }
+void IRGenVisitor::Visit(FuncFParamAST &node) {}
 void IRGenVisitor::Visit(FuncDefAST &node) { VisitFuncDef_(&node); }
 void IRGenVisitor::Visit(BlockAST &node) { VisitBlock_(&node); }
 void IRGenVisitor::Visit(ConstDeclAST &node) { VisitConstDecl_(&node); }
@@ -409,5 +538,6 @@ void IRGenVisitor::Visit(WhileStmtAST &node) { VisitWhileStmt_(&node); }
 void IRGenVisitor::Visit(ReturnStmtAST &node) { VisitReturnStmt_(&node); }
 void IRGenVisitor::Visit(LValAST &node) {}
 void IRGenVisitor::Visit(NumberAST &node) {}
+void IRGenVisitor::Visit(CallExpAST &node) {}
 void IRGenVisitor::Visit(UnaryExpAST &node) {}
 void IRGenVisitor::Visit(BinaryExpAST &node) {}
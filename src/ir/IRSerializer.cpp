@@ -1,7 +1,7 @@
 #include "ir/IRSerializer.h"
 
-#include <cassert>
 #include <sstream>
+#include <stdexcept>
 
 namespace IRSerializer {
 
@@ -10,8 +10,7 @@ static std::string OperandToString(const Operand &op) {
   if (std::holds_alternative<Value>(op)) {
     return std::get<Value>(op).toString();
   }
-  assert(false && "OperandToString: unexpected operand type");
-  return "";
+  throw std::runtime_error("OperandToString: unexpected operand type");
 }
 
 // 将 BranchTarget 转换为字符串（包含块参数）
@@ -100,6 +99,16 @@ static std::string InstructionToString(const Instruction &inst) {
         << OperandToString(inst.args[1]) << ", "
         << OperandToString(inst.args[2]);
     break;
+  case Opcode::Xor:
+    oss << "  " << OperandToString(inst.args[0]) << " = xor "
+        << OperandToString(inst.args[1]) << ", "
+        << OperandToString(inst.args[2]);
+    break;
+  case Opcode::Sar:
+    oss << "  " << OperandToString(inst.args[0]) << " = sar "
+        << OperandToString(inst.args[1]) << ", "
+        << OperandToString(inst.args[2]);
+    break;
   case Opcode::Alloc:
     oss << "  " << OperandToString(inst.args[0]) << " = alloc i32";
     break;
@@ -133,10 +142,23 @@ static std::string InstructionToString(const Instruction &inst) {
       oss << "  ret " << OperandToString(inst.args[0]);
     }
     break;
-  case Opcode::Call:
-    // TODO: 函数调用
+  case Opcode::Call: {
+    // [%res =] call @callee(arg0, arg1, ...)
+    size_t callee_index = inst.CalleeIndex();
+    oss << "  ";
+    if (inst.HasResult()) {
+      oss << OperandToString(inst.args[0]) << " = ";
+    }
+    oss << "call @" << inst.Callee()->name << "(";
+    for (size_t i = callee_index + 1; i < inst.args.size(); i++) {
+      if (i > callee_index + 1)
+        oss << ", ";
+      oss << OperandToString(inst.args[i]);
+    }
+    oss << ")";
     break;
   }
+  }
 
   return oss.str();
 }
@@ -158,12 +180,37 @@ static std::string BlockHeaderToString(const BasicBlock &bb) {
   return oss.str();
 }
 
-// 将单个函数转换为 IR 文本
+// 将单个函数转换为 IR 文本，没有函数体的函数输出为 decl
 static std::string FunctionToString(const Function &func) {
   std::ostringstream oss;
 
-  // 函数头
-  oss << "fun @" << func.name << "(): " << func.ret_type << " {\n";
+  if (func.IsDeclaration()) {
+    oss << "decl @" << func.name << "(";
+    for (size_t i = 0; i < func.params.size(); i++) {
+      if (i > 0)
+        oss << ", ";
+      oss << func.params[i].second;
+    }
+    oss << ")";
+    if (func.ret_type != "void") {
+      oss << ": " << func.ret_type;
+    }
+    oss << "\n";
+    return oss.str();
+  }
+
+  // 函数头，void 函数省略返回类型
+  oss << "fun @" << func.name << "(";
+  for (size_t i = 0; i < func.params.size(); i++) {
+    if (i > 0)
+      oss << ", ";
+    oss << func.params[i].first << ": " << func.params[i].second;
+  }
+  oss << ")";
+  if (func.ret_type != "void") {
+    oss << ": " << func.ret_type;
+  }
+  oss << " {\n";
 
   // 遍历所有基本块
   for (const auto &bb : func.blocks) {
@@ -183,23 +230,36 @@ static std::string FunctionToString(const Function &func) {
 std::string ToIR(const IRModule &module) {
   std::ostringstream oss;
 
-  for (const auto &[name, func] : module.GetFunctions()) {
+  for (const auto &func : module.GetFunctions()) {
     oss << FunctionToString(*func);
   }
 
   return oss.str();
 }
 
-koopa_raw_program_t ToProgram(const std::string &ir) {
+std::string ToIR(const Instruction &inst) {
+  return InstructionToString(inst).substr(2);
+}
+
+RawProgram::RawProgram(const std::string &ir) {
   koopa_program_t program = nullptr;
   koopa_error_code_t ret = koopa_parse_from_string(ir.c_str(), &program);
-  assert(ret == KOOPA_EC_SUCCESS);
+  // 序列化出的文本应当总能被 libkoopa 解析，失败说明前面生成了非法的 IR
+  if (ret != KOOPA_EC_SUCCESS) {
+    throw std::runtime_error("Failed to parse generated Koopa IR, error code " +
+                             std::to_string(ret));
+  }
 
-  auto builder = koopa_new_raw_program_builder();
-  return koopa_build_raw_program(builder, program);
+  builder_ = koopa_new_raw_program_builder();
+  raw_ = koopa_build_raw_program(builder_, program);
+  koopa_delete_program(program);
 }
 
-koopa_raw_program_t ToProgram(const IRModule &module) {
+RawProgram::~RawProgram() { koopa_delete_raw_program_builder(builder_); }
+
+RawProgram ToProgram(const std::string &ir) { return RawProgram(ir); }
+
+RawProgram ToProgram(const IRModule &module) {
   std::string ir = ToIR(module);
   return ToProgram(ir);
 }
@@ -1,69 +1,122 @@
-#include "backend/CodeGen.h"
-#include "frontend/AST.h"
-#include "frontend/DumpVisitor.h"
-#include "ir/IRGenVisitor.h"
-#include "ir/IRSerializer.h"
+#include "driver/CompileServer.h"
+#include "driver/Driver.h"
 
-#include <cassert>
-#include <cstdio>
+#include <cstddef>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
-// 声明 lexer 的输入, 以及 parser 函数
-// 为什么不引用 sysy.tab.hpp 呢? 因为首先里面没有 yyin 的定义
-// 其次, 因为这个文件不是我们自己写的, 而是被 Bison 生成出来的
-// 你的代码编辑器/IDE 很可能找不到这个文件, 然后会给你报错 (虽然编译不会出错)
-// 看起来会很烦人, 于是干脆采用这种看起来 dirty 但实际很有效的手段
-extern FILE *yyin;
-extern int yyparse(unique_ptr<BaseAST> &ast);
+static void PrintUsage() {
+  cerr << "Usage: compiler <-koopa|-riscv> <input> -o <output> [options]\n"
+          "           [-connect=<socket>]\n"
+          "       compiler -batch <job-list> [-jobs=<n>] [options]\n"
+          "       compiler -server <socket> [-jobs=<n>]"
+       << endl;
+}
 
-int main(int argc, const char *argv[]) {
-  assert(argc == 5);
+// 单个文件交给 -connect= 指定的编译服务器编译。
+// 服务器不可用时返回 false，由调用者在本进程中编译
+static bool CompileRemotely(const string &socket_path, const CompileJob &job,
+                            const vector<string> &args, int &exit_code) {
+  ifstream in(job.input);
+  if (!in) {
+    return false;
+  }
+  ostringstream source;
+  source << in.rdbuf();
 
-  string mode(argv[1]);  // 模式: -koopa or -riscv
-  auto input = argv[2];  // 输入文件
-  auto output = argv[4]; // 输出文件
+  CompileResponse response;
+  if (!CompileServer::Request(socket_path, {job.mode, args, source.str()},
+                              response)) {
+    return false;
+  }
+  cerr << response.diagnostics;
+  if (!response.succeeded) {
+    cerr << "Error: Failed to compile " << job.input << endl;
+    exit_code = 1;
+    return true;
+  }
+  ofstream out(job.output);
+  exit_code = (out << response.output) ? 0 : 1;
+  return true;
+}
 
-  if (mode != "-koopa" && mode != "-riscv") {
-    cerr << "Error: Unsupported mode " << mode << endl;
+int main(int argc, const char *argv[]) {
+  // 批量模式: 任务列表中每行一个文件, 在多个线程上并发编译
+  // 服务器模式: 常驻进程, 在 Unix 域套接字上接受编译请求
+  string mode(argc >= 2 ? argv[1] : "");
+  bool batch = mode == "-batch" && argc >= 3;
+  bool server = mode == "-server" && argc >= 3;
+  if (!batch && !server && (argc < 5 || string(argv[3]) != "-o")) {
+    PrintUsage();
     return 1;
   }
 
-  // open source file
-  yyin = fopen(input, "r");
-  assert(yyin);
-
-  // parse
-  unique_ptr<BaseAST> ast;
-  auto parse_ret = yyparse(ast);
-  assert(!parse_ret);
-  fclose(yyin);
+  // 编译选项交给 Driver 解析, 这里只取出 -jobs= 与 -connect=
+  size_t jobs = thread::hardware_concurrency();
+  string connect;
+  vector<string> args;
+  for (int i = batch || server ? 3 : 5; i < argc; ++i) {
+    string arg(argv[i]);
+    if (arg.rfind("-jobs=", 0) == 0) {
+      if (!Driver::ParseUnsigned(string_view(arg).substr(6), jobs)) {
+        cerr << "Error: Invalid value for -jobs" << endl;
+        return 1;
+      }
+    } else if (arg.rfind("-connect=", 0) == 0) {
+      connect = arg.substr(9);
+    } else {
+      args.push_back(arg);
+    }
+  }
+  if (jobs == 0) {
+    jobs = 1;
+  }
 
-  // dump AST
-  DumpVisitor dumper;
-  ast->Accept(dumper);
+  // 服务器按每个请求中的选项编译
+  if (server) {
+    if (!args.empty()) {
+      PrintUsage();
+      return 1;
+    }
+    return CompileServer::Serve(argv[2], jobs) ? 0 : 1;
+  }
 
-  // AST -> Koopa IR
-  IRGenVisitor irgen;
-  ast->Accept(irgen);
+  CompileOptions options;
+  if (!Driver::ParseOptions(args, options, cerr)) {
+    return 1;
+  }
 
-  // Code generation
-  if (mode == "-koopa") {
-    // 生成 Koopa IR 文本
-    FILE *out = fopen(output, "w");
-    assert(out);
-    std::string ir = IRSerializer::ToIR(irgen.GetModule());
-    fprintf(out, "%s", ir.c_str());
-    fclose(out);
-  } else if (mode == "-riscv") {
-    // 生成 RISC-V 汇编
-    freopen(output, "w", stdout);
-    ProgramCodeGen codegen;
-    codegen.Emit(IRSerializer::ToProgram(irgen.GetModule()));
-    fclose(stdout);
+  if (batch) {
+    // 各任务的转储随各自的诊断信息输出, 写到同一个文件会互相覆盖
+    if (!options.dump.file.empty()) {
+      cerr << "Error: -dump-file= cannot be used with -batch" << endl;
+      return 1;
+    }
+    vector<CompileJob> job_list;
+    if (!Driver::ReadJobList(argv[2], job_list)) {
+      return 1;
+    }
+    size_t failures = Driver::CompileBatch(job_list, options, jobs);
+    if (failures != 0) {
+      cerr << failures << " of " << job_list.size() << " files failed"
+           << endl;
+      return 1;
+    }
+    return 0;
   }
 
-  return 0;
+  // 单个文件: 模式 -koopa or -riscv, 输入文件, 输出文件
+  CompileJob job{argv[1], argv[2], argv[4]};
+  int exit_code;
+  if (!connect.empty() && CompileRemotely(connect, job, args, exit_code)) {
+    return exit_code;
+  }
+  return Driver::Compile(job, options) ? 0 : 1;
 }
@@ -0,0 +1,35 @@
+#include "opt/AnalysisManager.h"
+
+const CFG &AnalysisManager::GetCFG(Function &func) {
+  auto &cache = cache_[&func];
+  if (!cache.cfg) {
+    cache.cfg = std::make_unique<CFG>(func);
+  }
+  return *cache.cfg;
+}
+
+const DominatorTree &AnalysisManager::GetDomTree(Function &func) {
+  auto &cache = cache_[&func];
+  if (!cache.dom_tree) {
+    cache.dom_tree = std::make_unique<DominatorTree>(GetCFG(func));
+  }
+  return *cache.dom_tree;
+}
+
+const DominanceFrontier &AnalysisManager::GetDomFrontier(Function &func) {
+  auto &cache = cache_[&func];
+  if (!cache.dom_frontier) {
+    cache.dom_frontier =
+        std::make_unique<DominanceFrontier>(GetCFG(func), GetDomTree(func));
+  }
+  return *cache.dom_frontier;
+}
+
+const LoopInfo &AnalysisManager::GetLoopInfo(Function &func) {
+  auto &cache = cache_[&func];
+  if (!cache.loop_info) {
+    cache.loop_info =
+        std::make_unique<LoopInfo>(GetCFG(func), GetDomTree(func));
+  }
+  return *cache.loop_info;
+}
@@ -0,0 +1,68 @@
+#include "opt/CFG.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+const std::vector<BasicBlock *> kNoBlocks;
+
+} // namespace
+
+CFG::CFG(const Function &func) {
+  if (func.blocks.empty()) {
+    return;
+  }
+  entry_ = func.blocks.front().get();
+
+  for (const auto &bb : func.blocks) {
+    preds_[bb.get()];
+    auto &succs = succs_[bb.get()];
+    if (bb->insts.empty()) {
+      continue;
+    }
+    for (const auto &arg : bb->insts.back()->args) {
+      auto *target = std::get_if<BranchTarget>(&arg);
+      if (!target || std::find(succs.begin(), succs.end(), target->target) !=
+                         succs.end()) {
+        continue;
+      }
+      succs.push_back(target->target);
+      preds_[target->target].push_back(bb.get());
+    }
+  }
+
+  // 迭代式 DFS 计算后序，再反转得到逆后序
+  std::vector<BasicBlock *> post_order;
+  std::unordered_map<BasicBlock *, bool> visited;
+  std::vector<std::pair<BasicBlock *, size_t>> stack{{entry_, 0}};
+  visited[entry_] = true;
+  while (!stack.empty()) {
+    auto &[bb, next] = stack.back();
+    const auto &succs = succs_[bb];
+    if (next < succs.size()) {
+      BasicBlock *succ = succs[next++];
+      if (!visited[succ]) {
+        visited[succ] = true;
+        stack.push_back({succ, 0});
+      }
+    } else {
+      post_order.push_back(bb);
+      stack.pop_back();
+    }
+  }
+  rpo_.assign(post_order.rbegin(), post_order.rend());
+  for (size_t i = 0; i < rpo_.size(); ++i) {
+    rpo_index_[rpo_[i]] = i;
+  }
+}
+
+const std::vector<BasicBlock *> &CFG::Preds(BasicBlock *bb) const {
+  auto it = preds_.find(bb);
+  return it == preds_.end() ? kNoBlocks : it->second;
+}
+
+const std::vector<BasicBlock *> &CFG::Succs(BasicBlock *bb) const {
+  auto it = succs_.find(bb);
+  return it == succs_.end() ? kNoBlocks : it->second;
+}
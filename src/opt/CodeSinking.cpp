@@ -0,0 +1,67 @@
+#include "opt/CodeSinking.h"
+#include "opt/AnalysisManager.h"
+#include "opt/IRUtils.h"
+
+#include <vector>
+
+/**
+ * 按逆后序处理，下沉到后继块的指令在处理后继块时可以继续下沉；
+ * 块内从后往前处理，使用者先下沉后，其操作数的定义才可能满足条件
+ */
+bool CodeSinkingPass::Run(Function &func, AnalysisManager &am) {
+  const CFG &cfg = am.GetCFG(func);
+
+  bool changed = false;
+  for (BasicBlock *bb : cfg.ReversePostOrder()) {
+    for (size_t i = bb->insts.size(); i-- > 0;) {
+      Instruction *inst = bb->insts[i].get();
+      BasicBlock *target = SinkTarget(func, inst, cfg);
+      if (!target) {
+        continue;
+      }
+      // 按原顺序的逆序插入到开头，下沉后的指令保持原有顺序
+      target->Insert(0, bb->Take(inst));
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+BasicBlock *CodeSinkingPass::SinkTarget(const Function &func,
+                                        Instruction *inst,
+                                        const CFG &cfg) const {
+  if (!IRUtils::IsPure(*inst)) {
+    return nullptr;
+  }
+  BasicBlock *bb = inst->parent;
+  BasicBlock *target = nullptr;
+  for (const Use &use : func.Uses(inst->Result())) {
+    BasicBlock *user_bb = use.user->parent;
+    if (user_bb == bb || (target && target != user_bb)) {
+      return nullptr;
+    }
+    target = user_bb;
+  }
+  // 没有使用的指令留给死代码删除
+  if (!target) {
+    return nullptr;
+  }
+  const auto &preds = cfg.Preds(target);
+  if (preds.size() != 1 || preds.front() != bb) {
+    return nullptr;
+  }
+
+  if (inst->op == Opcode::Load) {
+    const std::string &addr = inst->ValueAt(1).reg_or_addr;
+    bool after = false;
+    for (const auto &other : bb->insts) {
+      if (other.get() == inst) {
+        after = true;
+      } else if (after && other->op == Opcode::Store &&
+                 other->ValueAt(1).reg_or_addr == addr) {
+        return nullptr;
+      }
+    }
+  }
+  return target;
+}
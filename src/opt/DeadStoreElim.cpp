@@ -0,0 +1,147 @@
+#include "opt/DeadStoreElim.h"
+#include "opt/AnalysisManager.h"
+#include "opt/IRUtils.h"
+
+#include <unordered_set>
+
+bool DeadStoreElimPass::Run(Function &func, AnalysisManager &am) {
+  slots_.clear();
+  for (auto &bb : func.blocks) {
+    for (auto &inst : bb->insts) {
+      if (inst->op == Opcode::Alloc) {
+        int index = static_cast<int>(slots_.size());
+        slots_[inst->Result().reg_or_addr] = index;
+      }
+    }
+  }
+  if (slots_.empty()) {
+    return false;
+  }
+
+  bool changed = RemoveDeadStores(am.GetCFG(func));
+  changed |= RemoveUnreadAllocas(func);
+  if (changed) {
+    IRUtils::RemoveDeadInsts(func);
+  }
+  return changed;
+}
+
+int DeadStoreElimPass::SlotOf(const Value &addr) const {
+  if (!addr.isAddress()) {
+    return -1;
+  }
+  auto it = slots_.find(addr.reg_or_addr);
+  return it == slots_.end() ? -1 : it->second;
+}
+
+/**
+ * load 使变量活跃，store 整体覆盖变量使其不再活跃；
+ * 写入时变量不活跃的 store 即为死存储
+ */
+DeadStoreElimPass::SlotSet
+DeadStoreElimPass::Transfer(BasicBlock *bb, SlotSet live,
+                            std::vector<Instruction *> *dead) const {
+  for (size_t i = bb->insts.size(); i-- > 0;) {
+    Instruction *inst = bb->insts[i].get();
+    if (inst->op == Opcode::Load) {
+      int slot = SlotOf(inst->ValueAt(1));
+      if (slot >= 0) {
+        live[slot] = true;
+      }
+    } else if (inst->op == Opcode::Store) {
+      int slot = SlotOf(inst->ValueAt(1));
+      if (slot < 0) {
+        continue;
+      }
+      if (!live[slot] && dead) {
+        dead->push_back(inst);
+      }
+      live[slot] = false;
+    }
+  }
+  return live;
+}
+
+bool DeadStoreElimPass::RemoveDeadStores(const CFG &cfg) {
+  // 局部变量在函数返回后不可见，出口处全部不活跃
+  const auto &rpo = cfg.ReversePostOrder();
+  std::unordered_map<BasicBlock *, SlotSet> live_in;
+  for (BasicBlock *bb : rpo) {
+    live_in[bb] = SlotSet(slots_.size(), false);
+  }
+
+  auto live_out = [&](BasicBlock *bb) {
+    SlotSet out(slots_.size(), false);
+    for (BasicBlock *succ : cfg.Succs(bb)) {
+      const SlotSet &in = live_in[succ];
+      for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = out[i] || in[i];
+      }
+    }
+    return out;
+  };
+
+  // 逆向数据流按后序迭代收敛最快
+  bool progress = true;
+  while (progress) {
+    progress = false;
+    for (auto it = rpo.rbegin(); it != rpo.rend(); ++it) {
+      SlotSet in = Transfer(*it, live_out(*it), nullptr);
+      if (in != live_in[*it]) {
+        live_in[*it] = std::move(in);
+        progress = true;
+      }
+    }
+  }
+
+  // 不可达的基本块不会执行，保持原样
+  bool changed = false;
+  for (BasicBlock *bb : rpo) {
+    std::vector<Instruction *> dead;
+    Transfer(bb, live_out(bb), &dead);
+    if (dead.empty()) {
+      continue;
+    }
+    std::unordered_set<Instruction *> dead_set(dead.begin(), dead.end());
+    bb->EraseIf([&](Instruction *inst) { return dead_set.count(inst) > 0; });
+    changed = true;
+  }
+  return changed;
+}
+
+/**
+ * alloc 的所有使用都是 store 的目标地址时，变量从未被读取，
+ * 连同这些 store 一起删除，不再占用栈帧
+ */
+bool DeadStoreElimPass::RemoveUnreadAllocas(Function &func) {
+  std::unordered_set<Instruction *> dead;
+  for (auto &bb : func.blocks) {
+    for (auto &inst : bb->insts) {
+      if (inst->op != Opcode::Alloc) {
+        continue;
+      }
+      bool unread = true;
+      std::vector<Instruction *> stores;
+      for (const Use &use : func.Uses(inst->Result())) {
+        if (use.user->op != Opcode::Store ||
+            use.slot != &use.user->ValueAt(1)) {
+          unread = false;
+          break;
+        }
+        stores.push_back(use.user);
+      }
+      if (unread) {
+        dead.insert(inst.get());
+        dead.insert(stores.begin(), stores.end());
+      }
+    }
+  }
+
+  if (dead.empty()) {
+    return false;
+  }
+  for (auto &bb : func.blocks) {
+    bb->EraseIf([&](Instruction *inst) { return dead.count(inst) > 0; });
+  }
+  return true;
+}
@@ -0,0 +1,120 @@
+#include "opt/Dominators.h"
+
+#include <utility>
+
+namespace {
+
+const std::vector<BasicBlock *> kNoBlocks;
+const std::unordered_set<BasicBlock *> kNoFrontier;
+
+} // namespace
+
+DominatorTree::DominatorTree(const CFG &cfg) {
+  const auto &rpo = cfg.ReversePostOrder();
+  if (rpo.empty()) {
+    return;
+  }
+
+  // 沿两条支配链向上走，直到在逆后序中相遇
+  auto intersect = [&](BasicBlock *a, BasicBlock *b) {
+    while (a != b) {
+      while (cfg.RPOIndex(a) > cfg.RPOIndex(b)) {
+        a = idom_[a];
+      }
+      while (cfg.RPOIndex(b) > cfg.RPOIndex(a)) {
+        b = idom_[b];
+      }
+    }
+    return a;
+  };
+
+  BasicBlock *entry = rpo.front();
+  idom_[entry] = entry;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t i = 1; i < rpo.size(); ++i) {
+      BasicBlock *bb = rpo[i];
+      BasicBlock *new_idom = nullptr;
+      for (BasicBlock *pred : cfg.Preds(bb)) {
+        if (!idom_.count(pred)) {
+          continue;
+        }
+        new_idom = new_idom ? intersect(pred, new_idom) : pred;
+      }
+      auto it = idom_.find(bb);
+      if (new_idom && (it == idom_.end() || it->second != new_idom)) {
+        idom_[bb] = new_idom;
+        changed = true;
+      }
+    }
+  }
+  idom_[entry] = nullptr;
+
+  for (size_t i = 1; i < rpo.size(); ++i) {
+    children_[idom_[rpo[i]]].push_back(rpo[i]);
+  }
+
+  // 支配树上的 DFS 序号，a 支配 b 当且仅当 b 的区间包含在 a 的区间内
+  size_t clock = 0;
+  std::vector<std::pair<BasicBlock *, size_t>> stack{{entry, 0}};
+  dfs_range_[entry].first = clock++;
+  while (!stack.empty()) {
+    auto &[bb, next] = stack.back();
+    const auto &children = Children(bb);
+    if (next < children.size()) {
+      BasicBlock *child = children[next++];
+      dfs_range_[child].first = clock++;
+      stack.push_back({child, 0});
+    } else {
+      dfs_range_[bb].second = clock++;
+      stack.pop_back();
+    }
+  }
+}
+
+BasicBlock *DominatorTree::IDom(BasicBlock *bb) const {
+  auto it = idom_.find(bb);
+  return it == idom_.end() ? nullptr : it->second;
+}
+
+const std::vector<BasicBlock *> &
+DominatorTree::Children(BasicBlock *bb) const {
+  auto it = children_.find(bb);
+  return it == children_.end() ? kNoBlocks : it->second;
+}
+
+bool DominatorTree::Dominates(BasicBlock *a, BasicBlock *b) const {
+  auto ra = dfs_range_.find(a);
+  auto rb = dfs_range_.find(b);
+  if (ra == dfs_range_.end() || rb == dfs_range_.end()) {
+    return false;
+  }
+  return ra->second.first <= rb->second.first &&
+         rb->second.second <= ra->second.second;
+}
+
+DominanceFrontier::DominanceFrontier(const CFG &cfg,
+                                     const DominatorTree &dom_tree) {
+  for (BasicBlock *bb : cfg.ReversePostOrder()) {
+    const auto &preds = cfg.Preds(bb);
+    if (preds.size() < 2) {
+      continue;
+    }
+    for (BasicBlock *pred : preds) {
+      if (!cfg.IsReachable(pred)) {
+        continue;
+      }
+      for (BasicBlock *runner = pred; runner && runner != dom_tree.IDom(bb);
+           runner = dom_tree.IDom(runner)) {
+        frontier_[runner].insert(bb);
+      }
+    }
+  }
+}
+
+const std::unordered_set<BasicBlock *> &
+DominanceFrontier::Get(BasicBlock *bb) const {
+  auto it = frontier_.find(bb);
+  return it == frontier_.end() ? kNoFrontier : it->second;
+}
@@ -0,0 +1,154 @@
+#include "opt/IRUtils.h"
+#include "opt/CFG.h"
+
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+namespace IRUtils {
+
+bool IsPure(const Instruction &inst) {
+  return inst.IsBinary() || inst.op == Opcode::Load;
+}
+
+/**
+ * 借助 use 列表做工作表式删除：指令被注销后，其操作数的定义若随之
+ * 失去全部使用则加入工作表，整个过程与指令数成线性关系
+ */
+bool RemoveDeadInsts(Function &func) {
+  std::vector<Instruction *> worklist;
+  for (auto &bb : func.blocks) {
+    for (auto &inst : bb->insts) {
+      if (IsPure(*inst) && !func.HasUses(inst->Result())) {
+        worklist.push_back(inst.get());
+      }
+    }
+  }
+
+  std::unordered_set<Instruction *> dead;
+  while (!worklist.empty()) {
+    Instruction *inst = worklist.back();
+    worklist.pop_back();
+    if (dead.count(inst) || func.HasUses(inst->Result())) {
+      continue;
+    }
+    dead.insert(inst);
+    func.UntrackInst(inst);
+    inst->ForEachUse([&](const Value &value) {
+      Instruction *def = func.GetDef(value);
+      if (def && IsPure(*def) && !func.HasUses(def->Result())) {
+        worklist.push_back(def);
+      }
+    });
+  }
+
+  if (dead.empty()) {
+    return false;
+  }
+  for (auto &bb : func.blocks) {
+    bb->EraseIf([&](Instruction *inst) { return dead.count(inst) > 0; });
+  }
+  return true;
+}
+
+/**
+ * 先为全部副本建块并登记新名称，再复制指令，
+ * 使副本之间的前向跳转与跨块使用都能被正确改写
+ */
+std::vector<BasicBlock *> CloneBlocks(Function &func,
+                                      const std::vector<BasicBlock *> &blocks,
+                                      const std::string &label_prefix,
+                                      CloneMap &map) {
+  std::string id = std::to_string(func.NextTempId("clone"));
+  auto rename = [&](const std::string &name) {
+    return name.substr(0, 1) + id + "_" + name.substr(1);
+  };
+
+  // 副本与原块共用局部变量，先把 alloc 移到入口块，
+  // 之后无论删除哪一份都不会删掉另一份仍在使用的 alloc
+  BasicBlock *entry = func.blocks.front().get();
+  size_t hoisted = 0;
+  for (BasicBlock *bb : blocks) {
+    if (bb == entry) {
+      continue;
+    }
+    std::vector<Instruction *> allocs;
+    for (const auto &inst : bb->insts) {
+      if (inst->op == Opcode::Alloc) {
+        allocs.push_back(inst.get());
+      }
+    }
+    for (Instruction *alloc : allocs) {
+      entry->Insert(hoisted++, bb->Take(alloc));
+    }
+  }
+
+  std::vector<BasicBlock *> clones;
+  for (BasicBlock *bb : blocks) {
+    BasicBlock *clone = func.CreateBlock(label_prefix + bb->name);
+    for (const auto &[name, type] : bb->params) {
+      clone->params.push_back({rename(name), type});
+      map.values[name] = Value::Reg(rename(name));
+    }
+    for (const auto &inst : bb->insts) {
+      if (inst->HasResult() && inst->op != Opcode::Alloc) {
+        Value result = inst->Result();
+        result.reg_or_addr = rename(result.reg_or_addr);
+        map.values[inst->Result().reg_or_addr] = result;
+      }
+    }
+    map.blocks[bb] = clone;
+    clones.push_back(clone);
+  }
+
+  auto remap = [&](Value &value) {
+    if (value.isImmediate()) {
+      return;
+    }
+    auto it = map.values.find(value.reg_or_addr);
+    if (it != map.values.end()) {
+      value = it->second;
+    }
+  };
+
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    for (const auto &inst : blocks[i]->insts) {
+      if (inst->op == Opcode::Alloc) {
+        continue;
+      }
+      auto copy = std::make_unique<Instruction>(*inst);
+      copy->parent = nullptr;
+      for (auto &arg : copy->args) {
+        if (auto *value = std::get_if<Value>(&arg)) {
+          remap(*value);
+        } else if (auto *target = std::get_if<BranchTarget>(&arg)) {
+          auto it = map.blocks.find(target->target);
+          if (it != map.blocks.end()) {
+            target->target = it->second;
+          }
+          for (auto &value : target->args) {
+            remap(value);
+          }
+        }
+      }
+      clones[i]->Append(std::move(copy));
+    }
+  }
+  return clones;
+}
+
+bool RemoveUnreachableBlocks(Function &func) {
+  CFG cfg(func);
+  std::vector<BasicBlock *> dead;
+  for (auto &bb : func.blocks) {
+    if (!cfg.IsReachable(bb.get())) {
+      dead.push_back(bb.get());
+    }
+  }
+  for (BasicBlock *bb : dead) {
+    func.RemoveBlock(bb);
+  }
+  return !dead.empty();
+}
+
+} // namespace IRUtils
@@ -0,0 +1,394 @@
+#include "opt/IfConversion.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+bool IsImm(const Value &value, int32_t imm) {
+  return value.isImmediate() && value.imm == imm;
+}
+
+// 基本块以无参数的 jump 结尾时返回跳转目标
+BasicBlock *JumpTarget(BasicBlock *bb) {
+  if (bb->insts.empty() || bb->insts.back()->op != Opcode::Jmp) {
+    return nullptr;
+  }
+  const auto &target = std::get<BranchTarget>(bb->insts.back()->args[0]);
+  return target.args.empty() ? target.target : nullptr;
+}
+
+} // namespace
+
+bool IfConversionPass::Run(Function &func, AnalysisManager &am) {
+  func_ = &func;
+
+  bool changed = false;
+  bool progress = true;
+  while (progress) {
+    progress = false;
+    cfg_ = &am.GetCFG(func);
+
+    for (auto &bb : func.blocks) {
+      if (TryConvert(func, bb.get())) {
+        // 每次转换都会删除基本块，需要重新计算 CFG
+        am.Invalidate(func);
+        progress = changed = true;
+        break;
+      }
+    }
+  }
+  return changed;
+}
+
+/**
+ * 检查分支的一侧是否可以投机执行：只允许无副作用的运算、load 与 store，
+ * 且 load 不能出现在 store 之后（所有 store 会被推迟到选择之后）
+ */
+bool IfConversionPass::AnalyzeSide(BasicBlock *bb, BasicBlock *join,
+                                   Side &side, size_t &size) const {
+  if (bb == join || cfg_->Preds(bb).size() != 1) {
+    return false;
+  }
+
+  side.bb = bb;
+  bool seen_store = false;
+  for (size_t i = 0; i + 1 < bb->insts.size(); ++i) {
+    Instruction *inst = bb->insts[i].get();
+    switch (inst->op) {
+    case Opcode::Store: {
+      const Value &addr = inst->ValueAt(1);
+      auto it = std::find_if(side.stores.begin(), side.stores.end(),
+                             [&](const std::pair<Value, Value> &store) {
+                               return store.first.reg_or_addr ==
+                                      addr.reg_or_addr;
+                             });
+      if (it != side.stores.end()) {
+        it->second = inst->ValueAt(0);
+      } else {
+        side.stores.push_back({addr, inst->ValueAt(0)});
+      }
+      seen_store = true;
+      break;
+    }
+    case Opcode::Load:
+      if (seen_store) {
+        return false;
+      }
+      side.body.push_back(inst);
+      break;
+    case Opcode::Alloc:
+      side.body.push_back(inst);
+      break;
+    case Opcode::Div:
+    case Opcode::Mod: {
+      // 除数可能为 0 时不能投机执行
+      const Value &rhs = inst->ValueAt(2);
+      if (!rhs.isImmediate() || rhs.imm == 0 || rhs.imm == -1) {
+        return false;
+      }
+      side.body.push_back(inst);
+      break;
+    }
+    default:
+      if (!inst->IsBinary()) {
+        return false;
+      }
+      side.body.push_back(inst);
+      break;
+    }
+  }
+
+  size += bb->insts.size() - 1;
+  return true;
+}
+
+bool IfConversionPass::TryConvert(Function &func, BasicBlock *head) {
+  if (head->insts.empty() || head->insts.back()->op != Opcode::Br) {
+    return false;
+  }
+  Instruction *br = head->insts.back().get();
+  const auto &then_target = std::get<BranchTarget>(br->args[1]);
+  const auto &else_target = std::get<BranchTarget>(br->args[2]);
+  const Value cond = br->ValueAt(0);
+  if (!then_target.args.empty() || !else_target.args.empty() ||
+      cond.isImmediate()) {
+    return false;
+  }
+
+  BasicBlock *then_bb = then_target.target;
+  BasicBlock *else_bb = else_target.target;
+  if (then_bb == else_bb || then_bb == head || else_bb == head) {
+    return false;
+  }
+
+  // 菱形：两侧汇合到同一块；三角形：一侧直接跳到另一侧
+  Side then_side, else_side;
+  BasicBlock *join = nullptr;
+  size_t size = 0;
+  BasicBlock *then_join = JumpTarget(then_bb);
+  BasicBlock *else_join = JumpTarget(else_bb);
+  if (then_join && then_join == else_join) {
+    join = then_join;
+    if (!AnalyzeSide(then_bb, join, then_side, size) ||
+        !AnalyzeSide(else_bb, join, else_side, size)) {
+      return false;
+    }
+  } else if (then_join == else_bb) {
+    join = else_bb;
+    if (!AnalyzeSide(then_bb, join, then_side, size)) {
+      return false;
+    }
+  } else if (else_join == then_bb) {
+    join = then_bb;
+    if (!AnalyzeSide(else_bb, join, else_side, size)) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+  if (join == head || size > max_insts_) {
+    return false;
+  }
+
+  // 收集 load 的来源地址，用于识别两侧读取的是同一个变量
+  load_src_.clear();
+  std::unordered_map<std::string, size_t> last_store;
+  for (size_t i = 0; i < head->insts.size(); ++i) {
+    if (head->insts[i]->op == Opcode::Store) {
+      last_store[head->insts[i]->ValueAt(1).reg_or_addr] = i;
+    }
+  }
+  for (size_t i = 0; i < head->insts.size(); ++i) {
+    const Instruction *inst = head->insts[i].get();
+    if (inst->op != Opcode::Load) {
+      continue;
+    }
+    const std::string &addr = inst->ValueAt(1).reg_or_addr;
+    auto it = last_store.find(addr);
+    if (it == last_store.end() || it->second < i) {
+      load_src_[inst->Result().reg_or_addr] = addr;
+    }
+  }
+  for (const Side *side : {&then_side, &else_side}) {
+    for (const Instruction *inst : side->body) {
+      if (inst->op == Opcode::Load) {
+        load_src_[inst->Result().reg_or_addr] = inst->ValueAt(1).reg_or_addr;
+      }
+    }
+  }
+
+  // 条件需要是 0/1 才能构造掩码
+  emitted_.clear();
+  cond_def_ = GetDef(cond);
+  Value bool_cond = cond;
+  if (!KnownBitsAnalysis(func).IsBoolean(cond)) {
+    bool_cond = Emit(Opcode::Ne, cond, Value::Imm(0));
+  }
+
+  // 按出现顺序合并两侧写入的地址，缺失的一侧读取变量原来的值
+  std::vector<Value> addrs;
+  for (const Side *side : {&then_side, &else_side}) {
+    for (const auto &[addr, value] : side->stores) {
+      bool found = std::any_of(addrs.begin(), addrs.end(), [&](const Value &a) {
+        return a.reg_or_addr == addr.reg_or_addr;
+      });
+      if (!found) {
+        addrs.push_back(addr);
+      }
+    }
+  }
+  auto stored_value = [&](const Side &side, const Value &addr) {
+    for (const auto &[a, value] : side.stores) {
+      if (a.reg_or_addr == addr.reg_or_addr) {
+        return value;
+      }
+    }
+    Value reg = func.NewTempReg("ifcvt");
+    emitted_.push_back(std::make_unique<Instruction>(Opcode::Load, reg, addr));
+    load_src_[reg.reg_or_addr] = addr.reg_or_addr;
+    return reg;
+  };
+
+  mask_ = std::nullopt;
+  std::vector<std::pair<Value, Value>> stores;
+  for (const Value &addr : addrs) {
+    Value tv = stored_value(then_side, addr);
+    Value fv = stored_value(else_side, addr);
+    stores.push_back({addr, EmitSelect(bool_cond, tv, fv)});
+  }
+
+  // 重建 head：原有指令，两侧投机执行的指令，选择序列，store，跳转到汇合块
+  head->Erase(br);
+  for (const Side *side : {&then_side, &else_side}) {
+    for (Instruction *inst : side->body) {
+      head->Append(side->bb->Take(inst));
+    }
+  }
+  for (auto &inst : emitted_) {
+    head->Append(std::move(inst));
+  }
+  emitted_.clear();
+  for (const auto &[addr, value] : stores) {
+    head->Append(std::make_unique<Instruction>(Opcode::Store, value, addr));
+  }
+  head->Append(
+      std::make_unique<Instruction>(Opcode::Jmp, BranchTarget(join, {})));
+
+  if (then_side.bb) {
+    func.RemoveBlock(then_side.bb);
+  }
+  if (else_side.bb) {
+    func.RemoveBlock(else_side.bb);
+  }
+
+  MergeIntoPredecessor(func, head);
+  return true;
+}
+
+/**
+ * 汇合块只剩 head 一个前驱时并入 head，使相邻的 if 可以继续被转换
+ */
+bool IfConversionPass::MergeIntoPredecessor(Function &func, BasicBlock *head) {
+  BasicBlock *join = JumpTarget(head);
+  if (!join || join == func.exit_bb || join == func.blocks.front().get() ||
+      !join->params.empty()) {
+    return false;
+  }
+
+  for (auto &bb : func.blocks) {
+    if (bb->insts.empty() || bb.get() == head) {
+      continue;
+    }
+    for (auto &arg : bb->insts.back()->args) {
+      auto *target = std::get_if<BranchTarget>(&arg);
+      if (target && target->target == join) {
+        return false;
+      }
+    }
+  }
+
+  head->Erase(head->insts.back().get());
+  head->Splice(join);
+  func.RemoveBlock(join);
+  return true;
+}
+
+/**
+ * 生成 cond ? tv : fv，cond 为 0/1：
+ *   mask = 0 - cond;  res = fv + ((tv - fv) & mask)
+ */
+Value IfConversionPass::EmitSelect(const Value &cond, const Value &tv,
+                                   const Value &fv) {
+  if (Equivalent(tv, fv)) {
+    return tv;
+  }
+
+  Value result;
+  if (TryEmitAbs(cond, tv, fv, result)) {
+    return result;
+  }
+
+  // min/max：两侧的值就是比较的操作数时直接使用它们，省去重新读取
+  Value t = tv, f = fv;
+  if (cond_def_ && cond_def_->IsComparison()) {
+    for (Value *v : {&t, &f}) {
+      if (Equivalent(*v, cond_def_->ValueAt(1))) {
+        *v = cond_def_->ValueAt(1);
+      } else if (Equivalent(*v, cond_def_->ValueAt(2))) {
+        *v = cond_def_->ValueAt(2);
+      }
+    }
+  }
+
+  if (IsImm(t, 1) && IsImm(f, 0)) {
+    return cond;
+  }
+  if (IsImm(t, 0) && IsImm(f, 1)) {
+    return Emit(Opcode::Eq, cond, Value::Imm(0));
+  }
+
+  if (!mask_) {
+    mask_ = Emit(Opcode::Sub, Value::Imm(0), cond);
+  }
+  Value diff;
+  if (t.isImmediate() && f.isImmediate()) {
+    diff = Value::Imm(static_cast<int32_t>(static_cast<uint32_t>(t.imm) -
+                                           static_cast<uint32_t>(f.imm)));
+  } else {
+    diff = Emit(Opcode::Sub, t, f);
+  }
+  Value masked = Emit(Opcode::And, diff, *mask_);
+  return Emit(Opcode::Add, f, masked);
+}
+
+/**
+ * x < 0 ? -x : x（及其等价写法）=> (x ^ (x >> 31)) - (x >> 31)
+ */
+bool IfConversionPass::TryEmitAbs(const Value &cond, const Value &tv,
+                                  const Value &fv, Value &result) {
+  // cond_def_ 必须正是定义 cond 的比较，否则按它改写会选错值
+  if (!cond_def_ || !cond_def_->IsComparison() || cond.isImmediate() ||
+      cond_def_->Result().reg_or_addr != cond.reg_or_addr) {
+    return false;
+  }
+
+  Opcode op = cond_def_->op;
+  const Value &lhs = cond_def_->ValueAt(1);
+  const Value &rhs = cond_def_->ValueAt(2);
+  Value x;
+  bool negate_when_true;
+  if (IsImm(rhs, 0) && (op == Opcode::Lt || op == Opcode::Le)) {
+    x = lhs, negate_when_true = true;
+  } else if (IsImm(rhs, 0) && (op == Opcode::Gt || op == Opcode::Ge)) {
+    x = lhs, negate_when_true = false;
+  } else if (IsImm(lhs, 0) && (op == Opcode::Gt || op == Opcode::Ge)) {
+    x = rhs, negate_when_true = true;
+  } else if (IsImm(lhs, 0) && (op == Opcode::Lt || op == Opcode::Le)) {
+    x = rhs, negate_when_true = false;
+  } else {
+    return false;
+  }
+  if (!x.isRegister()) {
+    return false;
+  }
+
+  const Value &neg = negate_when_true ? tv : fv;
+  const Value &pos = negate_when_true ? fv : tv;
+  const Instruction *neg_def = GetDef(neg);
+  if (!Equivalent(pos, x) || !neg_def || neg_def->op != Opcode::Sub ||
+      !IsImm(neg_def->ValueAt(1), 0) || !Equivalent(neg_def->ValueAt(2), x)) {
+    return false;
+  }
+
+  Value sign = Emit(Opcode::Sar, x, Value::Imm(31));
+  Value flipped = Emit(Opcode::Xor, x, sign);
+  result = Emit(Opcode::Sub, flipped, sign);
+  return true;
+}
+
+/**
+ * 两个值相同：同名，或是在同一内存状态下读取同一地址的 load
+ */
+bool IfConversionPass::Equivalent(const Value &lhs, const Value &rhs) const {
+  if (lhs.isImmediate() || rhs.isImmediate()) {
+    return lhs.isImmediate() && rhs.isImmediate() && lhs.imm == rhs.imm;
+  }
+  if (lhs.reg_or_addr == rhs.reg_or_addr) {
+    return true;
+  }
+  auto l = load_src_.find(lhs.reg_or_addr);
+  auto r = load_src_.find(rhs.reg_or_addr);
+  return l != load_src_.end() && r != load_src_.end() &&
+         l->second == r->second;
+}
+
+const Instruction *IfConversionPass::GetDef(const Value &value) const {
+  return value.isRegister() ? func_->GetDef(value) : nullptr;
+}
+
+Value IfConversionPass::Emit(Opcode op, const Value &lhs, const Value &rhs) {
+  Value res = func_->NewTempReg("ifcvt");
+  emitted_.push_back(std::make_unique<Instruction>(op, res, lhs, rhs));
+  return res;
+}
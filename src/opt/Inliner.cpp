@@ -0,0 +1,285 @@
+#include "opt/Inliner.h"
+
+#include <algorithm>
+
+namespace {
+
+// 内联后调用者允许达到的最大指令数，防止多层内联导致代码膨胀
+constexpr size_t kMaxCallerSize = 2000;
+
+size_t CountInsts(const Function &func) {
+  size_t count = 0;
+  for (const auto &bb : func.blocks) {
+    count += bb->insts.size();
+  }
+  return count;
+}
+
+} // namespace
+
+bool InlinerPass::Run(IRModule &module, AnalysisManager &) {
+  BuildCallGraph(module);
+  ComputeSCCs(module);
+
+  bool changed = false;
+  for (const auto &scc : scc_order_) {
+    for (Function *caller : scc) {
+      // 先收集调用点，克隆进来的调用不再处理，避免无限展开
+      std::vector<Instruction *> calls;
+      for (auto &bb : caller->blocks) {
+        for (auto &inst : bb->insts) {
+          if (inst->op == Opcode::Call) {
+            calls.push_back(inst.get());
+          }
+        }
+      }
+      for (Instruction *call : calls) {
+        Function *callee = call->Callee();
+        if (!ShouldInline(*caller, *callee)) {
+          continue;
+        }
+        InlineCall(*caller, call);
+        size_[caller] = CountInsts(*caller);
+        changed = true;
+      }
+    }
+  }
+
+  changed |= RemoveDeadFunctions(module);
+  return changed;
+}
+
+void InlinerPass::BuildCallGraph(const IRModule &module) {
+  callees_.clear();
+  call_sites_.clear();
+  size_.clear();
+  for (const auto &func : module.GetFunctions()) {
+    auto &callees = callees_[func.get()];
+    size_[func.get()] = CountInsts(*func);
+    for (auto &bb : func->blocks) {
+      for (auto &inst : bb->insts) {
+        if (inst->op == Opcode::Call) {
+          callees.insert(inst->Callee());
+          ++call_sites_[inst->Callee()];
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Tarjan 算法按逆拓扑序产生强连通分量，即被调者先于调用者
+ */
+void InlinerPass::ComputeSCCs(const IRModule &module) {
+  scc_id_.clear();
+  scc_order_.clear();
+  dfs_index_.clear();
+  low_link_.clear();
+  scc_stack_.clear();
+  on_stack_.clear();
+  for (const auto &func : module.GetFunctions()) {
+    if (!dfs_index_.count(func.get())) {
+      VisitSCC(func.get());
+    }
+  }
+}
+
+void InlinerPass::VisitSCC(Function *func) {
+  int index = static_cast<int>(dfs_index_.size());
+  dfs_index_[func] = low_link_[func] = index;
+  scc_stack_.push_back(func);
+  on_stack_.insert(func);
+
+  for (Function *callee : callees_[func]) {
+    if (!dfs_index_.count(callee)) {
+      VisitSCC(callee);
+      low_link_[func] = std::min(low_link_[func], low_link_[callee]);
+    } else if (on_stack_.count(callee)) {
+      low_link_[func] = std::min(low_link_[func], dfs_index_[callee]);
+    }
+  }
+
+  if (low_link_[func] != dfs_index_[func]) {
+    return;
+  }
+  std::vector<Function *> scc;
+  Function *member;
+  do {
+    member = scc_stack_.back();
+    scc_stack_.pop_back();
+    on_stack_.erase(member);
+    scc_id_[member] = static_cast<int>(scc_order_.size());
+    scc.push_back(member);
+  } while (member != func);
+  // 只有声明的函数没有函数体，不需要处理
+  scc.erase(std::remove_if(scc.begin(), scc.end(),
+                           [](Function *f) { return f->IsDeclaration(); }),
+            scc.end());
+  scc_order_.push_back(std::move(scc));
+}
+
+/**
+ * 代价为被调函数的指令数，扣除内联后不再需要的调用、传参与 alloc
+ */
+size_t InlinerPass::InlineCost(const Function &callee) const {
+  size_t size = size_.at(&callee);
+  size_t saved = 1 + callee.params.size();
+  for (const auto &inst : callee.blocks.front()->insts) {
+    if (inst->op == Opcode::Alloc) {
+      ++saved;
+    }
+  }
+  return size > saved ? size - saved : 0;
+}
+
+bool InlinerPass::ShouldInline(const Function &caller,
+                               const Function &callee) const {
+  if (callee.IsDeclaration() || callee.name == "main") {
+    return false;
+  }
+  // 递归（自身或相互递归）展开不会终止
+  if (scc_id_.at(&callee) == scc_id_.at(&caller)) {
+    return false;
+  }
+
+  size_t cost = InlineCost(callee);
+  if (size_.at(&caller) + cost > kMaxCallerSize) {
+    return false;
+  }
+  auto sites = call_sites_.find(&callee);
+  bool single_site = sites != call_sites_.end() && sites->second == 1;
+  return cost <= (single_site ? threshold_ * 4 : threshold_);
+}
+
+/**
+ * 克隆出的基本块命名为 <caller>_inl<N>_<label>，在整个模块内唯一；
+ * 克隆出的值命名为 %N_<name> / @N_<name>，以数字开头不会与前端生成的名字冲突
+ */
+void InlinerPass::InlineCall(Function &caller, Instruction *call) {
+  Function *callee = call->Callee();
+  BasicBlock *bb = call->parent;
+  std::string id = std::to_string(caller.NextTempId("clone"));
+  std::string label_prefix = caller.name + "_inl" + id + "_";
+
+  auto rename = [&](const std::string &name) {
+    return name.substr(0, 1) + id + "_" + name.substr(1);
+  };
+
+  // 形参映射为实参，被调函数中定义的值重新命名
+  std::unordered_map<std::string, Value> value_map;
+  size_t first_arg = call->CalleeIndex() + 1;
+  for (size_t i = 0; i < callee->params.size(); ++i) {
+    value_map[callee->params[i].first] = call->ValueAt(first_arg + i);
+  }
+
+  std::unordered_map<BasicBlock *, BasicBlock *> block_map;
+  for (auto &callee_bb : callee->blocks) {
+    BasicBlock *clone = caller.CreateBlock(label_prefix + callee_bb->name);
+    for (const auto &[name, type] : callee_bb->params) {
+      clone->params.push_back({rename(name), type});
+      value_map[name] = Value::Reg(rename(name));
+    }
+    for (auto &inst : callee_bb->insts) {
+      if (inst->HasResult()) {
+        Value result = inst->Result();
+        result.reg_or_addr = rename(result.reg_or_addr);
+        value_map[inst->Result().reg_or_addr] = result;
+      }
+    }
+    block_map[callee_bb.get()] = clone;
+  }
+
+  // 调用点之后的指令移到后继块，返回值通过块参数传入
+  BasicBlock *cont = caller.CreateBlock(label_prefix + "cont");
+  size_t index = 0;
+  while (bb->insts[index].get() != call) {
+    ++index;
+  }
+  bb->SplitAt(index + 1, cont);
+  if (call->HasResult()) {
+    caller.ReplaceAllUsesWith(call->Result(), cont->AddParam("i32"));
+  }
+  bb->Erase(call);
+  bb->Append(std::make_unique<Instruction>(
+      Opcode::Jmp, BranchTarget(block_map.at(callee->blocks.front().get()),
+                                {})));
+
+  auto remap = [&](Value &value) {
+    if (value.isImmediate()) {
+      return;
+    }
+    auto it = value_map.find(value.reg_or_addr);
+    if (it != value_map.end()) {
+      value = it->second;
+    }
+  };
+
+  BasicBlock *caller_entry = caller.blocks.front().get();
+  for (auto &callee_bb : callee->blocks) {
+    BasicBlock *clone = block_map.at(callee_bb.get());
+    for (auto &inst : callee_bb->insts) {
+      if (inst->op == Opcode::Ret) {
+        std::vector<Value> ret_args;
+        if (!inst->args.empty() && cont->params.size() == 1) {
+          ret_args.push_back(inst->ValueAt(0));
+          remap(ret_args.back());
+        }
+        clone->Append(std::make_unique<Instruction>(
+            Opcode::Jmp, BranchTarget(cont, std::move(ret_args))));
+        continue;
+      }
+
+      auto copy = std::make_unique<Instruction>(*inst);
+      copy->parent = nullptr;
+      for (auto &arg : copy->args) {
+        if (auto *value = std::get_if<Value>(&arg)) {
+          remap(*value);
+        } else if (auto *target = std::get_if<BranchTarget>(&arg)) {
+          target->target = block_map.at(target->target);
+          for (auto &value : target->args) {
+            remap(value);
+          }
+        }
+      }
+
+      if (copy->op == Opcode::Call) {
+        ++call_sites_[copy->Callee()];
+      }
+      // 局部变量统一放在调用者的入口块，循环中的调用点不会重复分配
+      if (copy->op == Opcode::Alloc) {
+        caller_entry->Insert(0, std::move(copy));
+      } else {
+        clone->Append(std::move(copy));
+      }
+    }
+  }
+  --call_sites_[callee];
+}
+
+/**
+ * 删除内联后不再有调用点的函数，main 与库函数声明保留
+ */
+bool InlinerPass::RemoveDeadFunctions(IRModule &module) {
+  bool changed = false;
+  bool removed = true;
+  while (removed) {
+    removed = false;
+    for (const auto &func : module.GetFunctions()) {
+      if (func->name == "main" || func->IsDeclaration() ||
+          call_sites_[func.get()] > 0) {
+        continue;
+      }
+      for (auto &bb : func->blocks) {
+        for (auto &inst : bb->insts) {
+          if (inst->op == Opcode::Call) {
+            --call_sites_[inst->Callee()];
+          }
+        }
+      }
+      module.RemoveFunction(func.get());
+      removed = changed = true;
+      break;
+    }
+  }
+  return changed;
+}
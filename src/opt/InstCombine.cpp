@@ -0,0 +1,273 @@
+#include "opt/InstCombine.h"
+#include "opt/IRUtils.h"
+
+#include <cstdint>
+
+namespace {
+
+bool IsImm(const Value &value, int32_t imm) {
+  return value.isImmediate() && value.imm == imm;
+}
+
+bool SameValue(const Value &lhs, const Value &rhs) {
+  if (lhs.isImmediate() || rhs.isImmediate()) {
+    return lhs.isImmediate() && rhs.isImmediate() && lhs.imm == rhs.imm;
+  }
+  return lhs.reg_or_addr == rhs.reg_or_addr;
+}
+
+bool IsCommutative(Opcode op) {
+  return op == Opcode::Add || op == Opcode::Mul || op == Opcode::Eq ||
+         op == Opcode::Ne || op == Opcode::And || op == Opcode::Or ||
+         op == Opcode::Xor;
+}
+
+// 比较取反：!(a < b) == (a >= b)
+Opcode InvertComparison(Opcode op) {
+  switch (op) {
+  case Opcode::Lt:
+    return Opcode::Ge;
+  case Opcode::Gt:
+    return Opcode::Le;
+  case Opcode::Le:
+    return Opcode::Gt;
+  case Opcode::Ge:
+    return Opcode::Lt;
+  case Opcode::Eq:
+    return Opcode::Ne;
+  default:
+    return Opcode::Eq;
+  }
+}
+
+// 两个操作数都是常量时按 32 位补码语义求值
+std::optional<int32_t> Fold(Opcode op, int32_t l, int32_t r) {
+  uint32_t ul = static_cast<uint32_t>(l), ur = static_cast<uint32_t>(r);
+  switch (op) {
+  case Opcode::Add:
+    return static_cast<int32_t>(ul + ur);
+  case Opcode::Sub:
+    return static_cast<int32_t>(ul - ur);
+  case Opcode::Mul:
+    return static_cast<int32_t>(ul * ur);
+  case Opcode::Div:
+  case Opcode::Mod:
+    // 除零或溢出留给运行时
+    if (r == 0 || (l == INT32_MIN && r == -1)) {
+      return std::nullopt;
+    }
+    return op == Opcode::Div ? l / r : l % r;
+  case Opcode::Lt:
+    return l < r;
+  case Opcode::Gt:
+    return l > r;
+  case Opcode::Le:
+    return l <= r;
+  case Opcode::Ge:
+    return l >= r;
+  case Opcode::Eq:
+    return l == r;
+  case Opcode::Ne:
+    return l != r;
+  case Opcode::And:
+    return l & r;
+  case Opcode::Or:
+    return l | r;
+  case Opcode::Xor:
+    return l ^ r;
+  case Opcode::Sar:
+    return l >> (r & 31);
+  default:
+    return std::nullopt;
+  }
+}
+
+} // namespace
+
+bool InstCombinePass::Run(Function &func, AnalysisManager &) {
+  bool changed = false;
+  while (RunOnce(func)) {
+    changed = true;
+  }
+  return changed;
+}
+
+bool InstCombinePass::RunOnce(Function &func) {
+  KnownBitsAnalysis known(func);
+  func_ = &func;
+
+  bool changed = false;
+  for (auto &bb : func.blocks) {
+    for (auto &inst : bb->insts) {
+      if (inst->IsBinary()) {
+        Opcode old_op = inst->op;
+        if (auto simplified = Simplify(*inst, known)) {
+          // 沿 use 列表直接改写所有使用点，原指令留给死代码删除
+          func.ReplaceAllUsesWith(inst->Result(), *simplified);
+          changed = true;
+        } else if (inst->op != old_op) {
+          changed = true;
+        }
+      } else if (inst->op == Opcode::Br) {
+        changed |= SimplifyBranch(*inst);
+      }
+    }
+  }
+
+  changed |= IRUtils::RemoveDeadInsts(func);
+  return changed;
+}
+
+const Instruction *InstCombinePass::GetDef(const Value &value) const {
+  return value.isRegister() ? func_->GetDef(value) : nullptr;
+}
+
+/**
+ * 返回可以替换该指令结果的值；无法替换时返回 std::nullopt，
+ * 但指令本身可能已被原地改写为更简单的形式
+ */
+std::optional<Value>
+InstCombinePass::Simplify(Instruction &inst, const KnownBitsAnalysis &known) {
+  Value &lhs = inst.ValueAt(1);
+  Value &rhs = inst.ValueAt(2);
+
+  if (lhs.isImmediate() && rhs.isImmediate()) {
+    if (auto folded = Fold(inst.op, lhs.imm, rhs.imm)) {
+      return Value::Imm(*folded);
+    }
+    return std::nullopt;
+  }
+
+  // 交换律：常量放到右边，减少下面需要匹配的形式
+  if (IsCommutative(inst.op) && lhs.isImmediate()) {
+    Value imm = lhs;
+    func_->SetOperand(&inst, lhs, rhs);
+    func_->SetOperand(&inst, rhs, imm);
+  }
+
+  switch (inst.op) {
+  case Opcode::Add:
+    // x + 0 => x
+    if (IsImm(rhs, 0)) {
+      return lhs;
+    }
+    break;
+  case Opcode::Sub:
+    // x - 0 => x
+    if (IsImm(rhs, 0)) {
+      return lhs;
+    }
+    // x - x => 0
+    if (SameValue(lhs, rhs)) {
+      return Value::Imm(0);
+    }
+    // 0 - (0 - x) => x
+    if (IsImm(lhs, 0)) {
+      const Instruction *def = GetDef(rhs);
+      if (def && def->op == Opcode::Sub && IsImm(def->ValueAt(1), 0)) {
+        return def->ValueAt(2);
+      }
+    }
+    break;
+  case Opcode::Mul:
+    // x * 1 => x, x * 0 => 0
+    if (IsImm(rhs, 1)) {
+      return lhs;
+    }
+    if (IsImm(rhs, 0)) {
+      return Value::Imm(0);
+    }
+    break;
+  case Opcode::Div:
+    // x / 1 => x
+    if (IsImm(rhs, 1)) {
+      return lhs;
+    }
+    break;
+  case Opcode::Mod:
+    // x % 1 => 0
+    if (IsImm(rhs, 1) || IsImm(rhs, -1)) {
+      return Value::Imm(0);
+    }
+    break;
+  case Opcode::And:
+    if (IsImm(rhs, 0)) {
+      return Value::Imm(0);
+    }
+    if (IsImm(rhs, -1) || SameValue(lhs, rhs)) {
+      return lhs;
+    }
+    // b & 1 => b (b 为 0/1)
+    if (IsImm(rhs, 1) && known.IsBoolean(lhs)) {
+      return lhs;
+    }
+    break;
+  case Opcode::Or:
+    if (IsImm(rhs, 0) || SameValue(lhs, rhs)) {
+      return lhs;
+    }
+    break;
+  case Opcode::Ne:
+  case Opcode::Eq: {
+    if (SameValue(lhs, rhs)) {
+      return Value::Imm(inst.op == Opcode::Eq);
+    }
+    if (!rhs.isImmediate()) {
+      break;
+    }
+    KnownBits bits = known.Get(lhs);
+    // 已知位与常量矛盾时结果确定
+    uint32_t imm = static_cast<uint32_t>(rhs.imm);
+    if ((bits.one & ~imm) || (bits.zero & imm)) {
+      return Value::Imm(inst.op == Opcode::Ne);
+    }
+    if (bits.IsBoolean()) {
+      // ne b, 0 => b; eq b, 1 => b
+      if ((inst.op == Opcode::Ne && rhs.imm == 0) ||
+          (inst.op == Opcode::Eq && rhs.imm == 1)) {
+        return lhs;
+      }
+    }
+    // eq (cmp a, b), 0 => !cmp a, b
+    if (inst.op == Opcode::Eq && rhs.imm == 0) {
+      const Instruction *def = GetDef(lhs);
+      if (def && def->IsComparison()) {
+        inst.op = InvertComparison(def->op);
+        func_->SetOperand(&inst, lhs, def->ValueAt(1));
+        func_->SetOperand(&inst, rhs, def->ValueAt(2));
+        return std::nullopt;
+      }
+    }
+    break;
+  }
+  case Opcode::Lt:
+  case Opcode::Gt:
+    if (SameValue(lhs, rhs)) {
+      return Value::Imm(0);
+    }
+    break;
+  case Opcode::Le:
+  case Opcode::Ge:
+    if (SameValue(lhs, rhs)) {
+      return Value::Imm(1);
+    }
+    break;
+  default:
+    break;
+  }
+  return std::nullopt;
+}
+
+/**
+ * br 只关心条件是否非零：br (ne x, 0) => br x
+ */
+bool InstCombinePass::SimplifyBranch(Instruction &inst) {
+  Value &cond = inst.ValueAt(0);
+  const Instruction *def = GetDef(cond);
+  if (def && def->op == Opcode::Ne && IsImm(def->ValueAt(2), 0) &&
+      !def->ValueAt(1).isAddress()) {
+    func_->SetOperand(&inst, cond, def->ValueAt(1));
+    return true;
+  }
+  return false;
+}
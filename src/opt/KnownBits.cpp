@@ -0,0 +1,93 @@
+#include "opt/KnownBits.h"
+
+KnownBitsAnalysis::KnownBitsAnalysis(const Function &func) {
+  // 形参来自调用者，一无所知
+  for (const auto &param : func.params) {
+    known_.emplace(param.first, KnownBits());
+  }
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+
+    auto update = [&](const std::string &name, const KnownBits &bits) {
+      auto it = known_.find(name);
+      if (it == known_.end()) {
+        known_.emplace(name, bits);
+        changed = true;
+      } else if (it->second != it->second.Meet(bits)) {
+        it->second = it->second.Meet(bits);
+        changed = true;
+      }
+    };
+
+    for (const auto &bb : func.blocks) {
+      for (const auto &inst : bb->insts) {
+        // call、load 等无法分析的定义一律未知
+        if (inst->HasResult()) {
+          KnownBits bits;
+          if (inst->IsBinary()) {
+            bits = Transfer(*inst);
+          }
+          update(inst->Result().reg_or_addr, bits);
+        }
+
+        // 块参数：与每条入边上的实参交汇。
+        // 尚未到达的实参（如回边上的值）按未知处理，不能跳过这条边
+        for (const auto &arg : inst->args) {
+          auto *target = std::get_if<BranchTarget>(&arg);
+          if (!target) {
+            continue;
+          }
+          for (size_t i = 0; i < target->args.size(); ++i) {
+            update(target->target->params[i].first, Get(target->args[i]));
+          }
+        }
+      }
+    }
+  }
+}
+
+KnownBits KnownBitsAnalysis::Get(const Value &value) const {
+  KnownBits bits;
+  return Lookup(value, bits) ? bits : KnownBits();
+}
+
+bool KnownBitsAnalysis::Lookup(const Value &value, KnownBits &bits) const {
+  if (value.isImmediate()) {
+    bits = KnownBits::Constant(value.imm);
+    return true;
+  }
+  auto it = known_.find(value.reg_or_addr);
+  if (it == known_.end()) {
+    return false;
+  }
+  bits = it->second;
+  return true;
+}
+
+/**
+ * 计算二元运算结果的已知位，尚未到达的操作数按未知处理
+ */
+KnownBits KnownBitsAnalysis::Transfer(const Instruction &inst) const {
+  KnownBits lhs = Get(inst.ValueAt(1)), rhs = Get(inst.ValueAt(2));
+
+  switch (inst.op) {
+  case Opcode::Lt:
+  case Opcode::Gt:
+  case Opcode::Le:
+  case Opcode::Ge:
+  case Opcode::Eq:
+  case Opcode::Ne:
+    return KnownBits::Boolean();
+  case Opcode::And:
+    return {lhs.zero | rhs.zero, lhs.one & rhs.one};
+  case Opcode::Or:
+    return {lhs.zero & rhs.zero, lhs.one | rhs.one};
+  case Opcode::Xor:
+    return {(lhs.zero & rhs.zero) | (lhs.one & rhs.one),
+            (lhs.zero & rhs.one) | (lhs.one & rhs.zero)};
+  default:
+    return KnownBits();
+  }
+}
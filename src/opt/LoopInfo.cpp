@@ -0,0 +1,102 @@
+#include "opt/LoopInfo.h"
+
+#include <algorithm>
+
+std::vector<BasicBlock *> Loop::ExitBlocks(const CFG &cfg) const {
+  std::vector<BasicBlock *> exits;
+  for (BasicBlock *bb : blocks) {
+    for (BasicBlock *succ : cfg.Succs(bb)) {
+      if (!Contains(succ) &&
+          std::find(exits.begin(), exits.end(), succ) == exits.end()) {
+        exits.push_back(succ);
+      }
+    }
+  }
+  return exits;
+}
+
+LoopInfo::LoopInfo(const CFG &cfg, const DominatorTree &dom_tree) {
+  std::unordered_map<BasicBlock *, Loop *> by_header;
+
+  // 找出所有回边，同一 header 的回边合并为一个循环
+  for (BasicBlock *bb : cfg.ReversePostOrder()) {
+    for (BasicBlock *succ : cfg.Succs(bb)) {
+      if (!dom_tree.Dominates(succ, bb)) {
+        continue;
+      }
+      Loop *&loop = by_header[succ];
+      if (!loop) {
+        loops_.push_back(std::make_unique<Loop>());
+        loop = loops_.back().get();
+        loop->header = succ;
+        loop->block_set.insert(succ);
+      }
+      loop->latches.push_back(bb);
+
+      // 从 latch 逆向搜索到 header 为止，经过的块都在循环内
+      std::vector<BasicBlock *> worklist{bb};
+      while (!worklist.empty()) {
+        BasicBlock *cur = worklist.back();
+        worklist.pop_back();
+        if (!loop->block_set.insert(cur).second) {
+          continue;
+        }
+        for (BasicBlock *pred : cfg.Preds(cur)) {
+          if (cfg.IsReachable(pred)) {
+            worklist.push_back(pred);
+          }
+        }
+      }
+    }
+  }
+
+  for (auto &loop : loops_) {
+    for (BasicBlock *bb : cfg.ReversePostOrder()) {
+      if (loop->Contains(bb)) {
+        loop->blocks.push_back(bb);
+      }
+    }
+  }
+
+  // 按大小从大到小处理，外层循环先确定，内层循环的父循环是包含其 header
+  // 的最小已处理循环
+  std::vector<Loop *> sorted;
+  for (auto &loop : loops_) {
+    sorted.push_back(loop.get());
+  }
+  std::stable_sort(sorted.begin(), sorted.end(), [](Loop *a, Loop *b) {
+    return a->blocks.size() > b->blocks.size();
+  });
+  for (Loop *loop : sorted) {
+    auto it = innermost_.find(loop->header);
+    if (it != innermost_.end()) {
+      loop->parent = it->second;
+      it->second->sub_loops.push_back(loop);
+    } else {
+      top_level_.push_back(loop);
+    }
+    for (BasicBlock *bb : loop->blocks) {
+      innermost_[bb] = loop;
+    }
+  }
+}
+
+std::vector<Loop *> LoopInfo::LoopsInnermostFirst() const {
+  std::vector<Loop *> result;
+  std::vector<Loop *> stack(top_level_.begin(), top_level_.end());
+  while (!stack.empty()) {
+    Loop *loop = stack.back();
+    stack.pop_back();
+    result.push_back(loop);
+    for (Loop *sub : loop->sub_loops) {
+      stack.push_back(sub);
+    }
+  }
+  std::reverse(result.begin(), result.end());
+  return result;
+}
+
+Loop *LoopInfo::LoopFor(BasicBlock *bb) const {
+  auto it = innermost_.find(bb);
+  return it == innermost_.end() ? nullptr : it->second;
+}
@@ -0,0 +1,402 @@
+#include "opt/LoopUnroll.h"
+#include "opt/IRUtils.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// 完全展开后循环的指令总数上限
+constexpr size_t kFullUnrollBudget = 256;
+// 部分展开后循环体的指令总数上限
+constexpr size_t kPartialUnrollBudget = 128;
+
+bool FitsInt32(int64_t value) {
+  return value >= std::numeric_limits<int32_t>::min() &&
+         value <= std::numeric_limits<int32_t>::max();
+}
+
+// 交换比较的两个操作数
+Opcode SwapComparison(Opcode op) {
+  switch (op) {
+  case Opcode::Lt:
+    return Opcode::Gt;
+  case Opcode::Gt:
+    return Opcode::Lt;
+  case Opcode::Le:
+    return Opcode::Ge;
+  case Opcode::Ge:
+    return Opcode::Le;
+  default:
+    return op;
+  }
+}
+
+bool Compare(Opcode op, int64_t lhs, int64_t rhs) {
+  switch (op) {
+  case Opcode::Lt:
+    return lhs < rhs;
+  case Opcode::Gt:
+    return lhs > rhs;
+  case Opcode::Le:
+    return lhs <= rhs;
+  default:
+    return lhs >= rhs;
+  }
+}
+
+std::string NewLabelPrefix(Function &func) {
+  return func.name + "_unr" + std::to_string(func.NextTempId("unroll")) + "_";
+}
+
+// 用 jump 替换基本块的终结指令
+void ReplaceTerminator(BasicBlock *bb, BasicBlock *target) {
+  bb->Erase(bb->insts.back().get());
+  bb->Append(
+      std::make_unique<Instruction>(Opcode::Jmp, BranchTarget(target, {})));
+}
+
+} // namespace
+
+bool LoopUnrollPass::Run(Function &func, AnalysisManager &am) {
+  visited_.clear();
+
+  bool changed = false;
+  bool progress = true;
+  while (progress) {
+    progress = false;
+    const CFG &cfg = am.GetCFG(func);
+    for (Loop *loop : am.GetLoopInfo(func).LoopsInnermostFirst()) {
+      CountedLoop info;
+      if (visited_.count(loop->header->name) ||
+          !Analyze(func, loop, cfg, info)) {
+        continue;
+      }
+      visited_.insert(loop->header->name);
+      if (Unroll(func, info)) {
+        // 展开会增删基本块，重新计算循环信息后继续处理外层循环
+        am.Invalidate(func);
+        progress = changed = true;
+        break;
+      }
+    }
+  }
+
+  if (changed) {
+    IRUtils::RemoveDeadInsts(func);
+  }
+  return changed;
+}
+
+bool LoopUnrollPass::Analyze(Function &func, Loop *loop, const CFG &cfg,
+                             CountedLoop &info) const {
+  BasicBlock *header = loop->header;
+  if (!loop->sub_loops.empty() || loop->latches.size() != 1 ||
+      !header->params.empty()) {
+    return false;
+  }
+  info.loop = loop;
+  info.latch = loop->latches.front();
+
+  // 循环头只含纯指令，条件成立时留在循环内
+  Instruction *br = header->insts.back().get();
+  if (br->op != Opcode::Br) {
+    return false;
+  }
+  const auto &on_true = std::get<BranchTarget>(br->args[1]);
+  const auto &on_false = std::get<BranchTarget>(br->args[2]);
+  if (!on_true.args.empty() || !on_false.args.empty() ||
+      !loop->Contains(on_true.target) || loop->Contains(on_false.target)) {
+    return false;
+  }
+  info.body = on_true.target;
+  info.exit = on_false.target;
+  for (size_t i = 0; i + 1 < header->insts.size(); ++i) {
+    if (!IRUtils::IsPure(*header->insts[i])) {
+      return false;
+    }
+  }
+
+  Instruction *back_edge = info.latch->insts.back().get();
+  if (info.latch == header || back_edge->op != Opcode::Jmp ||
+      !std::get<BranchTarget>(back_edge->args[0]).args.empty()) {
+    return false;
+  }
+
+  // 只从循环头退出，循环内定义的值不在循环外使用
+  std::unordered_map<std::string, std::vector<Instruction *>> stores;
+  auto used_outside = [&](const Value &value) {
+    for (const Use &use : func.Uses(value)) {
+      if (!loop->Contains(use.user->parent)) {
+        return true;
+      }
+    }
+    return false;
+  };
+  for (BasicBlock *bb : loop->blocks) {
+    if (bb != header) {
+      for (BasicBlock *succ : cfg.Succs(bb)) {
+        if (!loop->Contains(succ)) {
+          return false;
+        }
+      }
+    }
+    for (const auto &[name, type] : bb->params) {
+      if (used_outside(Value::Reg(name))) {
+        return false;
+      }
+    }
+    for (auto &inst : bb->insts) {
+      ++info.size;
+      if (inst->op == Opcode::Store) {
+        stores[inst->ValueAt(1).reg_or_addr].push_back(inst.get());
+      } else if (inst->HasResult() && inst->op != Opcode::Alloc &&
+                 used_outside(inst->Result())) {
+        return false;
+      }
+    }
+  }
+
+  // 循环头在循环外的唯一前驱
+  for (BasicBlock *pred : cfg.Preds(header)) {
+    if (loop->Contains(pred)) {
+      continue;
+    }
+    if (info.preheader) {
+      return false;
+    }
+    info.preheader = pred;
+  }
+  if (!info.preheader || info.preheader->insts.back()->op != Opcode::Jmp) {
+    return false;
+  }
+
+  // 条件为循环头中读出的归纳变量与循环不变量的比较
+  Instruction *cond = func.GetDef(br->ValueAt(0));
+  if (!cond || cond->parent != header ||
+      (cond->op != Opcode::Lt && cond->op != Opcode::Gt &&
+       cond->op != Opcode::Le && cond->op != Opcode::Ge)) {
+    return false;
+  }
+  // 返回归纳变量在循环内唯一的 store，它必须位于回边块
+  auto induction_store = [&](const Value &value) -> Instruction * {
+    Instruction *load = func.GetDef(value);
+    if (!load || load->op != Opcode::Load || load->parent != header) {
+      return nullptr;
+    }
+    auto it = stores.find(load->ValueAt(1).reg_or_addr);
+    if (it == stores.end() || it->second.size() != 1 ||
+        it->second.front()->parent != info.latch) {
+      return nullptr;
+    }
+    return it->second.front();
+  };
+  const Value *bound = &cond->ValueAt(2);
+  info.cmp = cond->op;
+  Instruction *store = induction_store(cond->ValueAt(1));
+  if (!store) {
+    bound = &cond->ValueAt(1);
+    info.cmp = SwapComparison(cond->op);
+    store = induction_store(cond->ValueAt(2));
+  }
+  if (!store) {
+    return false;
+  }
+  info.iv = store->ValueAt(1).reg_or_addr;
+  if (!FindStep(func, info, store, info.step)) {
+    return false;
+  }
+
+  info.bound = *bound;
+  if (Instruction *def = func.GetDef(*bound);
+      def && loop->Contains(def->parent)) {
+    // 在循环头中读出的界，其地址在循环内不能被写入
+    if (def->op != Opcode::Load || def->parent != header ||
+        stores.count(def->ValueAt(1).reg_or_addr)) {
+      return false;
+    }
+    info.bound_addr = def->ValueAt(1).reg_or_addr;
+  }
+
+  // 前置块中最后一次写入归纳变量的常量即为初值，调用不会修改局部变量
+  auto &pre_insts = info.preheader->insts;
+  for (auto it = pre_insts.rbegin(); it != pre_insts.rend(); ++it) {
+    if ((*it)->op == Opcode::Store &&
+        (*it)->ValueAt(1).reg_or_addr == info.iv) {
+      if ((*it)->ValueAt(0).isImmediate()) {
+        info.init = (*it)->ValueAt(0).imm;
+      }
+      break;
+    }
+  }
+  return true;
+}
+
+/**
+ * 归纳变量的更新为 load @i 加减常量，load 位于 store 之前，
+ * 读到的是本次迭代开始时的值
+ */
+bool LoopUnrollPass::FindStep(Function &func, const CountedLoop &info,
+                              Instruction *store, int32_t &step) const {
+  Instruction *update = func.GetDef(store->ValueAt(0));
+  if (!update || (update->op != Opcode::Add && update->op != Opcode::Sub)) {
+    return false;
+  }
+  auto is_iv = [&](const Value &value) {
+    Instruction *def = func.GetDef(value);
+    return def && def->op == Opcode::Load &&
+           def->ValueAt(1).reg_or_addr == info.iv &&
+           info.loop->Contains(def->parent);
+  };
+
+  const Value &lhs = update->ValueAt(1);
+  const Value &rhs = update->ValueAt(2);
+  int64_t delta;
+  if (is_iv(lhs) && rhs.isImmediate()) {
+    delta = update->op == Opcode::Add ? rhs.imm : -int64_t{rhs.imm};
+  } else if (update->op == Opcode::Add && lhs.isImmediate() && is_iv(rhs)) {
+    delta = lhs.imm;
+  } else {
+    return false;
+  }
+  if (delta == 0 || !FitsInt32(delta)) {
+    return false;
+  }
+  step = static_cast<int32_t>(delta);
+  return true;
+}
+
+std::optional<size_t> LoopUnrollPass::TripCount(const CountedLoop &info,
+                                                size_t max_trips) const {
+  if (!info.init || !info.bound.isImmediate()) {
+    return std::nullopt;
+  }
+  int64_t iv = *info.init;
+  size_t trips = 0;
+  while (Compare(info.cmp, iv, info.bound.imm)) {
+    iv += info.step;
+    if (++trips > max_trips || !FitsInt32(iv)) {
+      return std::nullopt;
+    }
+  }
+  return trips;
+}
+
+bool LoopUnrollPass::Unroll(Function &func, const CountedLoop &info) {
+  size_t size = std::max<size_t>(info.size, 1);
+  if (auto trips = TripCount(info, kFullUnrollBudget / size)) {
+    FullyUnroll(func, info, *trips);
+    return true;
+  }
+  size_t factor = std::min(factor_, kPartialUnrollBudget / size);
+  return factor >= 2 && PartiallyUnroll(func, info, factor);
+}
+
+BasicBlock *LoopUnrollPass::Replicate(Function &func, const CountedLoop &info,
+                                      size_t copies, bool reuse_original,
+                                      BasicBlock *next,
+                                      const std::string &label_prefix) {
+  struct Copy {
+    BasicBlock *header;
+    BasicBlock *body;
+    BasicBlock *latch;
+  };
+  // 先从未修改的原循环完成全部克隆，再统一改写跳转
+  std::vector<Copy> parts;
+  for (size_t k = 0; k < copies; ++k) {
+    if (k == 0 && reuse_original) {
+      parts.push_back({info.loop->header, info.body, info.latch});
+      continue;
+    }
+    IRUtils::CloneMap map;
+    IRUtils::CloneBlocks(func, info.loop->blocks,
+                         label_prefix + std::to_string(k) + "_", map);
+    parts.push_back({map.blocks.at(info.loop->header),
+                     map.blocks.at(info.body), map.blocks.at(info.latch)});
+  }
+
+  for (size_t k = 0; k < copies; ++k) {
+    ReplaceTerminator(parts[k].header, parts[k].body);
+    ReplaceTerminator(parts[k].latch,
+                      k + 1 < copies ? parts[k + 1].header : next);
+  }
+  return parts.front().header;
+}
+
+/**
+ * 第 k 份循环体执行第 k 次迭代，最后一份之后直接离开循环；
+ * 循环头中的条件计算随之变为无用指令
+ */
+void LoopUnrollPass::FullyUnroll(Function &func, const CountedLoop &info,
+                                 size_t trips) {
+  if (trips == 0) {
+    ReplaceTerminator(info.loop->header, info.exit);
+  } else {
+    Replicate(func, info, trips, true, info.exit, NewLabelPrefix(func));
+  }
+  IRUtils::RemoveUnreachableBlocks(func);
+}
+
+/**
+ * 步长为 s 时，再执行 factor 次迭代的条件为 iv + (factor - 1) * s 仍满足比较，
+ * 守卫改写为 iv cmp (bound - (factor - 1) * s) 以避免 iv 一侧溢出；
+ * bound 一侧回绕时守卫不成立，交给原循环处理
+ */
+bool LoopUnrollPass::PartiallyUnroll(Function &func, const CountedLoop &info,
+                                     size_t factor) {
+  bool up = info.cmp == Opcode::Lt || info.cmp == Opcode::Le;
+  if (up != (info.step > 0)) {
+    return false;
+  }
+  int64_t distance = int64_t(factor - 1) * info.step;
+  if (!FitsInt32(distance)) {
+    return false;
+  }
+  int64_t limit = 0;
+  if (info.bound.isImmediate()) {
+    limit = info.bound.imm - distance;
+    if (!FitsInt32(limit)) {
+      return false;
+    }
+  }
+
+  std::string prefix = NewLabelPrefix(func);
+  BasicBlock *guard = func.CreateBlock(prefix + "guard");
+  auto emit = [&](Opcode op, const Value &lhs, const Value &rhs) {
+    Value res = func.NewTempReg("unroll");
+    guard->Append(std::make_unique<Instruction>(op, res, lhs, rhs));
+    return res;
+  };
+  Value iv = func.NewTempReg("unroll");
+  guard->Append(
+      std::make_unique<Instruction>(Opcode::Load, iv, Value::Addr(info.iv)));
+
+  Value ok;
+  if (info.bound.isImmediate()) {
+    ok = emit(info.cmp, iv, Value::Imm(static_cast<int32_t>(limit)));
+  } else {
+    Value bound = info.bound;
+    if (!info.bound_addr.empty()) {
+      bound = func.NewTempReg("unroll");
+      guard->Append(std::make_unique<Instruction>(
+          Opcode::Load, bound, Value::Addr(info.bound_addr)));
+    }
+    Value lim = emit(Opcode::Sub, bound,
+                     Value::Imm(static_cast<int32_t>(distance)));
+    Value no_wrap = emit(up ? Opcode::Lt : Opcode::Gt, lim, bound);
+    Value in_range = emit(info.cmp, iv, lim);
+    ok = emit(Opcode::And, no_wrap, in_range);
+  }
+
+  BasicBlock *unrolled = Replicate(func, info, factor, false, guard, prefix);
+  guard->Append(std::make_unique<Instruction>(
+      Opcode::Br, ok, BranchTarget(unrolled, {}),
+      BranchTarget(info.loop->header, {})));
+  ReplaceTerminator(info.preheader, guard);
+  visited_.insert(guard->name);
+  return true;
+}
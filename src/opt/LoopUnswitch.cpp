@@ -0,0 +1,221 @@
+#include "opt/LoopUnswitch.h"
+#include "opt/IRUtils.h"
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+
+namespace {
+
+// 循环头在循环外的唯一前驱，以无参数的 jump 进入循环
+BasicBlock *Preheader(Loop *loop, const CFG &cfg) {
+  if (!loop->header->params.empty()) {
+    return nullptr;
+  }
+  BasicBlock *preheader = nullptr;
+  for (BasicBlock *pred : cfg.Preds(loop->header)) {
+    if (loop->Contains(pred)) {
+      continue;
+    }
+    if (preheader) {
+      return nullptr;
+    }
+    preheader = pred;
+  }
+  if (!preheader || preheader->insts.back()->op != Opcode::Jmp) {
+    return nullptr;
+  }
+  return preheader;
+}
+
+// 用 jump 替换基本块的终结指令
+void ReplaceTerminator(BasicBlock *bb, BranchTarget target) {
+  bb->Erase(bb->insts.back().get());
+  bb->Append(std::make_unique<Instruction>(Opcode::Jmp, std::move(target)));
+}
+
+} // namespace
+
+bool LoopUnswitchPass::Run(Function &func, AnalysisManager &am) {
+  budget_ = threshold_;
+
+  bool changed = false;
+  bool progress = true;
+  while (progress) {
+    progress = false;
+    const CFG &cfg = am.GetCFG(func);
+    std::vector<Loop *> loops = am.GetLoopInfo(func).LoopsInnermostFirst();
+    // 外层循环优先，条件外提得越远收益越大
+    for (auto it = loops.rbegin(); it != loops.rend(); ++it) {
+      BasicBlock *preheader = Preheader(*it, cfg);
+      Candidate candidate;
+      if (!preheader || !FindCandidate(func, *it, candidate)) {
+        continue;
+      }
+      Unswitch(func, *it, preheader, candidate);
+      budget_ -= candidate.loop_size;
+      am.Invalidate(func);
+      progress = changed = true;
+      break;
+    }
+  }
+
+  if (changed) {
+    IRUtils::RemoveDeadInsts(func);
+  }
+  return changed;
+}
+
+bool LoopUnswitchPass::FindCandidate(Function &func, Loop *loop,
+                                     Candidate &candidate) {
+  loop_ = loop;
+  stored_.clear();
+  local_values_.clear();
+  for (BasicBlock *bb : loop->blocks) {
+    for (const auto &[name, type] : bb->params) {
+      local_values_.insert(name);
+    }
+    for (auto &inst : bb->insts) {
+      ++candidate.loop_size;
+      if (inst->op == Opcode::Store) {
+        stored_.insert(inst->ValueAt(1).reg_or_addr);
+      } else if (inst->op == Opcode::Alloc) {
+        local_values_.insert(inst->Result().reg_or_addr);
+      }
+    }
+  }
+  if (candidate.loop_size > budget_) {
+    return false;
+  }
+
+  // 两个版本的循环各自定义这些值，循环外的使用无法合并
+  auto used_outside = [&](const Value &value) {
+    const auto &uses = func.Uses(value);
+    return std::any_of(uses.begin(), uses.end(), [&](const Use &use) {
+      return !loop->Contains(use.user->parent);
+    });
+  };
+  for (BasicBlock *bb : loop->blocks) {
+    for (const auto &[name, type] : bb->params) {
+      if (used_outside(Value::Reg(name))) {
+        return false;
+      }
+    }
+    for (auto &inst : bb->insts) {
+      if (inst->HasResult() && inst->op != Opcode::Alloc &&
+          used_outside(inst->Result())) {
+        return false;
+      }
+    }
+  }
+
+  for (BasicBlock *bb : loop->blocks) {
+    Instruction *br = bb->insts.back().get();
+    if (br->op != Opcode::Br) {
+      continue;
+    }
+    BasicBlock *on_true = std::get<BranchTarget>(br->args[1]).target;
+    BasicBlock *on_false = std::get<BranchTarget>(br->args[2]).target;
+    // 循环的退出条件不在此处理
+    if (on_true == on_false || !loop->Contains(on_true) ||
+        !loop->Contains(on_false)) {
+      continue;
+    }
+    candidate.cond_insts.clear();
+    if (CollectInvariant(func, br->ValueAt(0), candidate.cond_insts)) {
+      candidate.br = br;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * 条件可以由循环外的值、循环内不被写入的变量的 load 以及纯运算得到；
+ * 除法与取模在循环前求值可能引入原本不会发生的除零，不外提
+ */
+bool LoopUnswitchPass::CollectInvariant(
+    Function &func, const Value &value,
+    std::vector<Instruction *> &insts) const {
+  if (value.isImmediate()) {
+    return true;
+  }
+  if (local_values_.count(value.reg_or_addr)) {
+    return false;
+  }
+  Instruction *def = func.GetDef(value);
+  if (!def || !loop_->Contains(def->parent) ||
+      std::find(insts.begin(), insts.end(), def) != insts.end()) {
+    return true;
+  }
+
+  if (def->op == Opcode::Load) {
+    const std::string &addr = def->ValueAt(1).reg_or_addr;
+    if (stored_.count(addr) || local_values_.count(addr)) {
+      return false;
+    }
+  } else if (def->IsBinary() && def->op != Opcode::Div &&
+             def->op != Opcode::Mod) {
+    if (!CollectInvariant(func, def->ValueAt(1), insts) ||
+        !CollectInvariant(func, def->ValueAt(2), insts)) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+  insts.push_back(def);
+  return true;
+}
+
+/**
+ *   preheader -> guard: cond' = ...; br cond', %loop, %loop'
+ * 原循环中的分支改为跳到 true 一侧，克隆循环中的改为跳到 false 一侧，
+ * 各自不再可达的部分随后删除
+ */
+void LoopUnswitchPass::Unswitch(Function &func, Loop *loop,
+                                BasicBlock *preheader,
+                                const Candidate &candidate) {
+  std::string prefix =
+      func.name + "_unsw" + std::to_string(func.NextTempId("unswitch")) + "_";
+  IRUtils::CloneMap map;
+  IRUtils::CloneBlocks(func, loop->blocks, prefix, map);
+
+  // 在守卫块中重新计算条件
+  BasicBlock *guard = func.CreateBlock(prefix + "guard");
+  std::unordered_map<std::string, Value> renamed;
+  auto remap = [&](Value value) {
+    if (!value.isImmediate()) {
+      auto it = renamed.find(value.reg_or_addr);
+      if (it != renamed.end()) {
+        return it->second;
+      }
+    }
+    return value;
+  };
+  for (Instruction *inst : candidate.cond_insts) {
+    auto copy = std::make_unique<Instruction>(*inst);
+    copy->parent = nullptr;
+    for (size_t i = 1; i < copy->args.size(); ++i) {
+      copy->ValueAt(i) = remap(copy->ValueAt(i));
+    }
+    Value res = func.NewTempReg("unswitch");
+    renamed[inst->Result().reg_or_addr] = res;
+    copy->args[0] = res;
+    guard->Append(std::move(copy));
+  }
+  guard->Append(std::make_unique<Instruction>(
+      Opcode::Br, remap(candidate.br->ValueAt(0)),
+      BranchTarget(loop->header, {}),
+      BranchTarget(map.blocks.at(loop->header), {})));
+
+  BasicBlock *bb = candidate.br->parent;
+  BasicBlock *clone_bb = map.blocks.at(bb);
+  BranchTarget on_true = std::get<BranchTarget>(candidate.br->args[1]);
+  BranchTarget on_false =
+      std::get<BranchTarget>(clone_bb->insts.back()->args[2]);
+  ReplaceTerminator(bb, std::move(on_true));
+  ReplaceTerminator(clone_bb, std::move(on_false));
+  ReplaceTerminator(preheader, BranchTarget(guard, {}));
+
+  IRUtils::RemoveUnreachableBlocks(func);
+}
@@ -0,0 +1,225 @@
+#include "opt/Mem2Reg.h"
+#include "opt/AnalysisManager.h"
+#include "opt/IRUtils.h"
+
+#include <memory>
+
+bool Mem2RegPass::Run(Function &func, AnalysisManager &am) {
+  allocs_.clear();
+  vars_.clear();
+  live_in_.clear();
+  params_.clear();
+  out_values_.clear();
+
+  // 不可达块不在支配树上，先删除
+  bool changed = IRUtils::RemoveUnreachableBlocks(func);
+  if (changed) {
+    am.Invalidate(func);
+  }
+  CollectPromotable(func);
+  if (allocs_.empty()) {
+    return changed;
+  }
+
+  const CFG &cfg = am.GetCFG(func);
+  ComputeLiveIn(cfg);
+  PlaceParams(cfg, am.GetDomFrontier(func));
+
+  std::vector<std::vector<Value>> stacks(allocs_.size());
+  Rename(func, am.GetDomTree(func), cfg.Entry(), stacks);
+  PassArgs(cfg);
+
+  for (Instruction *alloc : allocs_) {
+    alloc->parent->Erase(alloc);
+  }
+  IRUtils::RemoveDeadInsts(func);
+  return true;
+}
+
+int Mem2RegPass::VarOf(const Value &addr) const {
+  if (!addr.isAddress()) {
+    return -1;
+  }
+  auto it = vars_.find(addr.reg_or_addr);
+  return it == vars_.end() ? -1 : it->second;
+}
+
+// 地址只作为 load 的源或 store 的目标出现时才能提升
+void Mem2RegPass::CollectPromotable(Function &func) {
+  for (auto &bb : func.blocks) {
+    for (auto &inst : bb->insts) {
+      if (inst->op != Opcode::Alloc) {
+        continue;
+      }
+      bool promotable = true;
+      for (const Use &use : func.Uses(inst->Result())) {
+        Opcode op = use.user->op;
+        if ((op != Opcode::Load && op != Opcode::Store) ||
+            use.slot != &use.user->ValueAt(1)) {
+          promotable = false;
+          break;
+        }
+      }
+      if (promotable) {
+        vars_[inst->Result().reg_or_addr] = static_cast<int>(allocs_.size());
+        allocs_.push_back(inst.get());
+      }
+    }
+  }
+}
+
+/**
+ * 变量在块入口活跃：块内先读后写，或块内未写且在某个后继入口活跃
+ */
+void Mem2RegPass::ComputeLiveIn(const CFG &cfg) {
+  size_t n = allocs_.size();
+  std::unordered_map<BasicBlock *, VarSet> upward, killed;
+  for (BasicBlock *bb : cfg.ReversePostOrder()) {
+    VarSet &use = upward[bb];
+    VarSet &def = killed[bb];
+    use.assign(n, false);
+    def.assign(n, false);
+    for (auto &inst : bb->insts) {
+      if (inst->op != Opcode::Load && inst->op != Opcode::Store) {
+        continue;
+      }
+      int var = VarOf(inst->ValueAt(1));
+      if (var < 0) {
+        continue;
+      }
+      if (inst->op == Opcode::Load && !def[var]) {
+        use[var] = true;
+      } else if (inst->op == Opcode::Store) {
+        def[var] = true;
+      }
+    }
+    live_in_[bb] = use;
+  }
+
+  const auto &rpo = cfg.ReversePostOrder();
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto it = rpo.rbegin(); it != rpo.rend(); ++it) {
+      BasicBlock *bb = *it;
+      VarSet &live = live_in_[bb];
+      for (BasicBlock *succ : cfg.Succs(bb)) {
+        const VarSet &succ_live = live_in_[succ];
+        for (size_t v = 0; v < n; ++v) {
+          if (succ_live[v] && !killed[bb][v] && !live[v]) {
+            live[v] = true;
+            changed = true;
+          }
+        }
+      }
+    }
+  }
+}
+
+void Mem2RegPass::PlaceParams(const CFG &cfg,
+                              const DominanceFrontier &frontier) {
+  for (size_t var = 0; var < allocs_.size(); ++var) {
+    const std::string &addr = allocs_[var]->Result().reg_or_addr;
+    std::vector<BasicBlock *> worklist;
+    for (BasicBlock *bb : cfg.ReversePostOrder()) {
+      for (auto &inst : bb->insts) {
+        if (inst->op == Opcode::Store &&
+            inst->ValueAt(1).reg_or_addr == addr) {
+          worklist.push_back(bb);
+          break;
+        }
+      }
+    }
+
+    std::unordered_map<BasicBlock *, bool> placed;
+    while (!worklist.empty()) {
+      BasicBlock *bb = worklist.back();
+      worklist.pop_back();
+      for (BasicBlock *join : frontier.Get(bb)) {
+        if (placed[join] || !live_in_[join][var]) {
+          continue;
+        }
+        placed[join] = true;
+        params_[join].push_back(static_cast<int>(var));
+        // 块参数也是变量的一个定义
+        worklist.push_back(join);
+      }
+    }
+  }
+}
+
+/**
+ * 沿支配树先序遍历，stacks[var] 的栈顶为变量在当前位置的值
+ */
+void Mem2RegPass::Rename(Function &func, const DominatorTree &dom_tree,
+                         BasicBlock *bb,
+                         std::vector<std::vector<Value>> &stacks) {
+  std::vector<int> pushed;
+  for (int var : params_[bb]) {
+    stacks[var].push_back(bb->AddParam("i32"));
+    pushed.push_back(var);
+  }
+
+  auto current = [&](int var) {
+    return stacks[var].empty() ? Value::Imm(0) : stacks[var].back();
+  };
+
+  std::vector<Instruction *> dead;
+  for (auto &inst : bb->insts) {
+    if (inst->op != Opcode::Load && inst->op != Opcode::Store) {
+      continue;
+    }
+    int var = VarOf(inst->ValueAt(1));
+    if (var < 0) {
+      continue;
+    }
+    if (inst->op == Opcode::Load) {
+      func.ReplaceAllUsesWith(inst->Result(), current(var));
+    } else {
+      stacks[var].push_back(inst->ValueAt(0));
+      pushed.push_back(var);
+    }
+    dead.push_back(inst.get());
+  }
+  for (Instruction *inst : dead) {
+    bb->Erase(inst);
+  }
+
+  auto &out = out_values_[bb];
+  for (size_t var = 0; var < allocs_.size(); ++var) {
+    out.push_back(current(static_cast<int>(var)));
+  }
+
+  for (BasicBlock *child : dom_tree.Children(bb)) {
+    Rename(func, dom_tree, child, stacks);
+  }
+  for (int var : pushed) {
+    stacks[var].pop_back();
+  }
+}
+
+// 跳转到添加了参数的块时，按参数顺序追加前驱末尾的变量值
+void Mem2RegPass::PassArgs(const CFG &cfg) {
+  for (BasicBlock *bb : cfg.ReversePostOrder()) {
+    bool needs_args = false;
+    for (BasicBlock *succ : cfg.Succs(bb)) {
+      needs_args |= !params_[succ].empty();
+    }
+    if (!needs_args) {
+      continue;
+    }
+
+    // 修改实参列表前先摘下终结指令，重新插入时再登记使用
+    auto term = bb->Take(bb->insts.back().get());
+    for (auto &arg : term->args) {
+      auto *target = std::get_if<BranchTarget>(&arg);
+      if (!target) {
+        continue;
+      }
+      for (int var : params_[target->target]) {
+        target->args.push_back(out_values_.at(bb)[var]);
+      }
+    }
+    bb->Append(std::move(term));
+  }
+}
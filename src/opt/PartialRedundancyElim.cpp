@@ -0,0 +1,471 @@
+#include "opt/PartialRedundancyElim.h"
+#include "opt/AnalysisManager.h"
+#include "opt/IRUtils.h"
+
+#include <algorithm>
+#include <memory>
+#include <unordered_set>
+
+namespace {
+
+const std::string kParamPrefix = "param:";
+
+bool IsCommutative(Opcode op) {
+  return op == Opcode::Add || op == Opcode::Mul || op == Opcode::Eq ||
+         op == Opcode::Ne || op == Opcode::And || op == Opcode::Or ||
+         op == Opcode::Xor;
+}
+
+size_t IndexOf(const BasicBlock *bb, const Instruction *inst) {
+  size_t index = 0;
+  while (bb->insts[index].get() != inst) {
+    ++index;
+  }
+  return index;
+}
+
+void Intersect(std::vector<bool> &lhs, const std::vector<bool> &rhs) {
+  for (size_t i = 0; i < lhs.size(); ++i) {
+    lhs[i] = lhs[i] && rhs[i];
+  }
+}
+
+} // namespace
+
+bool PartialRedundancyElimPass::Run(Function &func, AnalysisManager &am) {
+  exprs_.clear();
+  expr_ids_.clear();
+  var_exprs_.clear();
+  blocks_.clear();
+  inserts_.clear();
+  split_.clear();
+
+  const CFG &cfg = am.GetCFG(func);
+  bool changed = false;
+  for (BasicBlock *bb : cfg.ReversePostOrder()) {
+    changed |= ScanBlock(func, bb);
+  }
+  if (!exprs_.empty()) {
+    ComputeLocalSets(cfg);
+    ComputeGlobalSets(cfg);
+    changed |= Transform(func, cfg);
+  }
+
+  if (changed) {
+    IRUtils::RemoveDeadInsts(func);
+  }
+  return changed;
+}
+
+int PartialRedundancyElimPass::InternExpr(
+    Opcode op, const std::string &lhs, const std::string &rhs,
+    const std::vector<std::string> &vars) {
+  std::string key = "(" + std::to_string(static_cast<int>(op)) + " " + lhs +
+                    " " + rhs + ")";
+  auto it = expr_ids_.find(key);
+  if (it != expr_ids_.end()) {
+    return it->second;
+  }
+  int id = static_cast<int>(exprs_.size());
+  exprs_.push_back({key, op, lhs, rhs, vars});
+  expr_ids_[key] = id;
+  for (const auto &var : vars) {
+    var_exprs_[var].push_back(id);
+  }
+  return id;
+}
+
+/**
+ * 寄存器的键只在块内有效：记录它依赖的变量在读取时的写入次数，
+ * 其后有 store 改写了这些变量时不能再作为操作数
+ */
+bool PartialRedundancyElimPass::ScanBlock(Function &func, BasicBlock *bb) {
+  struct Key {
+    std::string key;
+    std::vector<std::pair<std::string, int>> deps; // (变量, 写入次数)
+  };
+  std::unordered_map<std::string, Key> regs;
+  std::unordered_map<std::string, int> version;
+  std::unordered_set<std::string> params;
+  for (const auto &param : func.params) {
+    params.insert(param.first);
+  }
+
+  auto operand = [&](const Value &value, Key &key) {
+    if (value.isImmediate()) {
+      key = {"#" + std::to_string(value.imm), {}};
+      return true;
+    }
+    if (params.count(value.reg_or_addr)) {
+      key = {kParamPrefix + value.reg_or_addr, {}};
+      return true;
+    }
+    auto it = regs.find(value.reg_or_addr);
+    if (it == regs.end()) {
+      return false;
+    }
+    for (const auto &[var, count] : it->second.deps) {
+      if (version[var] != count) {
+        return false;
+      }
+    }
+    key = it->second;
+    return true;
+  };
+
+  BlockInfo &info = blocks_[bb];
+  std::unordered_set<std::string> stored;
+  std::unordered_map<int, Value> available;
+  std::vector<Instruction *> redundant;
+  for (auto &inst_ptr : bb->insts) {
+    Instruction *inst = inst_ptr.get();
+    if (inst->op == Opcode::Load) {
+      const std::string &var = inst->ValueAt(1).reg_or_addr;
+      regs[inst->Result().reg_or_addr] = {var, {{var, version[var]}}};
+      continue;
+    }
+    if (inst->op == Opcode::Store) {
+      const std::string &var = inst->ValueAt(1).reg_or_addr;
+      ++version[var];
+      if (stored.insert(var).second) {
+        info.stored.push_back(var);
+      }
+      for (int id : var_exprs_[var]) {
+        available.erase(id);
+        auto it = info.locals.find(id);
+        if (it != info.locals.end()) {
+          it->second.downward = nullptr;
+        }
+      }
+      continue;
+    }
+    if (!inst->IsBinary() || inst->op == Opcode::Div ||
+        inst->op == Opcode::Mod) {
+      continue;
+    }
+
+    Key lhs, rhs;
+    if (!operand(inst->ValueAt(1), lhs) || !operand(inst->ValueAt(2), rhs)) {
+      continue;
+    }
+    if (IsCommutative(inst->op) && rhs.key < lhs.key) {
+      std::swap(lhs, rhs);
+    }
+    std::vector<std::pair<std::string, int>> deps = lhs.deps;
+    deps.insert(deps.end(), rhs.deps.begin(), rhs.deps.end());
+    std::vector<std::string> vars;
+    for (const auto &dep : deps) {
+      if (std::find(vars.begin(), vars.end(), dep.first) == vars.end()) {
+        vars.push_back(dep.first);
+      }
+    }
+    int id = InternExpr(inst->op, lhs.key, rhs.key, vars);
+    regs[inst->Result().reg_or_addr] = {exprs_[id].key, deps};
+
+    // 块内已经计算过且未失效，直接复用
+    auto it = available.find(id);
+    if (it != available.end()) {
+      func.ReplaceAllUsesWith(inst->Result(), it->second);
+      redundant.push_back(inst);
+      continue;
+    }
+    available[id] = inst->Result();
+
+    Local &local = info.locals[id];
+    bool killed = std::any_of(vars.begin(), vars.end(), [&](const auto &var) {
+      return stored.count(var) > 0;
+    });
+    if (!local.upward && !killed) {
+      local.upward = inst;
+    }
+    local.downward = inst;
+  }
+
+  for (Instruction *inst : redundant) {
+    bb->Erase(inst);
+  }
+  return !redundant.empty();
+}
+
+void PartialRedundancyElimPass::ComputeLocalSets(const CFG &cfg) {
+  size_t n = exprs_.size();
+  for (BasicBlock *bb : cfg.ReversePostOrder()) {
+    BlockInfo &info = blocks_[bb];
+    info.antloc.assign(n, false);
+    info.comp.assign(n, false);
+    info.transp.assign(n, true);
+    for (const auto &[id, local] : info.locals) {
+      info.antloc[id] = local.upward != nullptr;
+      info.comp[id] = local.downward != nullptr;
+    }
+    for (const auto &var : info.stored) {
+      for (int id : var_exprs_[var]) {
+        info.transp[id] = false;
+      }
+    }
+  }
+}
+
+/**
+ * 基于边的 LCM：
+ *   EARLIEST(i,j) = ANTIN(j) & ~AVOUT(i) & (~TRANSP(i) | ~ANTOUT(i))
+ *   LATER(i,j)    = EARLIEST(i,j) | (LATERIN(i) & ~ANTLOC(i))
+ *   LATERIN(j)    = 所有入边 LATER 的交集
+ *   INSERT(i,j)   = LATER(i,j) & ~LATERIN(j)
+ *   DELETE(b)     = ANTLOC(b) & ~LATERIN(b)
+ */
+void PartialRedundancyElimPass::ComputeGlobalSets(const CFG &cfg) {
+  size_t n = exprs_.size();
+  const auto &rpo = cfg.ReversePostOrder();
+  BasicBlock *entry = cfg.Entry();
+  ExprSet empty(n, false);
+  ExprSet full(n, true);
+  for (BasicBlock *bb : rpo) {
+    BlockInfo &info = blocks_[bb];
+    info.av_out = full;
+    info.ant_in = full;
+    info.later_in = full;
+  }
+
+  auto preds_of = [&](BasicBlock *bb) {
+    std::vector<BasicBlock *> preds;
+    for (BasicBlock *pred : cfg.Preds(bb)) {
+      if (cfg.IsReachable(pred)) {
+        preds.push_back(pred);
+      }
+    }
+    return preds;
+  };
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (BasicBlock *bb : rpo) {
+      BlockInfo &info = blocks_[bb];
+      ExprSet av_in = bb == entry ? empty : full;
+      for (BasicBlock *pred : preds_of(bb)) {
+        Intersect(av_in, blocks_[pred].av_out);
+      }
+      ExprSet av_out(n);
+      for (size_t i = 0; i < n; ++i) {
+        av_out[i] = info.comp[i] || (av_in[i] && info.transp[i]);
+      }
+      if (av_out != info.av_out) {
+        info.av_out = std::move(av_out);
+        changed = true;
+      }
+    }
+  }
+
+  changed = true;
+  while (changed) {
+    changed = false;
+    for (auto it = rpo.rbegin(); it != rpo.rend(); ++it) {
+      BlockInfo &info = blocks_[*it];
+      const auto &succs = cfg.Succs(*it);
+      info.ant_out = succs.empty() ? empty : full;
+      for (BasicBlock *succ : succs) {
+        Intersect(info.ant_out, blocks_[succ].ant_in);
+      }
+      ExprSet ant_in(n);
+      for (size_t i = 0; i < n; ++i) {
+        ant_in[i] = info.antloc[i] || (info.ant_out[i] && info.transp[i]);
+      }
+      if (ant_in != info.ant_in) {
+        info.ant_in = std::move(ant_in);
+        changed = true;
+      }
+    }
+  }
+
+  auto later = [&](BasicBlock *from, BasicBlock *to) {
+    const BlockInfo &src = blocks_[from];
+    const BlockInfo &dst = blocks_[to];
+    ExprSet result(n);
+    for (size_t i = 0; i < n; ++i) {
+      bool earliest = dst.ant_in[i] && !src.av_out[i] &&
+                      (!src.transp[i] || !src.ant_out[i]);
+      result[i] = earliest || (src.later_in[i] && !src.antloc[i]);
+    }
+    return result;
+  };
+
+  // 入口视为从虚拟起点进入的边，最早插入点即为入口
+  blocks_[entry].later_in = blocks_[entry].ant_in;
+  changed = true;
+  while (changed) {
+    changed = false;
+    for (BasicBlock *bb : rpo) {
+      if (bb == entry) {
+        continue;
+      }
+      ExprSet later_in = full;
+      for (BasicBlock *pred : preds_of(bb)) {
+        Intersect(later_in, later(pred, bb));
+      }
+      if (later_in != blocks_[bb].later_in) {
+        blocks_[bb].later_in = std::move(later_in);
+        changed = true;
+      }
+    }
+  }
+
+  for (BasicBlock *bb : rpo) {
+    for (BasicBlock *pred : preds_of(bb)) {
+      ExprSet insert = later(pred, bb);
+      bool any = false;
+      for (size_t i = 0; i < n; ++i) {
+        insert[i] = insert[i] && !blocks_[bb].later_in[i];
+        any |= insert[i];
+      }
+      if (any) {
+        inserts_.push_back({{pred, bb}, std::move(insert)});
+      }
+    }
+  }
+}
+
+bool PartialRedundancyElimPass::Transform(Function &func, const CFG &cfg) {
+  const auto &rpo = cfg.ReversePostOrder();
+  BasicBlock *entry = cfg.Entry();
+
+  bool changed = false;
+  for (size_t id = 0; id < exprs_.size(); ++id) {
+    std::vector<BasicBlock *> deletes;
+    for (BasicBlock *bb : rpo) {
+      const BlockInfo &info = blocks_[bb];
+      if (info.antloc[id] && !info.later_in[id]) {
+        deletes.push_back(bb);
+      }
+    }
+    if (deletes.empty()) {
+      continue;
+    }
+    std::vector<Edge> edges;
+    for (const auto &[edge, insert] : inserts_) {
+      if (insert[id]) {
+        edges.push_back(edge);
+      }
+    }
+    if (!std::all_of(edges.begin(), edges.end(), [&](const Edge &edge) {
+          return CanInsertOn(cfg, edge);
+        })) {
+      continue;
+    }
+
+    Value slot =
+        Value::Addr("@pre_" + std::to_string(func.NextTempId("pre")));
+    entry->Insert(0, std::make_unique<Instruction>(Opcode::Alloc, slot));
+
+    // 保留的计算把结果写入 @pre，供之后被删除的计算读取
+    for (BasicBlock *bb : rpo) {
+      auto it = blocks_[bb].locals.find(static_cast<int>(id));
+      if (it == blocks_[bb].locals.end() || !it->second.downward) {
+        continue;
+      }
+      Instruction *inst = it->second.downward;
+      bool deleted = inst == it->second.upward &&
+                     std::find(deletes.begin(), deletes.end(), bb) !=
+                         deletes.end();
+      if (!deleted) {
+        bb->Insert(IndexOf(bb, inst) + 1,
+                   std::make_unique<Instruction>(Opcode::Store,
+                                                 inst->Result(), slot));
+      }
+    }
+
+    for (const Edge &edge : edges) {
+      size_t index;
+      BasicBlock *bb = InsertionPoint(func, cfg, edge, index);
+      Value value = Materialize(func, exprs_[id].key, bb, index);
+      bb->Insert(index,
+                 std::make_unique<Instruction>(Opcode::Store, value, slot));
+    }
+
+    for (BasicBlock *bb : deletes) {
+      Instruction *inst = blocks_[bb].locals.at(static_cast<int>(id)).upward;
+      Value reg = func.NewTempReg("pre");
+      bb->Insert(IndexOf(bb, inst),
+                 std::make_unique<Instruction>(Opcode::Load, reg, slot));
+      func.ReplaceAllUsesWith(inst->Result(), reg);
+      bb->Erase(inst);
+    }
+    changed = true;
+  }
+  return changed;
+}
+
+Value PartialRedundancyElimPass::Materialize(Function &func,
+                                             const std::string &key,
+                                             BasicBlock *bb, size_t &index) {
+  if (key[0] == '#') {
+    return Value::Imm(std::stoi(key.substr(1)));
+  }
+  if (key.compare(0, kParamPrefix.size(), kParamPrefix) == 0) {
+    return Value::Reg(key.substr(kParamPrefix.size()));
+  }
+
+  Value res = func.NewTempReg("pre");
+  if (key[0] != '(') {
+    bb->Insert(index++, std::make_unique<Instruction>(Opcode::Load, res,
+                                                      Value::Addr(key)));
+    return res;
+  }
+  const Expr &expr = exprs_[expr_ids_.at(key)];
+  Value lhs = Materialize(func, expr.lhs, bb, index);
+  Value rhs = Materialize(func, expr.rhs, bb, index);
+  bb->Insert(index++, std::make_unique<Instruction>(expr.op, res, lhs, rhs));
+  return res;
+}
+
+// 关键边拆分时要求终结指令中只有一个目标指向该后继
+bool PartialRedundancyElimPass::CanInsertOn(const CFG &cfg,
+                                            const Edge &edge) const {
+  auto [from, to] = edge;
+  if (cfg.Succs(from).size() == 1 || cfg.Preds(to).size() == 1) {
+    return true;
+  }
+  size_t count = 0;
+  for (const auto &arg : from->insts.back()->args) {
+    const auto *target = std::get_if<BranchTarget>(&arg);
+    count += target && target->target == to;
+  }
+  return count == 1;
+}
+
+BasicBlock *PartialRedundancyElimPass::InsertionPoint(Function &func,
+                                                      const CFG &cfg,
+                                                      const Edge &edge,
+                                                      size_t &index) {
+  auto [from, to] = edge;
+  if (cfg.Succs(from).size() == 1) {
+    index = from->insts.size() - 1;
+    return from;
+  }
+  if (cfg.Preds(to).size() == 1) {
+    index = 0;
+    return to;
+  }
+
+  auto it = split_.find(edge);
+  if (it == split_.end()) {
+    BasicBlock *mid = func.CreateBlock(
+        func.name + "_pre_split" + std::to_string(func.NextTempId("pre")));
+    // 块参数由新块转交给原后继
+    auto term = from->Take(from->insts.back().get());
+    std::vector<Value> args;
+    for (auto &arg : term->args) {
+      auto *target = std::get_if<BranchTarget>(&arg);
+      if (target && target->target == to) {
+        args = std::move(target->args);
+        *target = BranchTarget(mid, {});
+      }
+    }
+    from->Append(std::move(term));
+    mid->Append(std::make_unique<Instruction>(
+        Opcode::Jmp, BranchTarget(to, std::move(args))));
+    it = split_.emplace(edge, mid).first;
+  }
+  index = it->second->insts.size() - 1;
+  return it->second;
+}
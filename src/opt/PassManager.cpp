@@ -0,0 +1,194 @@
+#include "opt/PassManager.h"
+#include "opt/CodeSinking.h"
+#include "opt/DeadStoreElim.h"
+#include "opt/IfConversion.h"
+#include "opt/Inliner.h"
+#include "opt/InstCombine.h"
+#include "opt/LoopUnroll.h"
+#include "opt/LoopUnswitch.h"
+#include "opt/Mem2Reg.h"
+#include "opt/PartialRedundancyElim.h"
+#include "opt/Reassociate.h"
+#include "opt/TailCallElim.h"
+#include "opt/ValueRangeProp.h"
+#include "ir/IRSerializer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+size_t CountInsts(const IRModule &module) {
+  size_t count = 0;
+  for (const auto &func : module.GetFunctions()) {
+    for (const auto &bb : func->blocks) {
+      count += bb->insts.size();
+    }
+  }
+  return count;
+}
+
+} // namespace
+
+void PassManager::AddPass(std::unique_ptr<FunctionPass> pass) {
+  passes_.push_back({std::move(pass), nullptr});
+}
+
+void PassManager::AddPass(std::unique_ptr<ModulePass> pass) {
+  passes_.push_back({nullptr, std::move(pass)});
+}
+
+bool PassManager::AddPass(const std::string &name,
+                          const PassOptions &options) {
+  if (name == "reassociate") {
+    AddPass(std::make_unique<ReassociatePass>());
+  } else if (name == "instcombine") {
+    AddPass(std::make_unique<InstCombinePass>());
+  } else if (name == "inline") {
+    AddPass(std::make_unique<InlinerPass>(options.inline_threshold));
+  } else if (name == "tailcall") {
+    AddPass(std::make_unique<TailCallElimPass>());
+  } else if (name == "unroll") {
+    AddPass(std::make_unique<LoopUnrollPass>(options.unroll_factor));
+  } else if (name == "unswitch") {
+    AddPass(std::make_unique<LoopUnswitchPass>(options.unswitch_threshold));
+  } else if (name == "pre") {
+    AddPass(std::make_unique<PartialRedundancyElimPass>());
+  } else if (name == "mem2reg") {
+    AddPass(std::make_unique<Mem2RegPass>());
+  } else if (name == "vrp") {
+    AddPass(std::make_unique<ValueRangePropPass>(
+        options.pass_remarks ? &diag_ : nullptr));
+  } else if (name == "sink") {
+    AddPass(std::make_unique<CodeSinkingPass>());
+  } else if (name == "dse") {
+    AddPass(std::make_unique<DeadStoreElimPass>());
+  } else if (name == "ifcvt") {
+    AddPass(std::make_unique<IfConversionPass>(options.ifcvt_threshold));
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * -O0: 不做优化
+ * -O1: 局部化简与死存储消除
+ * -O2: 尾调用优化、内联、循环外提条件与展开、重结合、if 转换、部分冗余消除，
+ *      并在其后清理，最后把局部变量提升为寄存器值，
+ *      按值域折叠比较与分支并下沉
+ */
+bool PassManager::BuildPipeline(const PassOptions &options) {
+  time_passes_ = options.time_passes;
+
+  std::vector<std::string> names;
+  if (!options.passes.empty()) {
+    std::istringstream iss(options.passes);
+    std::string name;
+    while (std::getline(iss, name, ',')) {
+      if (!name.empty()) {
+        names.push_back(name);
+      }
+    }
+  } else if (options.opt_level == 1) {
+    names = {"instcombine", "dse"};
+  } else if (options.opt_level >= 2) {
+    names = {"tailcall",    "inline",      "unswitch", "unroll",
+             "reassociate", "instcombine", "ifcvt",    "instcombine",
+             "pre",         "dse",         "mem2reg",  "vrp",
+             "sink"};
+  }
+
+  for (const auto &name : names) {
+    if (!AddPass(name, options)) {
+      diag_ << "Error: Unknown pass " << name << std::endl;
+      return false;
+    }
+  }
+
+  // 转储的遍必须在流水线中，否则什么也不会输出
+  for (const auto &name : options.dump_ir_after) {
+    if (name != "all" &&
+        std::find(names.begin(), names.end(), name) == names.end()) {
+      diag_ << "Error: -dump-ir=after:" << name
+            << " names no pass in the pipeline" << std::endl;
+      return false;
+    }
+  }
+  dump_ir_after_ = options.dump_ir_after;
+  return true;
+}
+
+bool PassManager::ShouldDumpAfter(const std::string &name) const {
+  for (const auto &dump : dump_ir_after_) {
+    if (dump == "all" || dump == name) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void PassManager::Run(IRModule &module) {
+  for (auto &entry : passes_) {
+    auto start = std::chrono::steady_clock::now();
+    size_t insts_before = time_passes_ ? CountInsts(module) : 0;
+
+    // 修改了 CFG 的遍结束后才让缓存的分析失效
+    if (entry.func_pass) {
+      for (const auto &func : module.GetFunctions()) {
+        if (func->IsDeclaration()) {
+          continue;
+        }
+        if (entry.func_pass->Run(*func, am_) && !entry.PreservesCFG()) {
+          am_.Invalidate(*func);
+        }
+      }
+    } else if (entry.module_pass->Run(module, am_) && !entry.PreservesCFG()) {
+      am_.InvalidateAll();
+    }
+
+    if (time_passes_) {
+      std::chrono::duration<double, std::milli> elapsed =
+          std::chrono::steady_clock::now() - start;
+      long delta = static_cast<long>(CountInsts(module)) -
+                   static_cast<long>(insts_before);
+      timings_.push_back({entry.Name(), elapsed.count(), delta});
+    }
+
+    if (dump_ && ShouldDumpAfter(entry.Name())) {
+      *dump_ << "// *** IR Dump After " << entry.Name() << " ***\n"
+             << IRSerializer::ToIR(module);
+    }
+  }
+
+  if (time_passes_) {
+    PrintTimingReport();
+  }
+}
+
+void PassManager::PrintTimingReport() const {
+  double total_ms = 0;
+  long total_delta = 0;
+  for (const auto &timing : timings_) {
+    total_ms += timing.wall_ms;
+    total_delta += timing.inst_delta;
+  }
+
+  // 先格式化到缓冲区再写出，不改变 diag_ 的格式状态
+  char line[256];
+  diag_ << "===--- Pass execution timing report ---===\n";
+  std::snprintf(line, sizeof(line), "  %14s  %12s  %s\n", "Wall Time(ms)",
+                "Insts Delta", "Pass");
+  diag_ << line;
+  for (const auto &timing : timings_) {
+    std::snprintf(line, sizeof(line), "  %14.3f  %+12ld  %s\n",
+                  timing.wall_ms, timing.inst_delta, timing.name.c_str());
+    diag_ << line;
+  }
+  std::snprintf(line, sizeof(line), "  %14.3f  %+12ld  %s\n", total_ms,
+                total_delta, "Total");
+  diag_ << line;
+}
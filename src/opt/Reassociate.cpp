@@ -0,0 +1,231 @@
+#include "opt/Reassociate.h"
+
+#include <cstdint>
+#include <deque>
+
+namespace {
+
+// 以 32 位补码语义合并常量
+int32_t Combine(Opcode op, int64_t lhs, int64_t rhs) {
+  uint32_t l = static_cast<uint32_t>(lhs), r = static_cast<uint32_t>(rhs);
+  return static_cast<int32_t>(op == Opcode::Add ? l + r : l * r);
+}
+
+int64_t Identity(Opcode op) { return op == Opcode::Add ? 0 : 1; }
+
+int BalancedDepth(size_t operands) {
+  int depth = 0;
+  for (size_t n = 1; n < operands; n <<= 1) {
+    ++depth;
+  }
+  return depth;
+}
+
+} // namespace
+
+bool ReassociatePass::Run(Function &func, AnalysisManager &) {
+  func_ = &func;
+
+  bool changed = false;
+  for (auto &bb : func.blocks) {
+    changed |= RunOnBlock(bb.get());
+  }
+  return changed;
+}
+
+/**
+ * 加法链的节点包括 add 以及右操作数为常量的 sub (x - c 视为 x + (-c))；
+ * 乘法链的节点只有 mul
+ */
+bool ReassociatePass::IsChainNode(const Instruction *inst, Opcode op) const {
+  if (inst->op == op) {
+    return true;
+  }
+  return op == Opcode::Add && inst->op == Opcode::Sub &&
+         inst->ValueAt(2).isImmediate();
+}
+
+/**
+ * 链的内部节点：结果只在本块内被同一条链的节点使用一次
+ */
+bool ReassociatePass::IsInterior(const Instruction *inst) const {
+  const std::string &name = inst->Result().reg_or_addr;
+  auto it = single_user_.find(name);
+  if (it == single_user_.end()) {
+    return false;
+  }
+  Opcode chain_op = inst->op == Opcode::Mul ? Opcode::Mul : Opcode::Add;
+  const Instruction *user = it->second;
+  if (!user->IsBinary() || !IsChainNode(user, chain_op)) {
+    return false;
+  }
+  // sub 只有左操作数参与链
+  return user->op != Opcode::Sub || user->ValueAt(1).reg_or_addr == name;
+}
+
+void ReassociatePass::Collect(Instruction *inst, Opcode op, Tree &tree,
+                              int depth) {
+  tree.depth = std::max(tree.depth, depth);
+
+  auto visit = [&](const Value &value, bool negate) {
+    if (value.isImmediate()) {
+      int64_t imm = negate ? -static_cast<int64_t>(value.imm) : value.imm;
+      tree.constant = Combine(op, tree.constant, imm);
+      ++tree.num_consts;
+      return;
+    }
+    auto it = defs_.find(value.reg_or_addr);
+    if (it != defs_.end() && interior_.count(it->second)) {
+      Collect(it->second, op, tree, depth + 1);
+    } else {
+      tree.leaves.push_back(value);
+    }
+  };
+
+  visit(inst->ValueAt(1), false);
+  visit(inst->ValueAt(2), inst->op == Opcode::Sub);
+}
+
+bool ReassociatePass::Profitable(const Tree &tree) const {
+  // 多个常量可以合并
+  if (tree.num_consts > 1) {
+    return true;
+  }
+  size_t operands = tree.leaves.size() + (tree.num_consts > 0 ? 1 : 0);
+  return tree.depth > BalancedDepth(operands);
+}
+
+/**
+ * 将叶子两两配对逐层归约成平衡树，合并后的常量最后参与运算，
+ * 根指令保留原来的结果名，外部使用者无需改动
+ */
+void ReassociatePass::Rebuild(const Tree &tree, Opcode op,
+                              std::vector<std::unique_ptr<Instruction>> &out) {
+  std::deque<Value> level(tree.leaves.begin(), tree.leaves.end());
+  bool has_const = tree.constant != Identity(op) || level.empty();
+  if (has_const) {
+    level.push_back(Value::Imm(static_cast<int32_t>(tree.constant)));
+  }
+
+  const Value &result = tree.root->Result();
+  if (level.size() == 1) {
+    // 只剩一个操作数，用 x + 0 保持结果名；交给后续化简去除
+    out.push_back(std::make_unique<Instruction>(Opcode::Add, result,
+                                                level.front(), Value::Imm(0)));
+    return;
+  }
+
+  while (level.size() > 1) {
+    std::deque<Value> next;
+    while (level.size() >= 2) {
+      Value lhs = level.front();
+      level.pop_front();
+      Value rhs = level.front();
+      level.pop_front();
+      bool last = level.empty() && next.empty();
+      Value res = last ? result : func_->NewTempReg("reassoc");
+      out.push_back(std::make_unique<Instruction>(op, res, lhs, rhs));
+      next.push_back(res);
+    }
+    if (!level.empty()) {
+      next.push_back(level.front());
+    }
+    level.swap(next);
+  }
+}
+
+bool ReassociatePass::RunOnBlock(BasicBlock *bb) {
+  defs_.clear();
+  single_user_.clear();
+  interior_.clear();
+
+  for (auto &inst : bb->insts) {
+    if (inst->HasResult()) {
+      defs_[inst->Result().reg_or_addr] = inst.get();
+    }
+    if (inst->IsBinary()) {
+      const auto &uses = func_->Uses(inst->Result());
+      if (uses.size() == 1 && uses.front().user->parent == bb) {
+        single_user_[inst->Result().reg_or_addr] = uses.front().user;
+      }
+    }
+  }
+
+  for (auto &inst : bb->insts) {
+    if (inst->IsBinary() &&
+        (IsChainNode(inst.get(), Opcode::Add) || inst->op == Opcode::Mul) &&
+        IsInterior(inst.get())) {
+      interior_.insert(inst.get());
+    }
+  }
+
+  // 找出所有链的根并决定是否重建
+  std::unordered_map<Instruction *, std::vector<std::unique_ptr<Instruction>>>
+      rebuilt;
+  std::unordered_set<Instruction *> removed;
+  for (auto &inst : bb->insts) {
+    if (!inst->IsBinary() || interior_.count(inst.get())) {
+      continue;
+    }
+    Opcode op;
+    if (IsChainNode(inst.get(), Opcode::Add)) {
+      op = Opcode::Add;
+    } else if (inst->op == Opcode::Mul) {
+      op = Opcode::Mul;
+    } else {
+      continue;
+    }
+
+    Tree tree{inst.get(), {}, Identity(op), 0, 0};
+    Collect(inst.get(), op, tree, 1);
+    if (!Profitable(tree)) {
+      continue;
+    }
+
+    Rebuild(tree, op, rebuilt[inst.get()]);
+  }
+
+  if (rebuilt.empty()) {
+    return false;
+  }
+
+  // 被重建的链上的内部节点不再被使用，一并删除
+  for (auto &[root, insts] : rebuilt) {
+    std::vector<Instruction *> worklist{root};
+    while (!worklist.empty()) {
+      Instruction *node = worklist.back();
+      worklist.pop_back();
+      for (size_t i = 1; i <= 2; ++i) {
+        const Value &value = node->ValueAt(i);
+        if (value.isImmediate()) {
+          continue;
+        }
+        auto it = defs_.find(value.reg_or_addr);
+        if (it != defs_.end() && interior_.count(it->second)) {
+          removed.insert(it->second);
+          worklist.push_back(it->second);
+        }
+      }
+    }
+  }
+
+  // 一次性重建指令序列并同步 use-def 链，避免逐条插入删除的移动开销
+  std::vector<std::unique_ptr<Instruction>> insts;
+  for (auto &inst : bb->insts) {
+    auto it = rebuilt.find(inst.get());
+    if (it != rebuilt.end()) {
+      for (auto &new_inst : it->second) {
+        new_inst->parent = bb;
+        func_->TrackInst(new_inst.get());
+        insts.push_back(std::move(new_inst));
+      }
+      func_->UntrackInst(inst.get());
+    } else if (removed.count(inst.get())) {
+      func_->UntrackInst(inst.get());
+    } else {
+      insts.push_back(std::move(inst));
+    }
+  }
+  bb->insts = std::move(insts);
+  return true;
+}
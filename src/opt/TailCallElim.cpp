@@ -0,0 +1,180 @@
+#include "opt/TailCallElim.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+/*
+ * 只负责返回的出口块：void 函数为单条 ret，
+ * 否则为 %v = load @ret; ret %v，此时 ret_slot 为 @ret 的名称
+ */
+bool IsReturnBlock(const BasicBlock *bb, std::string &ret_slot) {
+  const auto &insts = bb->insts;
+  if (insts.size() == 1 && insts[0]->op == Opcode::Ret &&
+      insts[0]->args.empty()) {
+    ret_slot.clear();
+    return true;
+  }
+  if (insts.size() != 2 || insts[0]->op != Opcode::Load ||
+      insts[1]->op != Opcode::Ret || insts[1]->args.empty()) {
+    return false;
+  }
+  const Value &ret = insts[1]->ValueAt(0);
+  if (ret.isImmediate() || ret.reg_or_addr != insts[0]->Result().reg_or_addr) {
+    return false;
+  }
+  ret_slot = insts[0]->ValueAt(1).reg_or_addr;
+  return true;
+}
+
+// 基本块末尾为 call; ret 且直接返回调用结果时返回该 call
+Instruction *TailCallOf(BasicBlock *bb) {
+  size_t n = bb->insts.size();
+  if (n < 2 || bb->insts[n - 1]->op != Opcode::Ret ||
+      bb->insts[n - 2]->op != Opcode::Call) {
+    return nullptr;
+  }
+  Instruction *ret = bb->insts[n - 1].get();
+  Instruction *call = bb->insts[n - 2].get();
+  if (!call->HasResult()) {
+    return ret->args.empty() ? call : nullptr;
+  }
+  if (ret->args.empty()) {
+    return nullptr;
+  }
+  const Value &value = ret->ValueAt(0);
+  return !value.isImmediate() && value.reg_or_addr == call->Result().reg_or_addr
+             ? call
+             : nullptr;
+}
+
+} // namespace
+
+bool TailCallElimPass::Run(Function &func, AnalysisManager &) {
+  bool changed = ExposeTailCalls(func);
+  changed |= EliminateSelfRecursion(func);
+  return changed;
+}
+
+/**
+ * 前端让所有 return 先写入 @ret 再跳到公共出口块，
+ * 对紧跟在 call 之后的这类返回，把跳转替换为就地 ret；
+ * 函数随即返回，写入 @ret 的 store 不会再被读取，一并删除
+ */
+bool TailCallElimPass::ExposeTailCalls(Function &func) {
+  std::unordered_set<BasicBlock *> exits;
+  std::string ret_slot;
+  for (auto &bb : func.blocks) {
+    auto &insts = bb->insts;
+    size_t n = insts.size();
+    if (n < 2 || insts[n - 1]->op != Opcode::Jmp) {
+      continue;
+    }
+    const auto &target = std::get<BranchTarget>(insts[n - 1]->args[0]);
+    if (!target.args.empty() || !IsReturnBlock(target.target, ret_slot)) {
+      continue;
+    }
+
+    std::unique_ptr<Instruction> ret;
+    if (ret_slot.empty()) {
+      if (insts[n - 2]->op == Opcode::Call) {
+        ret = std::make_unique<Instruction>(Opcode::Ret);
+      }
+    } else if (n >= 3 && insts[n - 2]->op == Opcode::Store &&
+               insts[n - 2]->ValueAt(1).reg_or_addr == ret_slot &&
+               insts[n - 3]->op == Opcode::Call &&
+               insts[n - 3]->HasResult()) {
+      const Value &stored = insts[n - 2]->ValueAt(0);
+      const Value &result = insts[n - 3]->Result();
+      if (!stored.isImmediate() && stored.reg_or_addr == result.reg_or_addr) {
+        ret = std::make_unique<Instruction>(Opcode::Ret, result);
+      }
+    }
+    if (!ret) {
+      continue;
+    }
+    exits.insert(target.target);
+    bb->Erase(insts.back().get());
+    if (!ret_slot.empty()) {
+      bb->Erase(insts.back().get());
+    }
+    bb->Append(std::move(ret));
+  }
+  if (exits.empty()) {
+    return false;
+  }
+
+  // 所有返回路径都被改写后，出口块不再可达
+  for (auto &bb : func.blocks) {
+    if (bb->insts.empty()) {
+      continue;
+    }
+    for (const auto &arg : bb->insts.back()->args) {
+      if (const auto *target = std::get_if<BranchTarget>(&arg)) {
+        exits.erase(target->target);
+      }
+    }
+  }
+  for (BasicBlock *exit : exits) {
+    func.RemoveBlock(exit);
+  }
+  return true;
+}
+
+/**
+ * 入口块只保留 alloc，其余指令移入新的循环头，
+ * 形参的所有使用改为循环头的块参数，入口以形参跳入循环头；
+ * 自递归的尾调用改为以实参跳回循环头
+ */
+bool TailCallElimPass::EliminateSelfRecursion(Function &func) {
+  std::vector<Instruction *> calls;
+  for (auto &bb : func.blocks) {
+    Instruction *call = TailCallOf(bb.get());
+    if (call && call->Callee() == &func) {
+      calls.push_back(call);
+    }
+  }
+  if (calls.empty()) {
+    return false;
+  }
+
+  BasicBlock *entry = func.blocks.front().get();
+  BasicBlock *header = func.CreateBlock(
+      func.name + "_tailrec" + std::to_string(func.NextTempId("tailrec")));
+  // 循环头紧跟入口块放置
+  std::rotate(func.blocks.begin() + 1, func.blocks.end() - 1,
+              func.blocks.end());
+
+  // alloc 没有操作数，可以先集中到入口块开头
+  auto &insts = entry->insts;
+  auto body = std::stable_partition(
+      insts.begin(), insts.end(),
+      [](const auto &inst) { return inst->op == Opcode::Alloc; });
+  entry->SplitAt(body - insts.begin(), header);
+
+  std::vector<Value> init;
+  for (const auto &[name, type] : func.params) {
+    Value param = Value::Reg(name);
+    func.ReplaceAllUsesWith(param, header->AddParam(type));
+    init.push_back(param);
+  }
+  entry->Append(std::make_unique<Instruction>(
+      Opcode::Jmp, BranchTarget(header, std::move(init))));
+
+  for (Instruction *call : calls) {
+    BasicBlock *bb = call->parent;
+    std::vector<Value> args;
+    for (size_t i = call->CalleeIndex() + 1; i < call->args.size(); ++i) {
+      args.push_back(call->ValueAt(i));
+    }
+    bb->Erase(bb->insts.back().get());
+    bb->Erase(call);
+    bb->Append(std::make_unique<Instruction>(
+        Opcode::Jmp, BranchTarget(header, std::move(args))));
+  }
+  return true;
+}
@@ -0,0 +1,524 @@
+#include "opt/ValueRange.h"
+#include "opt/CFG.h"
+
+namespace {
+
+// 迭代这么多轮之后仍在扩大的区间放宽到 32 位边界；超过上限仍未收敛则放弃
+constexpr size_t kWidenRounds = 3;
+constexpr size_t kMaxRounds = 32;
+
+// 比较取反：!(a < b) == (a >= b)
+Opcode InvertComparison(Opcode op) {
+  switch (op) {
+  case Opcode::Lt:
+    return Opcode::Ge;
+  case Opcode::Gt:
+    return Opcode::Le;
+  case Opcode::Le:
+    return Opcode::Gt;
+  case Opcode::Ge:
+    return Opcode::Lt;
+  case Opcode::Eq:
+    return Opcode::Ne;
+  default:
+    return Opcode::Eq;
+  }
+}
+
+bool SameRegister(const Value &lhs, const Value &rhs) {
+  return lhs.isRegister() && rhs.isRegister() &&
+         lhs.reg_or_addr == rhs.reg_or_addr;
+}
+
+/**
+ * 比较的规范形式：gt/ge 交换操作数改写为 lt/le，eq/ne 的操作数按名称排序，
+ * 同一个比较的不同写法得到相同的键
+ */
+std::string FactKey(Opcode op, const Value &lhs, const Value &rhs) {
+  std::string l = lhs.toString(), r = rhs.toString();
+  switch (op) {
+  case Opcode::Lt:
+    return "lt " + l + " " + r;
+  case Opcode::Le:
+    return "le " + l + " " + r;
+  case Opcode::Gt:
+    return "lt " + r + " " + l;
+  case Opcode::Ge:
+    return "le " + r + " " + l;
+  default:
+    if (r < l) {
+      std::swap(l, r);
+    }
+    return (op == Opcode::Eq ? "eq " : "ne ") + l + " " + r;
+  }
+}
+
+// 按循环轮数放宽：超过阈值后仍在扩大的一端直接取 32 位边界
+ValueRange Widen(const ValueRange &old_range, const ValueRange &new_range) {
+  ValueRange widened = new_range;
+  if (new_range.lo < old_range.lo) {
+    widened.lo = INT32_MIN;
+  }
+  if (new_range.hi > old_range.hi) {
+    widened.hi = INT32_MAX;
+  }
+  return widened;
+}
+
+// 两个非负区间按位或/异或的结果不超过覆盖较大上界的全 1 掩码
+int64_t BitMask(int64_t hi) {
+  int64_t mask = 0;
+  while (mask < hi) {
+    mask = mask * 2 + 1;
+  }
+  return mask;
+}
+
+} // namespace
+
+ValueRangeAnalysis::ValueRangeAnalysis(const Function &func) : func_(func) {
+  CFG cfg(func);
+  for (BasicBlock *bb : cfg.ReversePostOrder()) {
+    rpo_.push_back(bb);
+  }
+  for (const auto &bb : func.blocks) {
+    if (!bb->HasTerminator()) {
+      continue;
+    }
+    const Instruction &term = *bb->insts.back();
+    for (size_t i = 0; i < term.args.size(); ++i) {
+      if (auto *target = std::get_if<BranchTarget>(&term.args[i])) {
+        incoming_[target->target].push_back({bb.get(), i});
+      }
+    }
+  }
+  if (rpo_.empty()) {
+    return;
+  }
+
+  do {
+    changed_ = false;
+    for (const BasicBlock *bb : rpo_) {
+      State state;
+      if (bb != rpo_.front() && !Join(bb, state)) {
+        continue;
+      }
+      auto old = in_.find(bb);
+      if (old == in_.end()) {
+        changed_ = true;
+      } else {
+        if (round_ >= kWidenRounds) {
+          for (auto &[name, range] : state.ranges) {
+            auto it = old->second.ranges.find(name);
+            if (it != old->second.ranges.end()) {
+              range = Widen(it->second, range);
+            }
+          }
+        }
+        if (!(old->second == state)) {
+          changed_ = true;
+        }
+      }
+      in_[bb] = state;
+
+      // 块参数取各条可行入边上实参区间的并
+      for (size_t i = 0; i < bb->params.size(); ++i) {
+        std::optional<ValueRange> range;
+        for (const Edge &edge : incoming_[bb]) {
+          auto it = out_.find(edge.from);
+          if (it == out_.end() || !it->second.count(edge.slot)) {
+            continue;
+          }
+          const auto &target =
+              std::get<BranchTarget>(edge.from->insts.back()->args[edge.slot]);
+          ValueRange arg = Lookup(target.args[i], it->second.at(edge.slot));
+          range = range ? range->Union(arg) : arg;
+        }
+        if (range) {
+          Update(bb->params[i].first, *range, true);
+        }
+      }
+
+      for (const auto &inst : bb->insts) {
+        if (inst->IsBinary()) {
+          Update(inst->Result().reg_or_addr, Evaluate(*inst, state), false);
+        }
+      }
+
+      // 出边：br 的两侧分别按条件收窄，不可行的一侧不记录
+      const Instruction &term = *bb->insts.back();
+      auto &out = out_[bb];
+      out.clear();
+      if (term.op == Opcode::Br) {
+        for (bool taken : {true, false}) {
+          State edge = state;
+          if (Refine(term.ValueAt(0), taken, edge)) {
+            out[taken ? 1 : 2] = std::move(edge);
+          }
+        }
+      } else if (term.op == Opcode::Jmp) {
+        out[0] = state;
+      }
+    }
+    ++round_;
+  } while (changed_ && round_ < kMaxRounds);
+
+  // 未收敛时结果可能偏窄，放弃全部判定
+  if (changed_) {
+    in_.clear();
+    out_.clear();
+  }
+}
+
+std::optional<int32_t>
+ValueRangeAnalysis::GetConstant(const Instruction &inst) const {
+  auto it = in_.find(inst.parent);
+  if (it == in_.end() || !inst.IsBinary()) {
+    return std::nullopt;
+  }
+  ValueRange range = Evaluate(inst, it->second);
+  if (!range.IsConstant()) {
+    return std::nullopt;
+  }
+  return static_cast<int32_t>(range.lo);
+}
+
+std::optional<bool>
+ValueRangeAnalysis::GetBranchDirection(const BasicBlock *bb) const {
+  auto it = out_.find(bb);
+  if (it == out_.end() || bb->insts.back()->op != Opcode::Br) {
+    return std::nullopt;
+  }
+  bool true_feasible = it->second.count(1), false_feasible = it->second.count(2);
+  if (true_feasible == false_feasible) {
+    return std::nullopt;
+  }
+  return true_feasible;
+}
+
+/**
+ * 合并所有可行入边上的信息：只保留每条边上都有的区间（取并）与比较，
+ * 没有可行入边时返回 false
+ */
+bool ValueRangeAnalysis::Join(const BasicBlock *bb, State &state) const {
+  bool reachable = false;
+  auto edges = incoming_.find(bb);
+  if (edges == incoming_.end()) {
+    return false;
+  }
+  for (const Edge &edge : edges->second) {
+    auto it = out_.find(edge.from);
+    if (it == out_.end()) {
+      continue;
+    }
+    auto jt = it->second.find(edge.slot);
+    if (jt == it->second.end()) {
+      continue;
+    }
+    const State &other = jt->second;
+    if (!reachable) {
+      state = other;
+      reachable = true;
+      continue;
+    }
+    for (auto kt = state.ranges.begin(); kt != state.ranges.end();) {
+      auto ot = other.ranges.find(kt->first);
+      if (ot == other.ranges.end()) {
+        kt = state.ranges.erase(kt);
+      } else {
+        kt->second = kt->second.Union(ot->second);
+        ++kt;
+      }
+    }
+    for (auto kt = state.facts.begin(); kt != state.facts.end();) {
+      kt = other.facts.count(*kt) ? std::next(kt) : state.facts.erase(kt);
+    }
+  }
+  return reachable;
+}
+
+/**
+ * 合并值的新区间。只有块参数需要放宽：循环中的递增经块参数传回，
+ * 指令的结果由操作数决定，参数稳定后随之稳定
+ */
+void ValueRangeAnalysis::Update(const std::string &name,
+                                const ValueRange &range, bool widen) {
+  auto it = ranges_.find(name);
+  if (it == ranges_.end()) {
+    ranges_.emplace(name, range);
+    changed_ = true;
+    return;
+  }
+  ValueRange merged = it->second.Union(range);
+  if (merged == it->second) {
+    return;
+  }
+  if (widen && round_ >= kWidenRounds) {
+    merged = Widen(it->second, merged);
+  }
+  it->second = merged;
+  changed_ = true;
+}
+
+ValueRange ValueRangeAnalysis::Lookup(const Value &value,
+                                      const State &state) const {
+  if (value.isImmediate()) {
+    return ValueRange::Constant(value.imm);
+  }
+  if (!value.isRegister()) {
+    return ValueRange::Full();
+  }
+  auto it = state.ranges.find(value.reg_or_addr);
+  if (it != state.ranges.end()) {
+    return it->second;
+  }
+  auto jt = ranges_.find(value.reg_or_addr);
+  return jt == ranges_.end() ? ValueRange::Full() : jt->second;
+}
+
+/**
+ * 二元运算结果的区间。可能溢出回绕的运算取全集，
+ * 除数可能为 0 时按运行时不会除零处理，只依据被除数与除数的绝对值估计
+ */
+ValueRange ValueRangeAnalysis::Evaluate(const Instruction &inst,
+                                        const State &state) const {
+  const Value &lhs = inst.ValueAt(1);
+  const Value &rhs = inst.ValueAt(2);
+  if (inst.IsComparison()) {
+    if (auto result = Compare(inst.op, lhs, rhs, state)) {
+      return ValueRange::Constant(*result);
+    }
+    return {0, 1};
+  }
+
+  ValueRange a = Lookup(lhs, state), b = Lookup(rhs, state);
+  auto corners = [&](auto &&f) {
+    int64_t values[] = {f(a.lo, b.lo), f(a.lo, b.hi), f(a.hi, b.lo),
+                        f(a.hi, b.hi)};
+    return ValueRange::Of(*std::min_element(values, values + 4),
+                          *std::max_element(values, values + 4));
+  };
+
+  switch (inst.op) {
+  case Opcode::Add:
+    return ValueRange::Of(a.lo + b.lo, a.hi + b.hi);
+  case Opcode::Sub:
+    return ValueRange::Of(a.lo - b.hi, a.hi - b.lo);
+  case Opcode::Mul:
+    return corners([](int64_t x, int64_t y) { return x * y; });
+  case Opcode::Div: {
+    if (b == ValueRange::Constant(0)) {
+      return ValueRange::Full();
+    }
+    if (!b.Contains(0)) {
+      return corners([](int64_t x, int64_t y) { return x / y; });
+    }
+    int64_t bound = std::max(-a.lo, a.hi);
+    return ValueRange::Of(-bound, bound);
+  }
+  case Opcode::Mod: {
+    // 余数与被除数同号，绝对值小于除数的绝对值
+    int64_t bound = std::max(-b.lo, b.hi) - 1;
+    if (bound < 0) {
+      return ValueRange::Full();
+    }
+    return ValueRange::Of(a.lo >= 0 ? 0 : std::max(a.lo, -bound),
+                          a.hi <= 0 ? 0 : std::min(a.hi, bound));
+  }
+  case Opcode::And:
+    if (a.lo >= 0 && b.lo >= 0) {
+      return {0, std::min(a.hi, b.hi)};
+    }
+    if (a.lo >= 0 || b.lo >= 0) {
+      return {0, a.lo >= 0 ? a.hi : b.hi};
+    }
+    return ValueRange::Full();
+  case Opcode::Or:
+  case Opcode::Xor:
+    if (a.lo >= 0 && b.lo >= 0) {
+      int64_t lo = inst.op == Opcode::Or ? std::max(a.lo, b.lo) : 0;
+      return {lo, BitMask(std::max(a.hi, b.hi))};
+    }
+    return ValueRange::Full();
+  case Opcode::Sar:
+    if (b.IsConstant()) {
+      int shift = static_cast<int>(b.lo & 31);
+      return {a.lo >> shift, a.hi >> shift};
+    }
+    return {std::min<int64_t>(a.lo, 0), std::max<int64_t>(a.hi, 0)};
+  default:
+    return ValueRange::Full();
+  }
+}
+
+/**
+ * 判定比较的结果：同一个值比较、路径上已知成立（或不成立）的比较，
+ * 以及互不重叠的区间。无法判定时返回 std::nullopt
+ */
+std::optional<bool> ValueRangeAnalysis::Compare(Opcode op, const Value &lhs,
+                                                const Value &rhs,
+                                                const State &state) const {
+  if (SameRegister(lhs, rhs)) {
+    return op == Opcode::Le || op == Opcode::Ge || op == Opcode::Eq;
+  }
+  if (state.facts.count(FactKey(op, lhs, rhs))) {
+    return true;
+  }
+  if (state.facts.count(FactKey(InvertComparison(op), lhs, rhs))) {
+    return false;
+  }
+
+  ValueRange a = Lookup(lhs, state), b = Lookup(rhs, state);
+  switch (op) {
+  case Opcode::Gt:
+    std::swap(a, b);
+    [[fallthrough]];
+  case Opcode::Lt:
+    if (a.hi < b.lo) {
+      return true;
+    }
+    if (a.lo >= b.hi) {
+      return false;
+    }
+    break;
+  case Opcode::Ge:
+    std::swap(a, b);
+    [[fallthrough]];
+  case Opcode::Le:
+    if (a.hi <= b.lo) {
+      return true;
+    }
+    if (a.lo > b.hi) {
+      return false;
+    }
+    break;
+  case Opcode::Eq:
+  case Opcode::Ne: {
+    bool equal = a.IsConstant() && a == b;
+    bool disjoint = a.hi < b.lo || b.hi < a.lo;
+    if (equal || disjoint) {
+      return equal == (op == Opcode::Eq);
+    }
+    break;
+  }
+  default:
+    break;
+  }
+  return std::nullopt;
+}
+
+/**
+ * 沿 br 的一侧收窄：条件自身在 true 一侧非零、在 false 一侧为零；
+ * 条件是比较时记下该侧成立的比较并收窄两个操作数。
+ * 该侧不可能被执行时返回 false
+ */
+bool ValueRangeAnalysis::Refine(const Value &cond, bool taken,
+                                State &state) const {
+  if (cond.isImmediate()) {
+    return (cond.imm != 0) == taken;
+  }
+  ValueRange range = Lookup(cond, state);
+  const Instruction *def = func_.GetDef(cond);
+  if (def && def->IsComparison()) {
+    const Value &lhs = def->ValueAt(1);
+    const Value &rhs = def->ValueAt(2);
+    if (auto result = Compare(def->op, lhs, rhs, state)) {
+      if (*result != taken) {
+        return false;
+      }
+    }
+    Opcode op = taken ? def->op : InvertComparison(def->op);
+    AddFact(op, lhs, rhs, state);
+    if (!RefineCompare(op, lhs, rhs, state)) {
+      return false;
+    }
+  }
+
+  if (taken) {
+    if (range.lo == 0) {
+      range.lo = 1;
+    }
+    if (range.hi == 0) {
+      range.hi = -1;
+    }
+  } else {
+    range = range.Intersect(ValueRange::Constant(0));
+  }
+  if (range.IsEmpty()) {
+    return false;
+  }
+  if (cond.isRegister()) {
+    state.ranges[cond.reg_or_addr] = range;
+  }
+  return true;
+}
+
+// 已知 lhs op rhs 成立，收窄两侧的区间；出现空区间时返回 false
+bool ValueRangeAnalysis::RefineCompare(Opcode op, const Value &lhs,
+                                       const Value &rhs, State &state) const {
+  if (op == Opcode::Gt) {
+    return RefineCompare(Opcode::Lt, rhs, lhs, state);
+  }
+  if (op == Opcode::Ge) {
+    return RefineCompare(Opcode::Le, rhs, lhs, state);
+  }
+
+  ValueRange a = Lookup(lhs, state), b = Lookup(rhs, state);
+  ValueRange new_a = a, new_b = b;
+  switch (op) {
+  case Opcode::Lt:
+    new_a = a.Intersect({INT32_MIN, b.hi - 1});
+    new_b = b.Intersect({a.lo + 1, INT32_MAX});
+    break;
+  case Opcode::Le:
+    new_a = a.Intersect({INT32_MIN, b.hi});
+    new_b = b.Intersect({a.lo, INT32_MAX});
+    break;
+  case Opcode::Eq:
+    new_a = new_b = a.Intersect(b);
+    break;
+  case Opcode::Ne:
+    // 只能去掉区间端点上的常量
+    if (b.IsConstant()) {
+      new_a.lo += new_a.lo == b.lo;
+      new_a.hi -= new_a.hi == b.lo;
+    }
+    if (a.IsConstant()) {
+      new_b.lo += new_b.lo == a.lo;
+      new_b.hi -= new_b.hi == a.lo;
+    }
+    break;
+  default:
+    break;
+  }
+  if (new_a.IsEmpty() || new_b.IsEmpty()) {
+    return false;
+  }
+  if (lhs.isRegister()) {
+    state.ranges[lhs.reg_or_addr] = new_a;
+  }
+  if (rhs.isRegister()) {
+    state.ranges[rhs.reg_or_addr] = new_b;
+  }
+  return true;
+}
+
+// 记下成立的比较及其直接推论：a < b 蕴含 a <= b 与 a != b，a == b 蕴含两个 <=
+void ValueRangeAnalysis::AddFact(Opcode op, const Value &lhs, const Value &rhs,
+                                 State &state) const {
+  state.facts.insert(FactKey(op, lhs, rhs));
+  switch (op) {
+  case Opcode::Lt:
+  case Opcode::Gt:
+    state.facts.insert(FactKey(op == Opcode::Lt ? Opcode::Le : Opcode::Ge,
+                               lhs, rhs));
+    state.facts.insert(FactKey(Opcode::Ne, lhs, rhs));
+    break;
+  case Opcode::Eq:
+    state.facts.insert(FactKey(Opcode::Le, lhs, rhs));
+    state.facts.insert(FactKey(Opcode::Ge, lhs, rhs));
+    break;
+  default:
+    break;
+  }
+}
@@ -0,0 +1,68 @@
+#include "opt/ValueRangeProp.h"
+#include "ir/IRSerializer.h"
+#include "opt/IRUtils.h"
+
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+bool ValueRangePropPass::Run(Function &func, AnalysisManager &) {
+  ValueRangeAnalysis ranges(func);
+
+  // 先收集全部判定再修改 IR，分析结果对应修改之前的函数
+  std::vector<std::pair<Instruction *, int32_t>> folds;
+  std::vector<std::pair<BasicBlock *, bool>> branches;
+  std::vector<std::string> branch_texts;
+  for (auto &bb : func.blocks) {
+    if (!ranges.IsReachable(bb.get())) {
+      continue;
+    }
+    for (auto &inst : bb->insts) {
+      if (auto imm = ranges.GetConstant(*inst)) {
+        folds.push_back({inst.get(), *imm});
+      }
+    }
+    if (auto taken = ranges.GetBranchDirection(bb.get())) {
+      branches.push_back({bb.get(), *taken});
+      branch_texts.push_back(IRSerializer::ToIR(*bb->insts.back()));
+    }
+  }
+
+  for (const auto &[inst, imm] : folds) {
+    if (remarks_ && inst->IsComparison()) {
+      Remark(func, *inst->parent,
+             "removed check '" + IRSerializer::ToIR(*inst) + "', always " +
+                 (imm ? "true" : "false"));
+    }
+    func.ReplaceAllUsesWith(inst->Result(), Value::Imm(imm));
+  }
+
+  for (size_t i = 0; i < branches.size(); ++i) {
+    auto [bb, taken] = branches[i];
+    Instruction *br = bb->insts.back().get();
+    BranchTarget target = std::get<BranchTarget>(br->args[taken ? 1 : 2]);
+    if (remarks_) {
+      Remark(func, *bb,
+             "branch '" + branch_texts[i] + "' always goes to %" +
+                 target.target->name);
+    }
+    bb->Erase(br);
+    bb->Append(std::make_unique<Instruction>(Opcode::Jmp, std::move(target)));
+  }
+
+  bool changed = !folds.empty() || !branches.empty();
+  if (!branches.empty()) {
+    IRUtils::RemoveUnreachableBlocks(func);
+  }
+  if (changed) {
+    IRUtils::RemoveDeadInsts(func);
+  }
+  return changed;
+}
+
+void ValueRangePropPass::Remark(const Function &func, const BasicBlock &bb,
+                                const std::string &message) const {
+  *remarks_ << "remark: @" << func.name << ": %" << bb.name << ": " << message
+            << " [vrp]" << std::endl;
+}
@@ -0,0 +1,80 @@
+#include "sysy.h"
+#include "driver/Driver.h"
+
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+
+namespace {
+
+// 把写入的内容攒成块交给 Sink 的输出缓冲区
+class SinkBuffer : public std::streambuf {
+public:
+  explicit SinkBuffer(const sysy::Sink &sink) : sink_(sink) {
+    setp(buffer_, buffer_ + sizeof(buffer_));
+  }
+  ~SinkBuffer() override { Flush(); }
+
+protected:
+  int_type overflow(int_type ch) override {
+    Flush();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(ch);
+      pbump(1);
+    }
+    return traits_type::not_eof(ch);
+  }
+
+  int sync() override {
+    Flush();
+    return 0;
+  }
+
+private:
+  void Flush() {
+    if (pptr() > pbase()) {
+      sink_(pbase(), static_cast<size_t>(pptr() - pbase()));
+    }
+    setp(buffer_, buffer_ + sizeof(buffer_));
+  }
+
+  const sysy::Sink &sink_;
+  char buffer_[4096];
+};
+
+sysy::Result Run(std::string_view source, sysy::Target target,
+                 const std::vector<std::string> &args, std::ostream &out) {
+  std::ostringstream err;
+  CompileOptions options;
+  sysy::Result result;
+  result.succeeded =
+      Driver::ParseOptions(args, options, err) &&
+      Driver::CompileSource(source,
+                            target == sysy::Target::Koopa ? "-koopa"
+                                                          : "-riscv",
+                            options, out, err);
+  out.flush();
+  result.diagnostics = err.str();
+  return result;
+}
+
+} // namespace
+
+namespace sysy {
+
+Result Compile(std::string_view source, Target target,
+               const std::vector<std::string> &args, const Sink &sink) {
+  SinkBuffer buffer(sink);
+  std::ostream out(&buffer);
+  return Run(source, target, args, out);
+}
+
+Result Compile(std::string_view source, Target target,
+               const std::vector<std::string> &args, std::string &output) {
+  std::ostringstream out;
+  Result result = Run(source, target, args, out);
+  output = result.succeeded ? out.str() : std::string();
+  return result;
+}
+
+} // namespace sysy
@@ -0,0 +1,5 @@
+// KnownBits 不能假设 getint() 的结果只有 0 / 1 两种取值
+int main() {
+  putint((getint() && getint()) == 1);
+  return 0;
+}
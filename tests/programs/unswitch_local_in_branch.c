@@ -0,0 +1,16 @@
+// 循环外提条件后，else 分支中声明的局部变量仍须有 alloc
+int main() {
+  int n = getint(), c = getint();
+  int i = 0, s = 0;
+  while (i < n) {
+    if (c) {
+      s = s + 1;
+    } else {
+      int t = i;
+      s = s + t;
+    }
+    i = i + 1;
+  }
+  putint(s);
+  return 0;
+}
@@ -0,0 +1,45 @@
+#!/bin/bash
+# 回归测试：用 -O0 / -O1 / -O2 编译 programs/ 中的每个程序，在 rvsim.py 中运行，
+# 把输出与返回值和 <name>.out 比较。<name>.out 是程序的输出，最后一行是返回值。
+# 用法: tests/run.sh <compiler>
+set -u
+
+if [ $# -ne 1 ]; then
+  echo "usage: $0 <compiler>" >&2
+  exit 2
+fi
+compiler=$1
+dir=$(cd "$(dirname "$0")" && pwd)
+rvsim="$dir/../bench/regalloc/rvsim.py"
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+passed=0 failed=0
+for src in "$dir"/programs/*.c; do
+  name=$(basename "$src" .c)
+  input=""
+  [ -f "$dir/programs/$name.in" ] && input=$(cat "$dir/programs/$name.in")
+  for level in -O0 -O1 -O2; do
+    asm="$work/$name.S"
+    if ! "$compiler" -riscv "$src" -o "$asm" $level; then
+      echo "FAIL $name $level: compilation failed" >&2
+      failed=$((failed + 1))
+      continue
+    fi
+    # shellcheck disable=SC2086
+    output=$(python3 "$rvsim" "$asm" $input 2>"$work/stderr")
+    actual=$(printf '%s\n%d' "$output" $?)
+    if [ "$actual" != "$(cat "$dir/programs/$name.out")" ]; then
+      echo "FAIL $name $level: expected" >&2
+      cat "$dir/programs/$name.out" >&2
+      echo "got" >&2
+      echo "$actual" >&2
+      grep -v '^instructions ' "$work/stderr" >&2
+      failed=$((failed + 1))
+      continue
+    fi
+    passed=$((passed + 1))
+  done
+done
+echo "passed $passed, failed $failed"
+[ $failed -eq 0 ]